@@ -75,6 +75,7 @@ void initializeHDLFlattenCFGPass(PassRegistry&);
 void initializeSplitBarrierBlocksPass(PassRegistry&);
 void initializeDelayStoresPass(PassRegistry&);
 void initializeBitWidthAnalysisPass(PassRegistry&);
+void initializeFixedPointAnalysisPass(PassRegistry&);
 void initializeShiftRegisterDetectionPass(PassRegistry&);
 void initializeRewriteExprPass(PassRegistry&);
 void initializeAggregateLoadsPass(PassRegistry&);
@@ -82,7 +83,7 @@ void initializeInstSimplifyPass(PassRegistry&);
 void initializeArgPromotionTrackerPass(PassRegistry&);
 void initializeCanonicalizePredecessorsPass(PassRegistry&);
 void initializeCFGOptimizerPass(PassRegistry&);
-void initializeFindAllPathsPass(PassRegistry&);
+void initializeBlockRoutingPass(PassRegistry&);
 void initializeRenameInvalidPass(PassRegistry&);
 void initializePrintModulePass(PassRegistry&);
 
@@ -57,6 +57,7 @@ namespace {
       /// (void) llvm::createSplitBarrierBlocksPass();
       /// (void) llvm::createDelayStoresPass();
       /// (void) llvm::createBitWidthAnalysisPass();
+      /// (void) llvm::createFixedPointAnalysisPass();
       /// (void) llvm::createShiftRegisterDetectionPass();
       /// (void) llvm::createRewriteExprPass();
       /// (void) llvm::createAggregateLoadsPass();
@@ -64,7 +65,7 @@ namespace {
       /// (void) llvm::createArgPromotionTrackerPass();
       /// (void) llvm::createCanonicalizePredecessorsPass();
       /// (void) llvm::createCFGOptimizerPass();
-      /// (void) llvm::createFindAllPathsPass();
+      /// (void) llvm::createBlockRoutingPass();
       // XXX: Functions for oclacc passes;
       ///(void) llvm::createOCLAccHWPass();
       ///(void) llvm::createGenerateDotPass();
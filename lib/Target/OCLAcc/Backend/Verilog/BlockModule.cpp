@@ -1,6 +1,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <sstream>
 #include <cmath>
@@ -8,7 +10,9 @@
 #include <map>
 #include <set>
 
+#include "../../HW/Arith.h"
 #include "../../HW/Kernel.h"
+#include "Passes/HardwareModel.h"
 
 #include "Flopoco.h"
 #include "Verilog.h"
@@ -19,14 +23,75 @@
 #include "OperatorInstances.h"
 
 #include "VerilogModule.h"
+#include "Burst.h"
+#include "LoadUnit.h"
+#include "Coalescer.h"
 
 #define DEBUG_TYPE "verilog"
 
 using namespace oclacc;
 
-static cl::opt<bool> NoPreserveLoadOrder("no-preserve-load-order", cl::init(false), cl::desc("Keep the order of memory loads.") );
 
-BlockModule::BlockModule(Block &B) : VerilogModule(B), Comp(B), CriticalPath(0) {
+static cl::opt<bool> PipelineBlocks("pipeline-blocks", cl::init(false), cl::desc("Accept new work-items in Blocks before the previous ones completed.") );
+
+static cl::opt<unsigned> BlockII("block-ii", cl::init(1), cl::desc("Initiation interval of pipelined Blocks.") );
+
+static cl::opt<bool> NoChaining("no-chaining", cl::init(false), cl::desc("Register every inferred integer operator instead of chaining them within a clock period.") );
+
+static cl::list<std::string> ResourceLimits("resource-limit", cl::CommaSeparated, cl::desc("Maximum number of instances of an operator per Block, e.g. FPMult=2,FPAdd_8_23=1"), cl::value_desc("Operator=N"));
+
+// Limits derived from the area of the design, see BlockModule::setAreaLimits
+static std::map<std::string, unsigned> AreaLimits;
+
+/// \brief Return the instance limit of \p OpName or 0 if unlimited.
+///
+/// Limits apply to the full operator name or to all operators starting with
+/// the given name followed by '_', e.g. FPMult limits FPMult_8_23. Without a
+/// matching -resource-limit, the area limit of the module is used.
+static unsigned getResourceLimit(const std::string &OpName) {
+  for (const std::string &L : ResourceLimits) {
+    std::string::size_type Pos = L.find('=');
+    if (Pos == std::string::npos || Pos == 0)
+      report_fatal_error("Invalid resource limit " + L + ", expected Operator=N");
+
+    const std::string Name = L.substr(0, Pos);
+
+    if (OpName != Name && OpName.compare(0, Name.size()+1, Name + "_") != 0)
+      continue;
+
+    const int N = std::atoi(L.substr(Pos+1).c_str());
+    if (N <= 0)
+      report_fatal_error("Invalid resource limit " + L + ", at least one instance required");
+
+    return N;
+  }
+
+  std::map<std::string, unsigned>::const_iterator AI = AreaLimits.find(OpName);
+  if (AI != AreaLimits.end())
+    return AI->second;
+
+  return 0;
+}
+
+void BlockModule::setAreaLimits(const std::map<std::string, unsigned> &Limits) {
+  AreaLimits = Limits;
+}
+
+BlockModule::BlockModule(Block &B) : VerilogModule(B), Comp(B), CriticalPath(0), Pipelined(false), InitiationInterval(1), LoopCondReady(0) {
+  // Memory accesses and barriers need the handshake of the state machine, so
+  // only pure dataflow Blocks are pipelined. Loops wait for their previous
+  // iteration.
+  if (PipelineBlocks) {
+    if (B.hasLoads() || B.hasStores() || B.getBarrier() != nullptr) {
+      ODEBUG(B.getUniqueName() << " accesses memory, not pipelined");
+    } else if (B.isLoop()) {
+      ODEBUG(B.getUniqueName() << " is a loop, not pipelined");
+    } else {
+      Pipelined = true;
+      InitiationInterval = std::max(1u, (unsigned) BlockII);
+    }
+  }
+
   // Clean up Components
   ConstSignals << "// Constant signals\n";
 
@@ -77,6 +142,9 @@ const std::string BlockModule::declConstValues() const {
 }
 
 const std::string BlockModule::declFSMSignals() const {
+  if (Pipelined)
+    return declPipelineSignals();
+
   std::stringstream S;
 
   std::vector<std::string> States = {"state_free", "state_busy", "state_wait_load", "state_wait_store", "state_wait_barrier", "state_wait_output"};
@@ -104,10 +172,19 @@ const std::string BlockModule::declFSMSignals() const {
   Signal CountEnabled("counter_enabled", 1, Signal::Local, Signal::Reg);
   S << CountEnabled.getDefStr() << ";\n";
 
+  // Set while the back-edge inputs hold the values of the next iteration
+  if (Comp.isLoop()) {
+    Signal LoopActive("loop_active", 1, Signal::Local, Signal::Reg);
+    S << LoopActive.getDefStr() << ";\n";
+  }
+
   return S.str();
 }
 
 const std::string BlockModule::declFSM() const {
+  if (Pipelined)
+    return declPipeline();
+
   std::stringstream S;
 
   // Needed when portlists are to be generated
@@ -118,17 +195,34 @@ const std::string BlockModule::declFSM() const {
   std::vector<std::string> ScalarInputNames;
   std::vector<std::string> ScalarOutputNames;
 
+  // Loop Blocks: back-edge ports and ports leaving the loop
+  std::vector<std::string> LoopInputNames;
+  std::vector<std::string> LoopOutputNames;
+  std::vector<std::string> ExitOutputNames;
+
   for (scalarport_p P : Comp.getInScalars()) {
-    if (P->isPipelined()) {
+    if (P->isBackEdge())
+      LoopInputNames.push_back(getOpName(P));
+    else if (P->isPipelined())
       ScalarInputNames.push_back(getOpName(P));
-    }
   }
 
   for (scalarport_p P : Comp.getOutScalars()) {
-    if (P->isPipelined())
-      ScalarOutputNames.push_back(getOpName(P));
+    if (!P->isPipelined()) continue;
+
+    ScalarOutputNames.push_back(getOpName(P));
+    if (P->isBackEdge())
+      LoopOutputNames.push_back(getOpName(P));
+    else
+      ExitOutputNames.push_back(getOpName(P));
   }
 
+  // The loop condition decides if the outputs are passed to the next iteration
+  // or leave the loop.
+  std::string LoopContinue;
+  if (Comp.isLoop())
+    LoopContinue = getOpName(Comp.getLoopCondition()) + (Comp.loopsIfTrue() ? " == 1" : " == 0");
+
   ////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////
@@ -153,6 +247,12 @@ const std::string BlockModule::declFSM() const {
         S << Prefix << Indent(II) << N << "_valid" << " == 1";
       Prefix = " && \n";
     }
+    if (Comp.isLoop()) {
+      S << Prefix << Indent(II) << "(loop_active == 0";
+      for (const std::string &N : LoopInputNames)
+        S << " || " << N << "_valid == 1";
+      S << ")";
+    }
     S << "\n" << Indent(--II) << ")" << "\n";
 
     // All inputs are valid. If we only have a barrier, skip the busy state and
@@ -181,15 +281,21 @@ const std::string BlockModule::declFSM() const {
       S << Indent(II+1) << "next_state <= state_wait_store;\n";
     }
 
+    // state_wait_output
+    S << Indent(II) << "if (counter == " << CriticalPath <<") next_state <= state_wait_output;\n";
+
+    // Loads are issued when their address is ready and only stall the Block
+    // when their data is needed, so their latency overlaps.
     for (loadaccess_p LI : Comp.getLoads()) {
       const std::string Name = getOpName(LI);
 
-      S << Indent(II) << "if (counter == " << getReadyCycle(Name) <<" && " << Name << "_valid == 0) next_state <= state_wait_load;\n";
+      S << Indent(II) << "if (counter == " << LoadDataMap.at(Name) << " && " << Name << "_valid == 0)\n";
+        BEGIN(S);
+        S << Indent(II) << "counter_enabled <= 0;\n";
+        S << Indent(II) << "next_state <= state_wait_load;\n";
+        END(S);
     }
 
-    // state_wait_output
-    S << Indent(II) << "if (counter == " << CriticalPath <<") next_state <= state_wait_output;\n";
-
     END(S);
   }
   S << Indent(II) << "state_wait_output:" << "\n";
@@ -237,14 +343,15 @@ const std::string BlockModule::declFSM() const {
     BEGIN(S);
     if (Comp.hasLoads()) {
       BEGIN(S);
-      S << Indent(II) << "if ((";
+      // The counter stopped at the cycle the data is needed
+      S << Indent(II) << "if (";
       Prefix = "";
       for (loadaccess_p LA : Comp.getLoads()) {
         const std::string LName = getOpName(LA);
-        S << Prefix << LName << "_address_valid && " << LName << "_unbuf_valid";
-        Prefix = "\n" + Indent(II) + " & ";
+        S << Prefix << "(counter != " << LoadDataMap.at(LName) << " || " << LName << "_valid == 1)";
+        Prefix = "\n" + Indent(II) + " && ";
       }
-      S << ") == 0)\n";
+      S << ")\n";
       S << Indent(II+1) << "next_state <= state_busy;\n";
 
       END(S);
@@ -289,6 +396,15 @@ const std::string BlockModule::declFSM() const {
       S << Indent(II) << N << "_ack <= 0" << ";\n";
     }
 
+    for (const std::string &N : LoopInputNames) {
+      S << Indent(II) << N << " <= '0;\n";
+      S << Indent(II) << N << "_valid <= 0" << ";\n";
+      S << Indent(II) << N << "_ack <= 0" << ";\n";
+    }
+
+    if (Comp.isLoop())
+      S << Indent(II) << "loop_active <= 0;\n";
+
     // Outout buffers and valids
     for (const std::string &N : ScalarOutputNames) {
       S << Indent(II) << N << " <= '0;\n";
@@ -335,6 +451,31 @@ const std::string BlockModule::declFSM() const {
     S << Indent(II) << "if (next_state == state_free)\n";
     {
       BEGIN(S);
+      if (Comp.isLoop()) {
+        // Keep the entry values and take the back-edge values for the next
+        // iteration. They are not acknowledged as the outputs are our own.
+        S << Indent(II) << "if (state != state_free && " << LoopContinue << ")\n";
+        BEGIN(S);
+        S << Indent(II) << "loop_active <= 1;\n";
+        for (const std::string &N : LoopInputNames) {
+          S << Indent(II) << N << " <= " << N << "_unbuf;\n";
+          S << Indent(II) << N << "_valid <= 1;\n";
+        }
+        END(S);
+        S << Indent(II) << "else if (state != state_free)\n";
+        BEGIN(S);
+        S << Indent(II) << "loop_active <= 0;\n";
+        for (const std::string &N : ScalarInputNames) {
+          S << Indent(II) << N << " <= '0;\n";
+          S << Indent(II) << N << "_valid <= 0;\n";
+        }
+        for (const std::string &N : LoopInputNames) {
+          S << Indent(II) << N << " <= '0;\n";
+          S << Indent(II) << N << "_valid <= 0;\n";
+        }
+        END(S);
+      }
+      else
       for (const std::string &N : ScalarInputNames) {
         S << Indent(II) << N << " <= '0;\n";
         S << Indent(II) << N << "_valid <= 0;\n";
@@ -395,6 +536,30 @@ const std::string BlockModule::declFSM() const {
 
           const std::string VName = getOpName(Val);
 
+          if (Comp.isLoop()) {
+            // Only one of back-edge and exit outputs is sent per iteration,
+            // the others are finished at once. Back-edge outputs are read
+            // directly when returning to state_free.
+            C = std::max(C, LoopCondReady);
+
+            std::string Send = LoopContinue;
+            if (!P->isBackEdge())
+              Send = "!(" + LoopContinue + ")";
+
+            S << Indent(II) << "if (counter >= " << C << " && " << Name << "_valid == 0 && " << Name << "_fin == 0)\n";
+              BEGIN(S);
+              S << Indent(II) << "if (" << Send << ")\n";
+                BEGIN(S);
+                S << Indent(II) << Name << " <= " << VName << ";\n";
+                S << Indent(II) << Name << "_valid <= 1;\n";
+                if (P->isBackEdge())
+                  S << Indent(II) << Name << "_fin <= 1;\n";
+                END(S);
+              S << Indent(II) << "else\n";
+              S << Indent(II+1) << Name << "_fin <= 1;\n";
+              END(S);
+            continue;
+          }
 
           S << Indent(II) << "if (counter >= " << C << " && " << Name << "_valid == 0 && " << Name << "_fin == 0)\n";
             BEGIN(S);
@@ -447,13 +612,293 @@ const std::string BlockModule::declFSM() const {
   return S.str();
 }
 
+unsigned BlockModule::getOutputFifoDepth() const {
+  // Enough space for all work-items in flight, so the pipeline never has to
+  // stall when the consumer accepts one output every InitiationInterval cycles.
+  unsigned Depth = 2;
+  while (Depth < CriticalPath / InitiationInterval + 2)
+    Depth *= 2;
+  return Depth;
+}
+
+/// \brief Signals of a pipelined Block
+///
+/// Instead of a single counter, a valid bit per stage tracks the work-items in
+/// flight. Outputs are buffered in FIFOs large enough for all work-items in
+/// flight.
+const std::string BlockModule::declPipelineSignals() const {
+  std::stringstream S;
+
+  S << "// Pipeline signals\n";
+
+  Signal StageValid("stage_valid", CriticalPath+1, Signal::Local, Signal::Reg);
+  S << StageValid.getDefStr() << ";\n";
+
+  Signal Accept("accept", 1, Signal::Local, Signal::Wire);
+  S << Accept.getDefStr() << ";\n";
+
+  unsigned Depth = getOutputFifoDepth();
+  unsigned AddrWidth = static_cast<unsigned>(std::log2(Depth));
+
+  Signal InFlight("inflight", AddrWidth+1, Signal::Local, Signal::Reg);
+  S << InFlight.getDefStr() << ";\n";
+
+  if (InitiationInterval > 1) {
+    unsigned IIWidth = static_cast<unsigned>(std::ceil(std::log2(InitiationInterval)));
+    Signal IICount("ii_counter", IIWidth, Signal::Local, Signal::Reg);
+    S << IICount.getDefStr() << ";\n";
+  }
+
+  S << "// Output FIFOs\n";
+  for (const scalarport_p P : Comp.getOutScalars()) {
+    const std::string Name = getOpName(P);
+
+    S << "reg [" << P->getBitWidth()-1 << ":0] " << Name << "_fifo [0:" << Depth-1 << "];\n";
+
+    Signal RD(Name+"_rd", AddrWidth, Signal::Local, Signal::Reg);
+    S << RD.getDefStr() << ";\n";
+    Signal WR(Name+"_wr", AddrWidth, Signal::Local, Signal::Reg);
+    S << WR.getDefStr() << ";\n";
+    Signal Count(Name+"_count", AddrWidth+1, Signal::Local, Signal::Reg);
+    S << Count.getDefStr() << ";\n";
+  }
+
+  return S.str();
+}
+
+/// \brief Control logic of a pipelined Block
+///
+/// A new work-item is accepted when all pipelined inputs are valid, the
+/// initiation interval has passed and all output FIFOs have space for every
+/// work-item in flight. Each output is written to its FIFO when the stage it
+/// gets ready in holds a valid work-item.
+const std::string BlockModule::declPipeline() const {
+  std::stringstream S;
+
+  std::vector<std::string> ScalarInputNames;
+
+  for (scalarport_p P : Comp.getInScalars()) {
+    if (P->isPipelined())
+      ScalarInputNames.push_back(getOpName(P));
+  }
+
+  const unsigned Depth = getOutputFifoDepth();
+
+  unsigned II = 0;
+  std::string Prefix;
+
+  S << "// Accept new work-item\n";
+  S << "assign accept = ";
+  Prefix = "";
+  for (const std::string &N : ScalarInputNames) {
+    S << Prefix << N << "_unbuf_valid == 1";
+    Prefix = "\n" + Indent(1) + "&& ";
+  }
+  if (InitiationInterval > 1) {
+    S << Prefix << "ii_counter == 0";
+    Prefix = "\n" + Indent(1) + "&& ";
+  }
+  for (const scalarport_p P : Comp.getOutScalars()) {
+    S << Prefix << "inflight + " << getOpName(P) << "_count < " << Depth;
+    Prefix = "\n" + Indent(1) + "&& ";
+  }
+  if (Prefix.empty())
+    S << "1";
+  S << ";\n";
+
+  // Acknowledge inputs in the same cycle, so a new work-item can follow
+  // immediately.
+  S << "// Acknowledge inputs and output FIFO heads\n";
+  S << "always @(*)\n";
+  BEGIN(S);
+  for (const std::string &N : ScalarInputNames)
+    S << Indent(II) << N << "_ack <= accept;\n";
+
+  for (const scalarport_p P : Comp.getOutScalars()) {
+    const std::string Name = getOpName(P);
+    S << Indent(II) << Name << " <= " << Name << "_fifo[" << Name << "_rd];\n";
+    S << Indent(II) << Name << "_valid <= " << Name << "_count != 0;\n";
+  }
+  END(S);
+
+  S << "// Pipeline stages\n";
+  S << "always @(posedge clk)\n";
+  BEGIN(S);
+  S << Indent(II) << "if (rst)\n";
+  {
+    BEGIN(S);
+    S << Indent(II) << "stage_valid <= '0;\n";
+    S << Indent(II) << "inflight <= '0;\n";
+    if (InitiationInterval > 1)
+      S << Indent(II) << "ii_counter <= '0;\n";
+
+    for (const std::string &N : ScalarInputNames) {
+      S << Indent(II) << N << " <= '0;\n";
+      S << Indent(II) << N << "_valid <= 0;\n";
+    }
+
+    for (const scalarport_p P : Comp.getOutScalars()) {
+      const std::string Name = getOpName(P);
+      S << Indent(II) << Name << "_rd <= '0;\n";
+      S << Indent(II) << Name << "_wr <= '0;\n";
+      S << Indent(II) << Name << "_count <= '0;\n";
+    }
+    END(S);
+  }
+  S << Indent(II) << "else\n";
+  {
+    BEGIN(S);
+    if (CriticalPath == 0)
+      S << Indent(II) << "stage_valid <= accept;\n";
+    else
+      S << Indent(II) << "stage_valid <= {stage_valid[" << CriticalPath-1 << ":0], accept};\n";
+
+    S << Indent(II) << "if (accept && !stage_valid[" << CriticalPath << "]) inflight <= inflight + 1;\n";
+    S << Indent(II) << "if (!accept && stage_valid[" << CriticalPath << "]) inflight <= inflight - 1;\n";
+
+    if (InitiationInterval > 1 && !SharedOps.empty()) {
+      // Shared operators reserve fixed slots modulo InitiationInterval, so
+      // work-items may only start in every InitiationInterval'th cycle.
+      S << Indent(II) << "if (ii_counter == 0) ii_counter <= " << InitiationInterval-1 << ";\n";
+      S << Indent(II) << "else ii_counter <= ii_counter - 1;\n";
+    } else if (InitiationInterval > 1) {
+      S << Indent(II) << "if (accept) ii_counter <= " << InitiationInterval-1 << ";\n";
+      S << Indent(II) << "else if (ii_counter != 0) ii_counter <= ii_counter - 1;\n";
+    }
+
+    // Buffer Inputs
+    S << Indent(II) << "if (accept)\n";
+    BEGIN(S);
+    for (const std::string &N : ScalarInputNames) {
+      S << Indent(II) << N << " <= " << N << "_unbuf;\n";
+      S << Indent(II) << N << "_valid <= 1;\n";
+    }
+    END(S);
+
+    // Outputs
+    for (const scalarport_p P : Comp.getOutScalars()) {
+      assert(P->getIns().size() == 1);
+
+      const std::string Name = getOpName(P);
+      const std::string VName = getOpName(P->getIn(0));
+      unsigned C = getReadyCycle(Name);
+
+      const std::string Push = "stage_valid[" + std::to_string(C) + "]";
+      const std::string Pop = "(" + Name + "_ack == 1 && " + Name + "_count != 0)";
+
+      S << Indent(II) << "// " << Name << "\n";
+      S << Indent(II) << "if (" << Push << ")\n";
+      BEGIN(S);
+      S << Indent(II) << Name << "_fifo[" << Name << "_wr] <= " << VName << ";\n";
+      S << Indent(II) << Name << "_wr <= " << Name << "_wr + 1;\n";
+      END(S);
+      S << Indent(II) << "if " << Pop << " " << Name << "_rd <= " << Name << "_rd + 1;\n";
+      S << Indent(II) << "if (" << Push << " && !" << Pop << ") " << Name << "_count <= " << Name << "_count + 1;\n";
+      S << Indent(II) << "if (!" << Push << " && " << Pop << ") " << Name << "_count <= " << Name << "_count - 1;\n";
+    }
+    END(S);
+  }
+  END(S);
+
+  return S.str();
+}
+
+const std::string BlockModule::getOperandName(const HW &Sink, const base_p Src) {
+  const std::string SrcName = getOpName(Src);
+
+  if (!Pipelined)
+    return SrcName;
+
+  // Constants and non-pipelined inputs do not change between work-items.
+  if (std::dynamic_pointer_cast<ConstVal>(Src))
+    return SrcName;
+
+  if (scalarport_p P = std::dynamic_pointer_cast<ScalarPort>(Src)) {
+    if (!P->isPipelined())
+      return SrcName;
+  }
+
+  const std::string Name = SrcName + "_to_" + getOpName(Sink);
+
+  for (const OperandTy &O : Operands) {
+    if (O.Name == Name)
+      return Name;
+  }
+
+  OperandTy O;
+  O.Name = Name;
+  O.Src = Src;
+  O.SinkName = getOpName(Sink);
+  O.Delay = 0;
+  Operands.push_back(O);
+
+  return Name;
+}
+
+/// \brief Declare a single delay line per source with taps for each consumer.
+const std::string BlockModule::declOperandDelays() const {
+  std::stringstream S;
+
+  if (!Pipelined)
+    return S.str();
+
+  S << "// Operand delays\n";
+
+  std::map<std::string, unsigned> MaxDelay;
+  std::map<std::string, unsigned> SrcWidth;
+
+  for (const OperandTy &O : Operands) {
+    const std::string SrcName = getOpName(O.Src);
+    MaxDelay[SrcName] = std::max(MaxDelay[SrcName], O.Delay);
+    SrcWidth[SrcName] = O.Src->getBitWidth();
+  }
+
+  for (const std::pair<std::string, unsigned> &D : MaxDelay) {
+    if (D.second == 0) continue;
+
+    const std::string &SrcName = D.first;
+
+    for (unsigned i = 1; i <= D.second; ++i) {
+      Signal DS(SrcName+"_d"+std::to_string(i), SrcWidth[SrcName], Signal::Local, Signal::Reg);
+      S << DS.getDefStr() << ";\n";
+    }
+
+    unsigned II = 0;
+    S << "always @(posedge clk)\n";
+    BEGIN(S);
+    S << Indent(II) << SrcName << "_d1 <= " << SrcName << ";\n";
+    for (unsigned i = 2; i <= D.second; ++i)
+      S << Indent(II) << SrcName << "_d" << i << " <= " << SrcName << "_d" << i-1 << ";\n";
+    END(S);
+  }
+
+  for (const OperandTy &O : Operands) {
+    const std::string SrcName = getOpName(O.Src);
+
+    Signal OS(O.Name, O.Src->getBitWidth(), Signal::Local, Signal::Wire);
+    S << OS.getDefStr() << ";\n";
+
+    if (O.Delay == 0)
+      S << "assign " << O.Name << " = " << SrcName << ";\n";
+    else
+      S << "assign " << O.Name << " = " << SrcName << "_d" << O.Delay << ";\n";
+  }
+
+  return S.str();
+}
+
 const std::string BlockModule::declStores() const {
   std::stringstream S;
   S << "// Store processes\n";
 
+  const BurstListTy Bursts = getStoreBursts(Comp);
+
   for (storeaccess_p SA : Comp.getStores()) {
     assert(SA->getIns().size() == 2 && "Stores must have an index and value");
 
+    if (findBurst(Bursts, *SA))
+      continue;
+
     const std::string Name = getOpName(SA);
     const streamindex_p Index = SA->getIndex();
 
@@ -507,6 +952,79 @@ const std::string BlockModule::declStores() const {
     END(S);
   }
 
+  for (const BurstTy &B : Bursts)
+    S << declStoreBurst(B);
+
+  return S.str();
+}
+
+/// \brief Write all elements of a burst, one bus word per beat.
+///
+/// The address and burstcount are held until the last beat is acknowledged.
+/// Store bursts cover whole beats only, so every lane holds an access.
+const std::string BlockModule::declStoreBurst(const BurstTy &B) const {
+  std::stringstream S;
+
+  const std::string &Name = B.Name;
+  const unsigned W = B.ElementBits;
+
+  int Clk = 0;
+  for (streamaccess_p A : B.Accesses)
+    Clk = std::max(Clk, getReadyCycle(getOpName(A)));
+
+  unsigned II = 0;
+  S << "// StoreBurst " << Name << ": " << B.Accesses.size() << " elements in " << B.Beats << " beats\n";
+  S << "always @(posedge clk)\n";
+    BEGIN(S);
+    S << Indent(II) << "if (rst==1)\n";
+      BEGIN(S);
+      S << Indent(II) << Name << "_address = '0;\n";
+      S << Indent(II) << Name << "_burstcount = '0;\n";
+      S << Indent(II) << Name << "_buf = '0;\n";
+      S << Indent(II) << Name << "_valid = 0;\n";
+      S << Indent(II) << Name << "_running = 0;\n";
+      S << Indent(II) << Name << "_beat = '0;\n";
+      for (streamaccess_p A : B.Accesses)
+        S << Indent(II) << getOpName(A) << "_fin = 0;\n";
+      END(S);
+
+    S << Indent(II) << "else\n";
+      BEGIN(S);
+      S << Indent(II) << "if (counter == " << Clk << " && " << Name << "_running == 0)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_address = " << B.Address << ";\n";
+        S << Indent(II) << Name << "_burstcount = " << B.Beats << ";\n";
+        S << Indent(II) << Name << "_beat = '0;\n";
+        S << Indent(II) << Name << "_valid = 1;\n";
+        S << Indent(II) << Name << "_running = 1;\n";
+        END(S);
+
+      S << Indent(II) << "if (" << Name << "_running == 1 && " << Name << "_ack == 1)\n";
+        BEGIN(S);
+        S << Indent(II) << "if (" << Name << "_beat == " << B.Beats-1 << ")\n";
+          BEGIN(S);
+          S << Indent(II) << Name << "_address = '0;\n";
+          S << Indent(II) << Name << "_burstcount = '0;\n";
+          S << Indent(II) << Name << "_valid = 0;\n";
+          S << Indent(II) << Name << "_running = 0;\n";
+          for (streamaccess_p A : B.Accesses)
+            S << Indent(II) << getOpName(A) << "_fin = 1;\n";
+          END(S);
+        S << Indent(II) << "else\n";
+        S << Indent(II+1) << Name << "_beat = " << Name << "_beat + 1;\n";
+        END(S);
+
+      // Data of the current beat
+      S << Indent(II) << Name << "_buf = '0;\n";
+      for (unsigned i = 0, e = B.Accesses.size(); i < e; ++i) {
+        const storeaccess_p SA = std::static_pointer_cast<StoreAccess>(B.Accesses[i]);
+
+        S << Indent(II) << "if (" << Name << "_running == 1 && " << Name << "_beat == " << B.getBeat(i) << ") ";
+        S << Name << "_buf[" << B.getLane(i)*W << " +: " << W << "] = " << getOpName(SA->getValue()) << ";\n";
+      }
+      END(S);
+  END(S);
+
   return S.str();
 }
 
@@ -514,7 +1032,14 @@ const std::string BlockModule::declLoads() const {
   std::stringstream S;
   S << "// Load processes\n";
 
+  const BurstListTy Bursts = getLoadBursts(Comp);
+  const LoadUnitListTy Units = getLoadUnits(Comp);
+  const CoalescerListTy Coalescers = getCoalescers(Comp);
+
   for (loadaccess_p LA : Comp.getLoads()) {
+    if (findBurst(Bursts, *LA) || findLoadUnit(Units, *LA) || findCoalescer(Coalescers, *LA))
+      continue;
+
     const std::string Name = getOpName(LA);
     const streamindex_p Index = LA->getIndex();
 
@@ -550,7 +1075,10 @@ const std::string BlockModule::declLoads() const {
         // Set signal for a single cycle
         S << Indent(II) << Name << "_ack = 0;\n";
 
-        S << Indent(II) << "if (counter == " << Clk << " && " << Name << "_address_valid == 0)\n";
+        // Data of the last work-item
+        S << Indent(II) << "if (state == state_free) " << Name << "_valid = 0;\n";
+
+        S << Indent(II) << "if (state != state_free && counter == " << Clk << " && " << Name << "_address_valid == 0 && " << Name << "_valid == 0)\n";
           BEGIN(S);
           S << Indent(II) << Name << "_address = " << IndexName << ";\n";
           S << Indent(II) << Name << "_address_valid = 1;\n";
@@ -568,6 +1096,314 @@ const std::string BlockModule::declLoads() const {
 
     END(S);
   }
+
+  for (const BurstTy &B : Bursts)
+    S << declLoadBurst(B);
+
+  for (const LoadUnitTy &U : Units)
+    S << declLoadUnit(U);
+
+  for (const CoalescerTy &C : Coalescers)
+    S << declCoalescer(C);
+
+  return S.str();
+}
+
+/// \brief Coalescer keeping the last line fetched for its load.
+///
+/// A work-item whose element is in the line gets it in the cycle its address
+/// is ready. Otherwise the aligned line is requested and replaces the kept
+/// one.
+const std::string BlockModule::declCoalescer(const CoalescerTy &C) const {
+  std::stringstream S;
+
+  const std::string &Name = C.Name;
+  const std::string LName = getOpName(C.Load);
+  const unsigned W = C.ElementBits;
+  const unsigned LB = C.getLineOffsetBits();
+  const unsigned EB = C.getElementOffsetBits();
+
+  const streamindex_p Index = C.Load->getIndex();
+
+  std::string IndexName;
+  if (staticstreamindex_p SI = std::dynamic_pointer_cast<StaticStreamIndex>(Index))
+    IndexName = SI->getIndex()->getUniqueName();
+  else
+    IndexName = getOpName(std::static_pointer_cast<DynamicStreamIndex>(Index)->getIndex());
+
+  const std::string Sel = Name + "_index[" + std::to_string(LB-1) + ":" + std::to_string(EB) + "]";
+  const std::string Line = Name + "_index[63:" + std::to_string(LB) + "]";
+
+  unsigned Clk = getReadyCycle(LName);
+
+  S << "assign " << Name << "_index = " << IndexName << ";\n";
+
+  unsigned II = 0;
+  S << "// Coalescer " << Name << ": " << C.ElementsPerLine << " elements per line\n";
+  S << "always @(posedge clk)\n";
+    BEGIN(S);
+    S << Indent(II) << "if (rst==1)\n";
+      BEGIN(S);
+      // local buffer
+      S << Indent(II) << LName << " = '0;\n";
+      S << Indent(II) << LName << "_valid = 0;\n";
+      // ports
+      S << Indent(II) << Name << "_address = '0;\n";
+      S << Indent(II) << Name << "_address_valid = 0;\n";
+      S << Indent(II) << Name << "_ack = 0;\n";
+      // line
+      S << Indent(II) << Name << "_line = '0;\n";
+      S << Indent(II) << Name << "_line_address = '0;\n";
+      S << Indent(II) << Name << "_line_valid = 0;\n";
+      S << Indent(II) << Name << "_sel = '0;\n";
+      END(S);
+
+    S << Indent(II) << "else\n";
+      BEGIN(S);
+      // Set signal for a single cycle
+      S << Indent(II) << Name << "_ack = 0;\n";
+
+      // The line may hold data of the buffers of the last launch
+      S << Indent(II) << "if (start == 1) " << Name << "_line_valid = 0;\n";
+
+      // Data of the last work-item
+      S << Indent(II) << "if (state == state_free) " << LName << "_valid = 0;\n";
+
+      S << Indent(II) << "if (state != state_free && counter == " << Clk << " && " << Name << "_address_valid == 0 && " << LName << "_valid == 0)\n";
+        BEGIN(S);
+        S << Indent(II) << "if (" << Name << "_line_valid == 1 && " << Name << "_line_address[63:" << LB << "] == " << Line << ")\n";
+          BEGIN(S);
+          S << Indent(II) << LName << " = " << Name << "_line[" << Sel << "*" << W << " +: " << W << "];\n";
+          S << Indent(II) << LName << "_valid = 1;\n";
+          END(S);
+        S << Indent(II) << "else\n";
+          BEGIN(S);
+          S << Indent(II) << Name << "_address = {" << Line << ", " << LB << "'b0};\n";
+          S << Indent(II) << Name << "_address_valid = 1;\n";
+          S << Indent(II) << Name << "_sel = " << Sel << ";\n";
+          END(S);
+        END(S);
+
+      S << Indent(II) << "if (" << Name << "_address_valid == 1 && " << Name << "_unbuf_valid == 1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_line = " << Name << "_unbuf;\n";
+        S << Indent(II) << Name << "_line_address = " << Name << "_address;\n";
+        S << Indent(II) << Name << "_line_valid = 1;\n";
+        S << Indent(II) << LName << " = " << Name << "_unbuf[" << Name << "_sel*" << W << " +: " << W << "];\n";
+        S << Indent(II) << LName << "_valid = 1;\n";
+        S << Indent(II) << Name << "_ack = 1;\n";
+        S << Indent(II) << Name << "_address = '0;\n";
+        S << Indent(II) << Name << "_address_valid = 0;\n";
+        END(S);
+      END(S);
+
+    END(S);
+
+  return S.str();
+}
+
+/// \brief Load unit with a reorder buffer of Outstanding entries.
+///
+/// A tag is allocated in request order when the request is accepted. The
+/// response carrying the tag fills its entry, entries retire in the order of
+/// allocation into the buffer of the load stored with the tag.
+const std::string BlockModule::declLoadUnit(const LoadUnitTy &U) const {
+  std::stringstream S;
+
+  const std::string &Name = U.Name;
+  const unsigned K = U.Outstanding;
+
+  unsigned II = 0;
+  S << "// LoadUnit " << Name << ": " << U.Loads.size() << " loads, " << K << " outstanding\n";
+  S << "always @(posedge clk)\n";
+    BEGIN(S);
+    S << Indent(II) << "if (rst==1)\n";
+      BEGIN(S);
+      // local buffers
+      for (loadaccess_p L : U.Loads) {
+        S << Indent(II) << getOpName(L) << " = '0;\n";
+        S << Indent(II) << getOpName(L) << "_valid = 0;\n";
+      }
+      // ports
+      S << Indent(II) << Name << "_address = '0;\n";
+      S << Indent(II) << Name << "_address_tag = '0;\n";
+      S << Indent(II) << Name << "_address_valid = 0;\n";
+      S << Indent(II) << Name << "_ack = 0;\n";
+      // reorder buffer
+      S << Indent(II) << Name << "_issued = '0;\n";
+      S << Indent(II) << Name << "_sel = '0;\n";
+      S << Indent(II) << Name << "_head = '0;\n";
+      S << Indent(II) << Name << "_tail = '0;\n";
+      S << Indent(II) << Name << "_rob_busy = '0;\n";
+      S << Indent(II) << Name << "_rob_done = '0;\n";
+      END(S);
+
+    S << Indent(II) << "else\n";
+      BEGIN(S);
+      // Set signal for a single cycle
+      S << Indent(II) << Name << "_ack = 0;\n";
+
+      // All loads of the last work-item retired before returning to state_free
+      S << Indent(II) << "if (state == state_free)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_issued = '0;\n";
+        for (loadaccess_p L : U.Loads)
+          S << Indent(II) << getOpName(L) << "_valid = 0;\n";
+        END(S);
+
+      // Request accepted, allocate the tag
+      S << Indent(II) << "if (" << Name << "_address_valid == 1 && " << Name << "_address_ready == 1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_rob_busy[" << Name << "_tail] = 1;\n";
+        S << Indent(II) << Name << "_rob_load[" << Name << "_tail] = " << Name << "_sel;\n";
+        S << Indent(II) << Name << "_tail = (" << Name << "_tail == " << K-1 << ") ? 0 : " << Name << "_tail + 1;\n";
+        S << Indent(II) << Name << "_address = '0;\n";
+        S << Indent(II) << Name << "_address_valid = 0;\n";
+        END(S);
+
+      // Issue the first load in program order whose address is ready
+      S << Indent(II) << "if (state != state_free && " << Name << "_address_valid == 0 && " << Name << "_rob_busy[" << Name << "_tail] == 0)\n";
+        BEGIN(S);
+        std::string Else = "";
+        for (unsigned i = 0, e = U.Loads.size(); i < e; ++i) {
+          const loadaccess_p L = U.Loads[i];
+          const std::string LName = getOpName(L);
+          const streamindex_p Index = L->getIndex();
+
+          std::string IndexName;
+          if (staticstreamindex_p SI = std::dynamic_pointer_cast<StaticStreamIndex>(Index))
+            IndexName = SI->getIndex()->getUniqueName();
+          else
+            IndexName = getOpName(std::static_pointer_cast<DynamicStreamIndex>(Index)->getIndex());
+
+          S << Indent(II) << Else << "if (counter >= " << getReadyCycle(LName) << " && " << Name << "_issued[" << i << "] == 0)\n";
+            BEGIN(S);
+            S << Indent(II) << Name << "_address = " << IndexName << ";\n";
+            S << Indent(II) << Name << "_address_tag = " << Name << "_tail;\n";
+            S << Indent(II) << Name << "_address_valid = 1;\n";
+            S << Indent(II) << Name << "_sel = " << i << ";\n";
+            S << Indent(II) << Name << "_issued[" << i << "] = 1;\n";
+            END(S);
+          Else = "else ";
+        }
+        END(S);
+
+      // Responses may return in any order
+      S << Indent(II) << "if (" << Name << "_unbuf_valid == 1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_rob_data[" << Name << "_unbuf_tag] = " << Name << "_unbuf;\n";
+        S << Indent(II) << Name << "_rob_done[" << Name << "_unbuf_tag] = 1;\n";
+        S << Indent(II) << Name << "_ack = 1;\n";
+        END(S);
+
+      // Retire in request order
+      S << Indent(II) << "if (" << Name << "_rob_busy[" << Name << "_head] == 1 && " << Name << "_rob_done[" << Name << "_head] == 1)\n";
+        BEGIN(S);
+        for (unsigned i = 0, e = U.Loads.size(); i < e; ++i) {
+          const std::string LName = getOpName(U.Loads[i]);
+
+          S << Indent(II) << "if (" << Name << "_rob_load[" << Name << "_head] == " << i << ")\n";
+            BEGIN(S);
+            S << Indent(II) << LName << " = " << Name << "_rob_data[" << Name << "_head];\n";
+            S << Indent(II) << LName << "_valid = 1;\n";
+            END(S);
+        }
+        S << Indent(II) << Name << "_rob_busy[" << Name << "_head] = 0;\n";
+        S << Indent(II) << Name << "_rob_done[" << Name << "_head] = 0;\n";
+        S << Indent(II) << Name << "_head = (" << Name << "_head == " << K-1 << ") ? 0 : " << Name << "_head + 1;\n";
+        END(S);
+      END(S);
+  END(S);
+
+  return S.str();
+}
+
+/// \brief Read all elements of a burst with a single request.
+///
+/// Each returned bus word is split into the buffers of its accesses. The
+/// handshake signals of the accesses follow the burst, so the FSM waits for
+/// them like for single loads.
+const std::string BlockModule::declLoadBurst(const BurstTy &B) const {
+  std::stringstream S;
+
+  const std::string &Name = B.Name;
+  const unsigned W = B.ElementBits;
+
+  int Clk = 0;
+  for (streamaccess_p A : B.Accesses)
+    Clk = std::max(Clk, getReadyCycle(getOpName(A)));
+
+  for (streamaccess_p A : B.Accesses) {
+    const std::string AName = getOpName(A);
+    S << "assign " << AName << "_address_valid = " << Name << "_address_valid;\n";
+    S << "assign " << AName << "_unbuf_valid = " << Name << "_unbuf_valid;\n";
+  }
+
+  unsigned II = 0;
+  S << "// LoadBurst " << Name << ": " << B.Accesses.size() << " elements in " << B.Beats << " beats\n";
+  S << "always @(posedge clk)\n";
+    BEGIN(S);
+    S << Indent(II) << "if (rst==1)\n";
+      BEGIN(S);
+      // local buffers
+      for (streamaccess_p A : B.Accesses) {
+        S << Indent(II) << getOpName(A) << " = '0;\n";
+        S << Indent(II) << getOpName(A) << "_valid = 0;\n";
+      }
+      // ports
+      S << Indent(II) << Name << "_address = '0;\n";
+      S << Indent(II) << Name << "_burstcount = '0;\n";
+      S << Indent(II) << Name << "_address_valid = 0;\n";
+      S << Indent(II) << Name << "_ack = 0;\n";
+      S << Indent(II) << Name << "_beat = '0;\n";
+      END(S);
+
+    S << Indent(II) << "else\n";
+      BEGIN(S);
+      // Set signal for a single cycle
+      S << Indent(II) << Name << "_ack = 0;\n";
+
+      // Data of the last work-item
+      S << Indent(II) << "if (state == state_free)\n";
+        BEGIN(S);
+        for (streamaccess_p A : B.Accesses)
+          S << Indent(II) << getOpName(A) << "_valid = 0;\n";
+        END(S);
+
+      S << Indent(II) << "if (state != state_free && counter == " << Clk << " && " << Name << "_address_valid == 0 && " << getOpName(B.Accesses.front()) << "_valid == 0)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_address = " << B.Address << ";\n";
+        S << Indent(II) << Name << "_burstcount = " << B.Beats << ";\n";
+        S << Indent(II) << Name << "_beat = '0;\n";
+        S << Indent(II) << Name << "_address_valid = 1;\n";
+        END(S);
+
+      S << Indent(II) << "if (" << Name << "_address_valid == 1 && " << Name << "_unbuf_valid == 1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_ack = 1;\n";
+
+        for (unsigned i = 0, e = B.Accesses.size(); i < e; ++i) {
+          const std::string AName = getOpName(B.Accesses[i]);
+
+          S << Indent(II) << "if (" << Name << "_beat == " << B.getBeat(i) << ")\n";
+            BEGIN(S);
+            S << Indent(II) << AName << " = " << Name << "_unbuf[" << B.getLane(i)*W << " +: " << W << "];\n";
+            S << Indent(II) << AName << "_valid = 1;\n";
+            END(S);
+        }
+
+        S << Indent(II) << "if (" << Name << "_beat == " << B.Beats-1 << ")\n";
+          BEGIN(S);
+          S << Indent(II) << Name << "_address = '0;\n";
+          S << Indent(II) << Name << "_burstcount = '0;\n";
+          S << Indent(II) << Name << "_address_valid = 0;\n";
+          END(S);
+        S << Indent(II) << "else\n";
+        S << Indent(II+1) << Name << "_beat = " << Name << "_beat + 1;\n";
+        END(S);
+      END(S);
+  END(S);
+
   return S.str();
 }
 
@@ -594,6 +1430,63 @@ const std::string BlockModule::declPortControlSignals() const {
     S << SV.getDefStr() << ";\n";
   }
 
+  S << "// Burst internal\n";
+  for (const BurstTy &B : getLoadBursts(Comp)) {
+    Signal SB(B.Name+"_beat", std::ceil(std::log2(B.Beats+1)), Signal::Local, Signal::Reg);
+    S << SB.getDefStr() << ";\n";
+
+    // Handshake of the accesses is driven by the burst
+    for (streamaccess_p A : B.Accesses) {
+      Signal SA(getOpName(A)+"_address_valid", 1, Signal::Local, Signal::Wire);
+      S << SA.getDefStr() << ";\n";
+      Signal SU(getOpName(A)+"_unbuf_valid", 1, Signal::Local, Signal::Wire);
+      S << SU.getDefStr() << ";\n";
+    }
+  }
+
+  for (const LoadUnitTy &U : getLoadUnits(Comp)) {
+    const std::string &Name = U.Name;
+    const unsigned K = U.Outstanding;
+
+    Signal SI(Name+"_issued", U.Loads.size(), Signal::Local, Signal::Reg);
+    S << SI.getDefStr() << ";\n";
+    Signal SS(Name+"_sel", U.getSelWidth(), Signal::Local, Signal::Reg);
+    S << SS.getDefStr() << ";\n";
+    Signal SH(Name+"_head", U.getTagWidth(), Signal::Local, Signal::Reg);
+    S << SH.getDefStr() << ";\n";
+    Signal ST(Name+"_tail", U.getTagWidth(), Signal::Local, Signal::Reg);
+    S << ST.getDefStr() << ";\n";
+    Signal SB(Name+"_rob_busy", K, Signal::Local, Signal::Reg);
+    S << SB.getDefStr() << ";\n";
+    Signal SD(Name+"_rob_done", K, Signal::Local, Signal::Reg);
+    S << SD.getDefStr() << ";\n";
+
+    S << "reg [" << U.getSelWidth()-1 << ":0] " << Name << "_rob_load [0:" << K-1 << "];\n";
+    S << "reg [" << U.Stream->getBitWidth()-1 << ":0] " << Name << "_rob_data [0:" << K-1 << "];\n";
+  }
+
+  for (const CoalescerTy &C : getCoalescers(Comp)) {
+    const std::string &Name = C.Name;
+
+    Signal SI(Name+"_index", 64, Signal::Local, Signal::Wire);
+    S << SI.getDefStr() << ";\n";
+    Signal SL(Name+"_line", C.getLineBits(), Signal::Local, Signal::Reg);
+    S << SL.getDefStr() << ";\n";
+    Signal SA(Name+"_line_address", 64, Signal::Local, Signal::Reg);
+    S << SA.getDefStr() << ";\n";
+    Signal SV(Name+"_line_valid", 1, Signal::Local, Signal::Reg);
+    S << SV.getDefStr() << ";\n";
+    Signal SS(Name+"_sel", C.getSelWidth(), Signal::Local, Signal::Reg);
+    S << SS.getDefStr() << ";\n";
+  }
+
+  for (const BurstTy &B : getStoreBursts(Comp)) {
+    Signal SB(B.Name+"_beat", std::ceil(std::log2(B.Beats+1)), Signal::Local, Signal::Reg);
+    S << SB.getDefStr() << ";\n";
+    Signal SR(B.Name+"_running", 1, Signal::Local, Signal::Reg);
+    S << SR.getDefStr() << ";\n";
+  }
+
   S << "// OutScalar internal\n";
   for (const scalarport_p P : Comp.getOutScalars()) {
     Signal SF(getOpName(P)+"_fin", 1, Signal::Local, Signal::Reg);
@@ -614,89 +1507,576 @@ const std::string BlockModule::declPortControlSignals() const {
 #undef DEBUG_TYPE
 #define DEBUG_TYPE "timing"
 
+/// \brief Operator class of inferred operators which may be chained, empty
+/// for all others.
+static const std::string getChainOperator(const HW &R) {
+  if (dynamic_cast<const Add *>(&R) || dynamic_cast<const Sub *>(&R))
+    return "IntAdd";
+
+  if (dynamic_cast<const And *>(&R) || dynamic_cast<const Or *>(&R) || dynamic_cast<const Xor *>(&R))
+    return "Logic";
+
+  return "";
+}
+
+/// \brief Chain operators in topological order.
+///
+/// The arrival time of an operator's result is the latest arrival of its
+/// operands plus its own delay. Registered values arrive at the beginning of
+/// the cycle. If an operator does not fit into the period behind its
+/// operands, the chained operands are registered instead, so it starts a new
+/// cycle.
+///
+/// Results used by other operators, e.g. FloPoCo operators, are registered,
+/// as their first stage is not part of the delay model. Output ports are
+/// registered by the Block anyway. Muxes are always combinational, so their
+/// delay adds to the arrival of their result, as does any delay passed
+/// through slices and concatenations.
+void BlockModule::chainOperators() {
+  Chained.clear();
+
+  if (NoChaining)
+    return;
+
+  const Loopus::HardwareModel &HM = Loopus::HardwareModel::getHardwareModel();
+  const double Period = 1000.0 / flopoco::getFrequency() - HM.getRegisterDelay();
+
+  std::map<const HW *, double> Arrival;
+
+  for (const base_p &P : Comp.getOpsTopologicallySorted()) {
+    // Combinational producers which are never registered
+    if (std::dynamic_pointer_cast<Mux>(P)) {
+      Arrival[P.get()] = HM.getOperatorDelay("Mux", P->getBitWidth());
+      continue;
+    }
+
+    if (std::dynamic_pointer_cast<Slice>(P) || std::dynamic_pointer_cast<Concat>(P)) {
+      for (const base_p &In : P->getIns())
+        Arrival[P.get()] = std::max(Arrival[P.get()], Arrival[In.get()]);
+      continue;
+    }
+
+    const std::string Operator = getChainOperator(*P);
+    if (Operator.empty())
+      continue;
+
+    const double Delay = HM.getOperatorDelay(Operator, P->getBitWidth());
+
+    double Start = 0;
+    for (const base_p &In : P->getIns())
+      Start = std::max(Start, Arrival[In.get()]);
+
+    if (Start + Delay > Period) {
+      Start = 0;
+      for (const base_p &In : P->getIns()) {
+        if (Chained.erase(In->getUniqueName()))
+          Arrival[In.get()] = 0;
+        Start = std::max(Start, Arrival[In.get()]);
+      }
+    }
+
+    bool OnlyChainedUsers = true;
+    for (const base_p &Out : P->getOuts()) {
+      if (!std::dynamic_pointer_cast<ScalarPort>(Out) && getChainOperator(*Out).empty()) {
+        OnlyChainedUsers = false;
+        break;
+      }
+    }
+
+    if (OnlyChainedUsers && Start + Delay <= Period) {
+      Chained.insert(P->getUniqueName());
+      Arrival[P.get()] = Start + Delay;
+    }
+  }
+
+  ODEBUG(Comp.getUniqueName() << ": " << Chained.size() << " chained operators");
+}
+
 void BlockModule::schedule(const OperatorInstances &I) {
-  typedef Identifiable::UIDTy UIDTy;
-  typedef std::set<std::pair<UIDTy, UIDTy> > AddedConsTy;
+  typedef std::vector<std::pair<streamaccess_p, streamaccess_p> > AddedConsTy;
   AddedConsTy AddedCons;
 
-  // Add additional dependencies between Loads to keep their order and remove
-  // them afterwards.
-  if (!NoPreserveLoadOrder) {
-    StreamPort::LoadListTy LL = Comp.getLoads();
+  // Add additional dependencies between accesses to the same stream to keep
+  // their order and remove them afterwards. Only pairs with a store which may
+  // touch the same address are ordered, loads never conflict with each
+  // other.
+  const StreamPort::AccessListTy &Accesses = Comp.getStreamAccesses();
 
-    for (StreamPort::LoadListTy::iterator LI = LL.begin(), LE = LL.end(); LI != LE; ++LI) {
-      if (std::next(LI) == LE) break;
+  for (StreamPort::AccessListTy::const_iterator AI = Accesses.begin(), AE = Accesses.end(); AI != AE; ++AI) {
+    for (StreamPort::AccessListTy::const_iterator NI = std::next(AI); NI != AE; ++NI) {
+      streamaccess_p This = *AI;
+      streamaccess_p Next = *NI;
 
-      loadaccess_p This = *LI;
-      loadaccess_p Next = *(std::next(LI));
+      if (This->getStream() != Next->getStream())
+        continue;
 
-      if (This->getStream() == Next->getStream()) {
-        AddedCons.insert(std::make_pair(This->getUID(), Next->getUID()));
-        This->addOut(Next);
-        Next->addIn(This);
-      }
+      if (This->isLoad() && Next->isLoad())
+        continue;
+
+      if (Comp.areIndependentAccesses(*This, *Next))
+        continue;
+
+      // Already ordered by the dataflow
+      if (This->hasOut(Next.get()))
+        continue;
+
+      AddedCons.push_back(std::make_pair(This, Next));
+      This->addOut(Next);
+      Next->addIn(This);
     }
   }
 
+  ODEBUG(Comp.getUniqueName() << ": " << AddedCons.size() << " ordered memory accesses");
+
   HW::HWListTy Ops = Comp.getOpsTopologicallySorted();
 
+  const std::vector<scalarport_p> &InScalars = Comp.getInScalars();
+
+  // Predecessors of each operation. InScalars are ready at once, even if fed
+  // by the Block itself through a back-edge.
+  std::map<std::string, std::vector<std::string> > Preds;
+  std::map<std::string, std::vector<std::string> > Succs;
+
   for (base_p P : Ops) {
-    int MaxPreds = 0;
+    const std::string OpName = getOpName(P);
+    Preds[OpName];
+    Succs[OpName];
+
+    if (std::find(InScalars.begin(), InScalars.end(), P) != InScalars.end())
+      continue;
 
     for (base_p In : P->getIns()) {
       // Skip all InScalars
       if (In->getParent().get() != &Comp) continue;
 
       const std::string InName = getOpName(In);
-      int InReady = getReadyCycle(InName);
-
-      // Latency of input operation
-      op_p Op = I.getOperatorForHW(InName);
+      Preds[OpName].push_back(InName);
+      Succs[InName].push_back(OpName);
+    }
+  }
 
-      if (Op) {
-        InReady += Op->Cycles;
+  // Accesses of a burst share a single request and start in the same cycle,
+  // so each waits for the operands of all others.
+  BurstListTy Bursts = getLoadBursts(Comp);
+  const BurstListTy StoreBursts = getStoreBursts(Comp);
+  Bursts.insert(Bursts.end(), StoreBursts.begin(), StoreBursts.end());
+
+  for (const BurstTy &B : Bursts) {
+    std::set<std::string> Members;
+    for (streamaccess_p A : B.Accesses)
+      Members.insert(getOpName(A));
+
+    std::vector<std::string> Union;
+    for (const std::string &M : Members) {
+      for (const std::string &Pred : Preds[M]) {
+        if (Members.count(Pred) == 0 && std::find(Union.begin(), Union.end(), Pred) == Union.end())
+          Union.push_back(Pred);
       }
-
-      MaxPreds = std::max(MaxPreds, InReady);
     }
 
-    const std::string OpName = getOpName(P);
+    for (const std::string &M : Members)
+      Preds[M] = Union;
+  }
+
+  // Priority of the list scheduler: longest path to the end of the Block.
+  // Global loads count with the memory latency, so they are issued as early
+  // as possible and other operations overlap with the memory access.
+  const unsigned MemLatency = Loopus::HardwareModel::getHardwareModel().getGMemLatency();
 
-    ReadyMap[OpName] = MaxPreds;
+  std::map<std::string, unsigned> Height;
+  for (HW::HWListTy::const_reverse_iterator OI = Ops.rbegin(), OE = Ops.rend(); OI != OE; ++OI) {
+    const std::string OpName = getOpName(*OI);
 
-    // Critical Path
-    op_p Op = I.getOperatorForHW(OpName);
+    unsigned MaxSucc = 0;
+    for (const std::string &Succ : Succs[OpName])
+      MaxSucc = std::max(MaxSucc, Height[Succ]);
 
-    if (Op)
-      MaxPreds += Op->Cycles;
+    Height[OpName] = MaxSucc + getLatency(I, OpName);
 
-    CriticalPath = std::max((unsigned) MaxPreds, CriticalPath);
+    loadaccess_p L = std::dynamic_pointer_cast<LoadAccess>(*OI);
+    if (L && L->getStream()->getAddressSpace() != ocl::AS_LOCAL)
+      Height[OpName] += MemLatency;
   }
 
-  if (!NoPreserveLoadOrder) {
-    StreamPort::LoadListTy LL = Comp.getLoads();
+  // Shared operators in pipelined Blocks reserve their instance every
+  // InitiationInterval cycles, so each instance may only execute
+  // InitiationInterval operations per work-item.
+  std::map<std::string, unsigned> SharedCount;
+  for (const SharedOpsTy::value_type &SO : SharedOps)
+    SharedCount[SO.second.OpName]++;
+
+  if (Pipelined) {
+    for (const std::pair<std::string, unsigned> &SC : SharedCount) {
+      const unsigned Limit = getResourceLimit(SC.first);
+      InitiationInterval = std::max(InitiationInterval, (SC.second + Limit - 1) / Limit);
+    }
+  }
+
+  // Reserved cycles of each instance
+  typedef std::vector<std::set<unsigned> > ReservationsTy;
+  std::map<std::string, ReservationsTy> Reservations;
+
+  // Cycle-by-cycle list scheduling. Operations without resource limit are
+  // scheduled as soon as possible.
+  std::vector<std::string> Pending;
+  for (base_p P : Ops)
+    Pending.push_back(getOpName(P));
+
+  std::map<std::string, unsigned> Finish;
+
+  for (unsigned Cycle = 0; !Pending.empty(); ++Cycle) {
+    bool Changed = true;
+
+    // Operations without latency may start in the same cycle as their
+    // predecessors.
+    while (Changed) {
+      Changed = false;
+
+      std::vector<std::string> Candidates;
+      for (const std::string &OpName : Pending) {
+        bool Ready = true;
+        for (const std::string &Pred : Preds[OpName]) {
+          std::map<std::string, unsigned>::const_iterator FI = Finish.find(Pred);
+          if (FI == Finish.end() || FI->second > Cycle) {
+            Ready = false;
+            break;
+          }
+        }
+
+        if (Ready)
+          Candidates.push_back(OpName);
+      }
+
+      std::stable_sort(Candidates.begin(), Candidates.end(), [&Height](const std::string &A, const std::string &B) {
+          return Height[A] > Height[B];
+          });
+
+      for (const std::string &OpName : Candidates) {
+        SharedOpsTy::iterator SI = SharedOps.find(OpName);
 
-    for (StreamPort::LoadListTy::iterator LI = LL.begin(), LE = LL.end(); LI != LE; ++LI) {
-      if (std::next(LI) == LE) break;
+        if (SI != SharedOps.end()) {
+          SharedOpTy &SO = SI->second;
+          ReservationsTy &R = Reservations[SO.OpName];
 
-      loadaccess_p This = *LI;
-      loadaccess_p Next = *(std::next(LI));
+          const unsigned Slot = Pipelined ? Cycle % InitiationInterval : Cycle;
 
-      AddedConsTy::iterator I = AddedCons.find(std::make_pair(This->getUID(), Next->getUID()));
-      if (I != AddedCons.end()) {
-        AddedCons.erase(I);
-        This->delOut(Next);
-        Next->delIn(This);
+          unsigned Inst = 0;
+          while (Inst < R.size() && R[Inst].count(Slot))
+            ++Inst;
+
+          if (Inst == R.size()) {
+            if (R.size() == getResourceLimit(SO.OpName))
+              continue;
+            R.push_back(std::set<unsigned>());
+          }
+
+          R[Inst].insert(Slot);
+          SO.Instance = Inst;
+        }
+
+        ReadyMap[OpName] = Cycle;
+        Finish[OpName] = Cycle + getLatency(I, OpName);
+        CriticalPath = std::max(Finish[OpName], CriticalPath);
+
+        Pending.erase(std::find(Pending.begin(), Pending.end(), OpName));
+        Changed = true;
+      }
+    }
+
+    // Operations waiting for a cycle or an instance have all predecessors
+    // scheduled. If none has, the dependences contain a cycle.
+    bool Waiting = Pending.empty();
+    for (const std::string &OpName : Pending) {
+      bool Scheduled = true;
+      for (const std::string &Pred : Preds[OpName])
+        Scheduled &= Finish.count(Pred) != 0;
+
+      if (Scheduled) {
+        Waiting = true;
+        break;
       }
     }
-  } 
+
+    if (!Waiting)
+      report_fatal_error("Cyclic dependences between operations of Block " + Comp.getUniqueName() + ", e.g. " + Pending.front());
+  }
+
+  for (const std::pair<const std::string, ReservationsTy> &R : Reservations)
+    SharedInstances[R.first] = R.second.size();
+
+  // The data of a load is awaited when its first consumer starts, all
+  // operations before overlap with the memory access.
+  for (loadaccess_p L : Comp.getLoads()) {
+    const std::string LName = getOpName(L);
+
+    unsigned DataCycle = CriticalPath;
+    for (const std::string &Succ : Succs[LName])
+      DataCycle = std::min(DataCycle, ReadyMap[Succ]);
+
+    LoadDataMap[LName] = std::max(DataCycle, Finish[LName]);
+  }
+
+  // Outputs of a loop Block must not be sent before the loop condition is
+  // known.
+  if (Comp.isLoop()) {
+    const std::string CondName = getOpName(Comp.getLoopCondition());
+    LoopCondReady = getReadyCycle(CondName) + getLatency(I, CondName);
+
+    CriticalPath = std::max(LoopCondReady, CriticalPath);
+  }
+
+  for (const AddedConsTy::value_type &C : AddedCons) {
+    C.first->delOut(C.second);
+    C.second->delIn(C.first);
+  }
+
+  // Operands of pipelined Blocks are delayed until their consumer starts.
+  for (OperandTy &O : Operands) {
+    const std::string SrcName = getOpName(O.Src);
+
+    ReadyMapConstItTy SrcI = ReadyMap.find(SrcName);
+    if (SrcI == ReadyMap.end()) continue;
+
+    unsigned SrcReady = SrcI->second + getLatency(I, SrcName);
+
+    unsigned SinkStart = getReadyCycle(O.SinkName);
+
+    O.Delay = SinkStart > SrcReady ? SinkStart - SrcReady : 0;
+  }
 
   ODEBUG("Critical path of " << Comp.getUniqueName() << ": " << CriticalPath);
+  if (Pipelined)
+    ODEBUG("Initiation interval of " << Comp.getUniqueName() << ": " << InitiationInterval);
 }
 
 #undef DEBUG_TYPE
 #define DEBUG_TYPE "verilog"
 
+bool BlockModule::isSharedOperator(const std::string &OpName) const {
+  return getResourceLimit(OpName) != 0;
+}
+
+void BlockModule::addSharedOperator(const HW &R, const std::string &OpName, unsigned Latency, const SharedPortsTy &Ins, const std::string &Out) {
+  const std::string RName = getOpName(R);
+
+  SharedOpTy SO;
+  SO.Name = RName;
+  SO.OpName = OpName;
+  SO.Latency = Latency;
+  SO.BitWidth = R.getBitWidth();
+  SO.Ins = Ins;
+  SO.Out = Out;
+  SO.Instance = 0;
+
+  SharedOps[RName] = SO;
+
+  // The result register
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Reg);
+  BlockSignals << S.getDefStr() << ";\n";
+}
+
+/// \brief Latency of the operator computing \p HWName. Results of shared
+/// operators take an additional cycle for the result register.
+unsigned BlockModule::getLatency(const OperatorInstances &I, const std::string &HWName) const {
+  unsigned Latency = 0;
+
+  op_p Op = I.getOperatorForHW(HWName);
+  if (Op)
+    Latency = Op->Cycles;
+
+  if (SharedOps.find(HWName) != SharedOps.end())
+    Latency++;
+
+  return Latency;
+}
+
+/// \brief Condition true in the single cycle an operation scheduled at \p
+/// Cycle starts.
+const std::string BlockModule::getIssueCondition(unsigned Cycle) const {
+  if (Pipelined)
+    return "stage_valid[" + std::to_string(Cycle) + "] == 1";
+
+  return "counter_enabled == 1 && counter == " + std::to_string(Cycle);
+}
+
+/// \brief Instantiate shared operators.
+///
+/// The inputs of each instance are multiplexed by the operation starting in
+/// the current cycle. A valid bit per operation follows the instance's
+/// pipeline and stores the result when it arrives, which also works when the
+/// FSM stalls for memory accesses.
+const std::string BlockModule::declSharedOperators() const {
+  std::stringstream S;
+
+  if (SharedOps.empty())
+    return S.str();
+
+  typedef std::map<std::pair<std::string, unsigned>, std::vector<const SharedOpTy *> > InstancesTy;
+  InstancesTy Instances;
+
+  for (const SharedOpsTy::value_type &SO : SharedOps)
+    Instances[std::make_pair(SO.second.OpName, SO.second.Instance)].push_back(&SO.second);
+
+  S << "// Shared operators\n";
+
+  for (const InstancesTy::value_type &IT : Instances) {
+    const std::string &OpName = IT.first.first;
+    const std::string IName = OpName + "_" + std::to_string(IT.first.second);
+
+    const std::vector<const SharedOpTy *> &Shared = IT.second;
+    const SharedOpTy &First = *(Shared.front());
+
+    unsigned II = 0;
+
+    S << "// " << IName << ":";
+    for (const SharedOpTy *SO : Shared)
+      S << " " << SO->Name << "@" << getReadyCycle(SO->Name);
+    S << "\n";
+
+    for (const SharedPortTy &P : First.Ins) {
+      Signal PS(IName + "_" + P.Port, P.BitWidth, Signal::Local, Signal::Reg);
+      S << PS.getDefStr() << ";\n";
+    }
+
+    Signal RS(IName + "_" + First.Out, First.BitWidth, Signal::Local, Signal::Wire);
+    S << RS.getDefStr() << ";\n";
+
+    for (const SharedOpTy *SO : Shared) {
+      Signal Issue(SO->Name + "_issue", 1, Signal::Local, Signal::Wire);
+      S << Issue.getDefStr() << ";\n";
+      S << "assign " << SO->Name << "_issue = " << getIssueCondition(getReadyCycle(SO->Name)) << ";\n";
+
+      if (SO->Latency > 0) {
+        Signal Pending(SO->Name + "_pending", SO->Latency, Signal::Local, Signal::Reg);
+        S << Pending.getDefStr() << ";\n";
+      }
+    }
+
+    // Input multiplexer
+    S << "always @(*)\n";
+    BEGIN(S);
+    for (const SharedPortTy &P : First.Ins)
+      S << Indent(II) << IName << "_" << P.Port << " <= '0;\n";
+
+    for (const SharedOpTy *SO : Shared) {
+      S << Indent(II) << "if (" << SO->Name << "_issue == 1)\n";
+      BEGIN(S);
+      for (const SharedPortTy &P : SO->Ins)
+        S << Indent(II) << IName << "_" << P.Port << " <= " << P.Signal << ";\n";
+      END(S);
+    }
+    END(S);
+
+    // Instance
+    S << OpName << " " << IName << "(\n";
+    S << Indent(1) << ".clk(clk)," << "\n";
+    S << Indent(1) << ".rst(rst)," << "\n";
+    for (const SharedPortTy &P : First.Ins)
+      S << Indent(1) << "." << P.Port << "(" << IName << "_" << P.Port << ")," << "\n";
+    S << Indent(1) << "." << First.Out << "(" << IName << "_" << First.Out << ")" << "\n";
+    S << ");\n";
+
+    // Result registers
+    S << "always @(posedge clk)\n";
+    BEGIN(S);
+    S << Indent(II) << "if (rst)\n";
+    BEGIN(S);
+    for (const SharedOpTy *SO : Shared) {
+      S << Indent(II) << SO->Name << " <= '0;\n";
+      if (SO->Latency > 0)
+        S << Indent(II) << SO->Name << "_pending <= '0;\n";
+    }
+    END(S);
+    S << Indent(II) << "else\n";
+    BEGIN(S);
+    for (const SharedOpTy *SO : Shared) {
+      std::string Valid = SO->Name + "_issue";
+
+      if (SO->Latency == 1) {
+        S << Indent(II) << SO->Name << "_pending <= " << SO->Name << "_issue;\n";
+        Valid = SO->Name + "_pending[0]";
+      } else if (SO->Latency > 1) {
+        S << Indent(II) << SO->Name << "_pending <= {" << SO->Name << "_pending[" << SO->Latency-2 << ":0], " << SO->Name << "_issue};\n";
+        Valid = SO->Name + "_pending[" + std::to_string(SO->Latency-1) + "]";
+      }
+
+      S << Indent(II) << "if (" << Valid << " == 1) " << SO->Name << " <= " << IName << "_" << First.Out << ";\n";
+    }
+    END(S);
+    END(S);
+  }
+
+  return S.str();
+}
+
+void BlockModule::genScheduleReport() const {
+  const std::string BName = Comp.getName();
+  const std::string FileName = BName + ".sched";
+
+  FileTy SchedFile = openFile(FileName);
+
+  std::stringstream SS;
+
+  SS << "# Schedule of " << BName << "\n";
+  SS << "latency " << CriticalPath << "\n";
+  if (Pipelined)
+    SS << "ii " << InitiationInterval << "\n";
+  else
+    SS << "ii " << CriticalPath+1 << "\n";
+
+  std::map<std::string, unsigned> SharedCount;
+  for (const SharedOpsTy::value_type &SO : SharedOps)
+    SharedCount[SO.second.OpName]++;
+
+  for (const std::pair<std::string, unsigned> &SC : SharedCount) {
+    std::map<std::string, unsigned>::const_iterator NI = SharedInstances.find(SC.first);
+    unsigned Instances = NI != SharedInstances.end() ? NI->second : 0;
+
+    SS << "operator " << SC.first << " operations " << SC.second << " instances " << Instances << " limit " << getResourceLimit(SC.first) << "\n";
+  }
+
+  for (const ReadyMapElemTy &E : ReadyMap) {
+    SS << E.first << " " << E.second;
+
+    SharedOpsTy::const_iterator SI = SharedOps.find(E.first);
+    if (SI != SharedOps.end())
+      SS << " " << SI->second.OpName << "_" << SI->second.Instance;
+
+    SS << "\n";
+  }
+
+  (*SchedFile) << SS.str();
+
+  SchedFile->close();
+}
+
+BlockTimingTy BlockModule::getTiming(const OperatorInstances &I) const {
+  BlockTimingTy T;
+
+  T.Name = Comp.getName();
+  T.Latency = CriticalPath;
+  T.Pipelined = Pipelined;
+  T.InitiationInterval = Pipelined ? InitiationInterval : CriticalPath+1;
+  T.Loads = Comp.getLoads().size();
+  T.Stores = Comp.getStores().size();
+
+  for (const ReadyMapElemTy &E : ReadyMap) {
+    op_p Op = I.getOperatorForHW(E.first);
+    if (!Op)
+      continue;
+
+    BlockTimingTy::OpTimingTy O;
+    O.Name = E.first;
+    O.Operator = Op->Name;
+    O.Start = E.second;
+    O.Latency = getLatency(I, E.first);
+
+    T.Ops.push_back(O);
+  }
+
+  return T;
+}
+
 int BlockModule::getReadyCycle(const std::string OpName) const {
   ReadyMapConstItTy E = ReadyMap.find(OpName);
 
@@ -1,6 +1,11 @@
 #ifndef BLOCKMODULE_H
 #define BLOCKMODULE_H
 
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
 #include "HW/HW.h"
 #include "HW/typedefs.h"
 #include "VerilogModule.h"
@@ -9,10 +14,41 @@ namespace oclacc {
 
 class Block;
 class OperatorInstances;
+struct BurstTy;
+struct LoadUnitTy;
+struct CoalescerTy;
+
+/// \brief Static timing of a Block after scheduling
+struct BlockTimingTy {
+  /// \brief Scheduled operation with the operator computing it
+  struct OpTimingTy {
+    std::string Name;
+    std::string Operator;
+    unsigned Start;
+    unsigned Latency;
+  };
+
+  std::string Name;
+  unsigned Latency;
+  unsigned InitiationInterval;
+  bool Pipelined;
+  unsigned Loads;
+  unsigned Stores;
+  std::vector<OpTimingTy> Ops;
+};
 
 /// \brief Implementation of Block
 class BlockModule : public VerilogModule {
   public:
+    /// \brief Input of a shared operator instance, e.g. port X fed by signal
+    /// add_12.
+    struct SharedPortTy {
+      std::string Port;
+      std::string Signal;
+      unsigned BitWidth;
+    };
+    typedef std::vector<SharedPortTy> SharedPortsTy;
+
     BlockModule(Block &);
 
     virtual const std::string declHeader() const;
@@ -29,6 +65,10 @@ class BlockModule : public VerilogModule {
 
     const std::string declStores() const;
     const std::string declLoads() const;
+    const std::string declStoreBurst(const BurstTy &) const;
+    const std::string declLoadBurst(const BurstTy &) const;
+    const std::string declLoadUnit(const LoadUnitTy &) const;
+    const std::string declCoalescer(const CoalescerTy &) const;
 
     inline const std::string declBlockSignals() const { return BlockSignals.str(); }
     inline const std::string declConstSignals() const { return ConstSignals.str(); }
@@ -42,10 +82,66 @@ class BlockModule : public VerilogModule {
     inline std::stringstream &getLocalOperators() { return LocalOperators;}
     inline std::stringstream &getBlockComponents() { return BlockComponents;}
 
+    /// \brief Decide which inferred integer operators are chained.
+    ///
+    /// Operators are chained while the delay of the chain fits into the
+    /// clock period. Must be called before the operators are generated.
+    void chainOperators();
+
+    /// \brief Chained operators are combinational and complete in the cycle
+    /// their operands are ready, all others are registered.
+    inline bool isChained(const HW &R) const {
+      return Chained.count(R.getUniqueName());
+    }
+
     /// \brief Assign each component a clock cycle when all inputs are ready.
     ///
+    /// Operations of operators limited by -resource-limit are list scheduled
+    /// and bound to one of the available instances.
     void schedule(const OperatorInstances &);
 
+    /// \brief Instance limits per module name used for operators without a
+    /// -resource-limit, e.g. to fit the design into the device.
+    static void setAreaLimits(const std::map<std::string, unsigned> &Limits);
+
+    /// \brief Operators with a resource limit are time-multiplexed and must be
+    /// added by addSharedOperator() instead of being instantiated directly.
+    bool isSharedOperator(const std::string &OpName) const;
+
+    /// \brief Compute \p R on a shared instance of \p OpName.
+    ///
+    /// The result is registered in a signal named after \p R when the
+    /// instance's output \p Out is valid, so it is ready one cycle after the
+    /// operator's latency.
+    void addSharedOperator(const HW &R, const std::string &OpName, unsigned Latency, const SharedPortsTy &Ins, const std::string &Out);
+
+    /// \brief Shared operator instances with their input multiplexers.
+    const std::string declSharedOperators() const;
+
+    /// \brief Write latency, initiation interval and operator binding to
+    /// <Block>.sched.
+    void genScheduleReport() const;
+
+    /// \brief Timing of the scheduled Block for the Kernel's report.
+    BlockTimingTy getTiming(const OperatorInstances &) const;
+
+    /// \brief Pipelined Blocks accept a new work-item every
+    /// InitiationInterval cycles instead of waiting for the critical path.
+    inline bool isPipelined() const {
+      return Pipelined;
+    }
+
+    /// \brief Return the signal name \p Sink uses to read its operand \p Src.
+    ///
+    /// In pipelined Blocks, operands ready earlier than their consumer starts
+    /// must be delayed, as the next work-item already overwrites them. The
+    /// returned wire is connected to the correct delay register after
+    /// scheduling. Non-pipelined Blocks simply use the name of \p Src.
+    const std::string getOperandName(const HW &Sink, const base_p Src);
+
+    /// \brief Delay registers balancing operands of pipelined Blocks.
+    const std::string declOperandDelays() const;
+
     int getReadyCycle(const std::string) const;
     inline int getReadyCycle(base_p P) const {
       return getReadyCycle(P->getUniqueName());
@@ -57,6 +153,50 @@ class BlockModule : public VerilogModule {
     Block &Comp;
     unsigned CriticalPath;
 
+    bool Pipelined;
+    unsigned InitiationInterval;
+
+    /// \brief Cycle in which the loop condition of a loop Block is valid.
+    unsigned LoopCondReady;
+
+    // Operations computed by shared operator instances
+    struct SharedOpTy {
+      std::string Name;
+      std::string OpName;
+      unsigned Latency;
+      unsigned BitWidth;
+      SharedPortsTy Ins;
+      std::string Out;
+      unsigned Instance;
+    };
+    typedef std::map<std::string, SharedOpTy> SharedOpsTy;
+    SharedOpsTy SharedOps;
+
+    // Number of instances used per shared operator
+    std::map<std::string, unsigned> SharedInstances;
+
+    // Combinational operators, see chainOperators()
+    std::set<std::string> Chained;
+
+    unsigned getLatency(const OperatorInstances &, const std::string &) const;
+
+    const std::string getIssueCondition(unsigned Cycle) const;
+
+    // Operands of pipelined Blocks read through delay registers
+    struct OperandTy {
+      std::string Name;
+      base_p Src;
+      std::string SinkName;
+      unsigned Delay;
+    };
+    typedef std::vector<OperandTy> OperandsTy;
+    OperandsTy Operands;
+
+    const std::string declPipelineSignals() const;
+    const std::string declPipeline() const;
+
+    unsigned getOutputFifoDepth() const;
+
     // Components as instantiated by each component
     std::stringstream BlockSignals;
     std::stringstream ConstSignals;
@@ -69,6 +209,9 @@ class BlockModule : public VerilogModule {
     typedef std::pair<std::string, unsigned> ReadyMapElemTy;
     typedef ReadyMapTy::const_iterator ReadyMapConstItTy;
     ReadyMapTy ReadyMap;
+
+    // Cycle in which the data of each load is needed
+    ReadyMapTy LoadDataMap;
 };
 
 } // end ns oclacc
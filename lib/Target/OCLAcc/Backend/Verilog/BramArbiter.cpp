@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <sstream>
+
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "BramArbiter.h"
+#include "Naming.h"
+#include "RAM.h"
+#include "Utils.h"
+#include "VerilogMacros.h"
+
+#include "HW/Port.h"
+
+using namespace oclacc;
+
+namespace {
+
+/// \brief Width of a selector for \p N accesses and the value "none".
+unsigned getSelWidth(unsigned N) {
+  unsigned W = 1;
+  while ((1u << W) <= N)
+    W++;
+
+  return W;
+}
+
+/// \brief Select the next access round-robin.
+///
+/// The lowest requesting index is taken first and overridden by the lowest
+/// requesting index above the last grant.
+void declGrant(std::stringstream &S, unsigned II, const std::string &Name, const std::vector<std::string> &Reqs) {
+  const unsigned N = Reqs.size();
+
+  S << Indent(II) << Name << "_grant = " << N << ";\n";
+
+  for (unsigned i = N; i-- > 0; )
+    S << Indent(II) << "if (" << Reqs[i] << " == 1) " << Name << "_grant = " << i << ";\n";
+
+  for (unsigned i = N; i-- > 1; )
+    S << Indent(II) << "if (" << Reqs[i] << " == 1 && " << Name << "_last < " << i << ") " << Name << "_grant = " << i << ";\n";
+}
+
+/// \brief Word address of the BRAM from the byte index \p Address.
+///
+/// Stream indices are byte offsets, the BRAM holds one element per word.
+const std::string getWordAddress(const std::string &Address, unsigned ElementBits) {
+  const unsigned EB = llvm::Log2_32(ElementBits / 8);
+
+  if (EB == 0)
+    return Address;
+
+  return "(" + Address + " >> " + std::to_string(EB) + ")";
+}
+
+} // end anonymous ns
+
+const std::string ip::declBramArbiter(streamport_p P) {
+  std::stringstream S;
+
+  const StreamPort::LoadListTy Loads = P->getLoads();
+  const StreamPort::StoreListTy Stores = P->getStores();
+
+  if (Loads.empty() && Stores.empty())
+    return "";
+
+  const std::string Name = P->getName() + "_bram";
+  const unsigned W = P->getBitWidth();
+
+  if (W < 8 || !llvm::isPowerOf2_32(W))
+    llvm::report_fatal_error("Local memory " + P->getName() + " with " + std::to_string(W) + " bit elements is not byte-addressable.");
+
+  BRamImpl Ram(Name, W, std::max(1u, P->getLength()));
+  const unsigned AW = Ram.getAddrWidth();
+
+  S << "// Local memory " << P->getName() << ": " << P->getLength() << "x" << W << " bits\n";
+
+  // Block ports of the accesses. Outputs of the Blocks are wires, inputs are
+  // driven by the arbiter.
+  for (loadaccess_p L : Loads) {
+    for (const Signal &Sig : getSignals(L)) {
+      Signal Def(Sig.Name, Sig.BitWidth, Signal::Local, Sig.Direction == Signal::Out ? Signal::Wire : Signal::Reg);
+      S << Def.getDefStr() << ";\n";
+    }
+  }
+  for (storeaccess_p St : Stores) {
+    for (const Signal &Sig : getSignals(St)) {
+      Signal Def(Sig.Name, Sig.BitWidth, Signal::Local, Sig.Direction == Signal::Out ? Signal::Wire : Signal::Reg);
+      S << Def.getDefStr() << ";\n";
+    }
+  }
+
+  S << Signal(Name+"_a_wr", 1, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+  S << Signal(Name+"_a_addr", AW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+  S << Signal(Name+"_a_din", W, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+  S << Signal(Name+"_a_dout", W, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+  S << Signal(Name+"_b_wr", 1, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+  S << Signal(Name+"_b_addr", AW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+  S << Signal(Name+"_b_din", W, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+  S << Signal(Name+"_b_dout", W, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+
+  S << "assign " << Name << "_a_wr = 0;\n";
+  S << "assign " << Name << "_a_din = '0;\n";
+
+  S << Ram.instantiate();
+
+  unsigned II = 0;
+
+  // Port A: 0 idle, 1 address sent, 2 data valid until acknowledged
+  if (!Loads.empty()) {
+    const unsigned SW = getSelWidth(Loads.size());
+
+    std::vector<std::string> Reqs;
+    for (loadaccess_p L : Loads)
+      Reqs.push_back(getOpName(L) + "_address_valid");
+
+    S << Signal(Name+"_a_state", 2, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+    S << Signal(Name+"_a_grant", SW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+    S << Signal(Name+"_a_last", SW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+
+    for (loadaccess_p L : Loads)
+      S << "assign " << getOpName(L) << "_unbuf = " << Name << "_a_dout;\n";
+
+    S << "// Load arbiter " << Name << "\n";
+    S << "always @(posedge clk)\n";
+      BEGIN(S);
+      S << Indent(II) << "if (rst==1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_a_state <= 0;\n";
+        S << Indent(II) << Name << "_a_addr <= '0;\n";
+        S << Indent(II) << Name << "_a_last <= '0;\n";
+        for (loadaccess_p L : Loads)
+          S << Indent(II) << getOpName(L) << "_unbuf_valid <= 0;\n";
+        END(S);
+      S << Indent(II) << "else\n";
+        BEGIN(S);
+        S << Indent(II) << "case (" << Name << "_a_state)\n";
+        S << Indent(II) << "0:\n";
+          BEGIN(S);
+          declGrant(S, II, Name+"_a", Reqs);
+          for (unsigned i = 0, e = Loads.size(); i < e; ++i)
+            S << Indent(II) << "if (" << Name << "_a_grant == " << i << ") " << Name << "_a_addr <= " << getWordAddress(getOpName(Loads[i]) + "_address", W) << ";\n";
+          S << Indent(II) << "if (" << Name << "_a_grant != " << Loads.size() << ")\n";
+            BEGIN(S);
+            S << Indent(II) << Name << "_a_last <= " << Name << "_a_grant;\n";
+            S << Indent(II) << Name << "_a_state <= 1;\n";
+            END(S);
+          END(S);
+        S << Indent(II) << "1:\n";
+          BEGIN(S);
+          for (unsigned i = 0, e = Loads.size(); i < e; ++i)
+            S << Indent(II) << "if (" << Name << "_a_last == " << i << ") " << getOpName(Loads[i]) << "_unbuf_valid <= 1;\n";
+          S << Indent(II) << Name << "_a_state <= 2;\n";
+          END(S);
+        S << Indent(II) << "2:\n";
+          BEGIN(S);
+          for (unsigned i = 0, e = Loads.size(); i < e; ++i) {
+            const std::string LName = getOpName(Loads[i]);
+            S << Indent(II) << "if (" << Name << "_a_last == " << i << " && " << LName << "_ack == 1)\n";
+              BEGIN(S);
+              S << Indent(II) << LName << "_unbuf_valid <= 0;\n";
+              S << Indent(II) << Name << "_a_state <= 0;\n";
+              END(S);
+          }
+          END(S);
+        S << Indent(II) << "default:\n";
+        S << Indent(II+1) << Name << "_a_state <= 0;\n";
+        S << Indent(II) << "endcase\n";
+        END(S);
+      END(S);
+  } else
+    S << "always @(posedge clk) " << Name << "_a_addr <= '0;\n";
+
+  // Port B: the write is acknowledged in the cycle it is performed.
+  if (!Stores.empty()) {
+    const unsigned SW = getSelWidth(Stores.size());
+
+    std::vector<std::string> Reqs;
+    for (storeaccess_p St : Stores)
+      Reqs.push_back(getOpName(St) + "_valid");
+
+    S << Signal(Name+"_b_grant", SW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+    S << Signal(Name+"_b_last", SW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+
+    S << "// Store arbiter " << Name << "\n";
+    S << "always @(posedge clk)\n";
+      BEGIN(S);
+      S << Indent(II) << "if (rst==1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_b_wr <= 0;\n";
+        S << Indent(II) << Name << "_b_addr <= '0;\n";
+        S << Indent(II) << Name << "_b_din <= '0;\n";
+        S << Indent(II) << Name << "_b_last <= '0;\n";
+        for (storeaccess_p St : Stores)
+          S << Indent(II) << getOpName(St) << "_ack <= 0;\n";
+        END(S);
+      S << Indent(II) << "else if (" << Name << "_b_wr == 1)\n";
+        BEGIN(S);
+        S << Indent(II) << Name << "_b_wr <= 0;\n";
+        for (storeaccess_p St : Stores)
+          S << Indent(II) << getOpName(St) << "_ack <= 0;\n";
+        END(S);
+      S << Indent(II) << "else\n";
+        BEGIN(S);
+        declGrant(S, II, Name+"_b", Reqs);
+        for (unsigned i = 0, e = Stores.size(); i < e; ++i) {
+          const std::string SName = getOpName(Stores[i]);
+          S << Indent(II) << "if (" << Name << "_b_grant == " << i << ")\n";
+            BEGIN(S);
+            S << Indent(II) << Name << "_b_addr <= " << getWordAddress(SName + "_address", W) << ";\n";
+            S << Indent(II) << Name << "_b_din <= " << SName << "_buf;\n";
+            S << Indent(II) << Name << "_b_wr <= 1;\n";
+            S << Indent(II) << Name << "_b_last <= " << i << ";\n";
+            S << Indent(II) << SName << "_ack <= 1;\n";
+            END(S);
+        }
+        END(S);
+      END(S);
+  } else {
+    S << "always @(posedge clk)\n";
+      BEGIN(S);
+      S << Indent(II) << Name << "_b_wr <= 0;\n";
+      S << Indent(II) << Name << "_b_addr <= '0;\n";
+      S << Indent(II) << Name << "_b_din <= '0;\n";
+      END(S);
+  }
+
+  return S.str();
+}
+
+const std::string ip::defineBram() {
+  const std::string Filename = "bram.v";
+
+  static bool Written = false;
+  if (Written)
+    return Filename;
+
+  FileTy FS = openFile(Filename);
+  (*FS) << BRamImpl::define();
+  FS->close();
+
+  Written = true;
+
+  return Filename;
+}
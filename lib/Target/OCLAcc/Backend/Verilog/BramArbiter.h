@@ -0,0 +1,26 @@
+#ifndef BRAMARBITER_H
+#define BRAMARBITER_H
+
+#include <string>
+
+#include "HW/typedefs.h"
+
+namespace oclacc {
+namespace ip {
+
+/// \brief Implement the local StreamPort \p P as dual-ported BRAM.
+///
+/// Loads of all Blocks share port A, stores share port B. Each port is
+/// granted round-robin to a single access until its handshake completes, so
+/// the Blocks see the same protocol as for global memory.
+const std::string declBramArbiter(streamport_p P);
+
+/// \brief Write the BRAM definition to bram.v once.
+///
+/// \return the filename
+const std::string defineBram();
+
+} // end ns ip
+} // end ns oclacc
+
+#endif /* BRAMARBITER_H */
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "llvm/Support/CommandLine.h"
+
+#include "Burst.h"
+#include "Naming.h"
+#include "Macros.h"
+
+#include "HW/Arith.h"
+#include "HW/Constant.h"
+#include "HW/Kernel.h"
+#include "HW/Port.h"
+#include "Passes/HardwareModel.h"
+
+#define DEBUG_TYPE "burst"
+
+using namespace oclacc;
+using namespace llvm;
+
+static cl::opt<bool> NoBursts("no-bursts", cl::init(false), cl::desc("Transfer each memory access separately instead of grouping consecutive accesses into bursts.") );
+
+static cl::opt<unsigned> MaxBurstBeats("max-burst-beats", cl::init(16), cl::desc("Maximum number of bus beats of a memory burst.") );
+
+namespace {
+
+/// \brief Index of an access as Base + Offset. Static indices have no Base.
+struct OffsetTy {
+  base_p Base;
+  int64_t Offset;
+  streamaccess_p Access;
+};
+
+OffsetTy getOffset(streamaccess_p A) {
+  OffsetTy O;
+  O.Base = nullptr;
+  O.Offset = 0;
+  O.Access = A;
+
+  const streamindex_p Index = A->getIndex();
+
+  if (staticstreamindex_p SI = std::dynamic_pointer_cast<StaticStreamIndex>(Index)) {
+    O.Offset = static_cast<int64_t>(SI->getIndex()->getValue());
+    return O;
+  }
+
+  dynamicstreamindex_p DI = std::static_pointer_cast<DynamicStreamIndex>(Index);
+  O.Base = DI->getIndex();
+
+  // Affine index X+C
+  if (add_p A = std::dynamic_pointer_cast<Add>(O.Base)) {
+    if (A->getIns().size() != 2)
+      return O;
+
+    for (unsigned i = 0; i < 2; ++i) {
+      const_p C = std::dynamic_pointer_cast<ConstVal>(A->getIn(i));
+      if (C && C->isStatic()) {
+        O.Base = A->getIn(1-i);
+        O.Offset = static_cast<int64_t>(C->getValue());
+        break;
+      }
+    }
+  }
+
+  return O;
+}
+
+/// \brief Largest power of two known to divide the value of \p V.
+///
+/// Stream indices are byte offsets scaled by the element size, so the
+/// alignment follows shifts and multiplications by constants.
+uint64_t getKnownAlignment(base_p V, unsigned Depth = 0) {
+  const uint64_t MaxAlignment = UINT64_C(1) << 32;
+
+  if (const_p C = std::dynamic_pointer_cast<ConstVal>(V)) {
+    if (!C->isStatic())
+      return 1;
+    const uint64_t Value = C->getValue();
+    return Value ? std::min(Value & (~Value + 1), MaxAlignment) : MaxAlignment;
+  }
+
+  if (Depth > 8 || V->getIns().size() != 2)
+    return 1;
+
+  const uint64_t A0 = getKnownAlignment(V->getIn(0), Depth+1);
+  const uint64_t A1 = getKnownAlignment(V->getIn(1), Depth+1);
+
+  if (std::dynamic_pointer_cast<Add>(V) || std::dynamic_pointer_cast<Sub>(V))
+    return std::min(A0, A1);
+
+  if (std::dynamic_pointer_cast<Mul>(V))
+    return A0 >= MaxAlignment / A1 ? MaxAlignment : A0 * A1;
+
+  if (shl_p S = std::dynamic_pointer_cast<Shl>(V)) {
+    const_p C = std::dynamic_pointer_cast<ConstVal>(S->getIn(1));
+    if (C && C->isStatic() && C->getValue() < 32)
+      return std::min(A0 << C->getValue(), MaxAlignment);
+  }
+
+  return 1;
+}
+
+/// \brief No access of \p B between the members of \p Run in program order
+/// depends on any member.
+///
+/// The members share a single request, so an access in between which may
+/// touch the same addresses would have to be scheduled both before and after
+/// the burst.
+bool isUninterrupted(const Block &B, const std::vector<streamaccess_p> &Run) {
+  const StreamPort::AccessListTy &Order = B.getStreamAccesses();
+
+  unsigned First = Order.size();
+  unsigned Last = 0;
+  for (unsigned i = 0, e = Order.size(); i < e; ++i) {
+    if (std::find(Run.begin(), Run.end(), Order[i]) == Run.end())
+      continue;
+
+    First = std::min(First, i);
+    Last = i;
+  }
+
+  for (unsigned i = First + 1; i < Last; ++i) {
+    streamaccess_p X = Order[i];
+
+    if (X->getStream() != Run.front()->getStream())
+      continue;
+
+    if (std::find(Run.begin(), Run.end(), X) != Run.end())
+      continue;
+
+    for (streamaccess_p M : Run) {
+      if (X->isLoad() && M->isLoad())
+        continue;
+
+      if (!B.areIndependentAccesses(*X, *M))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+template<class AccessListTy>
+const BurstListTy getBursts(const Block &Blk, const AccessListTy &Accesses) {
+  BurstListTy Bursts;
+
+  if (NoBursts)
+    return Bursts;
+
+  const unsigned BusBits = Loopus::HardwareModel::getHardwareModel().getGMemBusWidthInBits();
+  if (BusBits % 8)
+    return Bursts;
+  const unsigned BusBytes = BusBits / 8;
+
+  // Group by Stream and Base, keep the order of the first access.
+  typedef std::pair<streamport_p, base_p> KeyTy;
+  std::vector<KeyTy> Keys;
+  std::map<KeyTy, std::vector<OffsetTy> > Groups;
+
+  for (streamaccess_p A : Accesses) {
+    // Local memory is accessed through BRAMs
+    if (A->getStream()->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
+    OffsetTy O = getOffset(A);
+    KeyTy K = std::make_pair(A->getStream(), O.Base);
+
+    if (Groups.find(K) == Groups.end())
+      Keys.push_back(K);
+
+    Groups[K].push_back(O);
+  }
+
+  for (const KeyTy &K : Keys) {
+    std::vector<OffsetTy> &G = Groups[K];
+
+    // The lanes of a burst are counted from the start of a bus word, so the
+    // first element must be aligned to the bus. Without a Base the offset
+    // is the full address.
+    if (K.second && getKnownAlignment(K.second) % BusBytes)
+      continue;
+
+    std::stable_sort(G.begin(), G.end(), [](const OffsetTy &A, const OffsetTy &B) {
+        return A.Offset < B.Offset;
+        });
+
+    const unsigned ElementBits = G.front().Access->getBitWidth();
+
+    // Wide vector accesses already use the full bus, elements must be
+    // byte-addressable and fill the bus word without a gap.
+    if (ElementBits > BusBits || ElementBits % 8 || BusBits % ElementBits)
+      continue;
+    const unsigned ElementBytes = ElementBits / 8;
+    const unsigned ElementsPerBeat = BusBits / ElementBits;
+    const unsigned MaxElements = ElementsPerBeat * std::max(1u, (unsigned) MaxBurstBeats);
+
+    // Split into runs of consecutive byte offsets starting at a bus word
+    std::vector<OffsetTy>::const_iterator RI = G.begin();
+    while (RI != G.end()) {
+      if (RI->Offset % BusBytes || RI->Access->getBitWidth() != ElementBits) {
+        ++RI;
+        continue;
+      }
+
+      std::vector<streamaccess_p> Run(1, RI->Access);
+
+      std::vector<OffsetTy>::const_iterator RE = std::next(RI);
+      while (RE != G.end()
+          && RE->Access->getBitWidth() == ElementBits
+          && RE->Offset == std::prev(RE)->Offset + ElementBytes
+          && (unsigned) (RE - RI) < MaxElements) {
+        Run.push_back(RE->Access);
+        if (!isUninterrupted(Blk, Run))
+          break;
+
+        ++RE;
+      }
+
+      std::vector<OffsetTy>::const_iterator Next = RE;
+
+      // Stores have no byte enables, so a partial beat would overwrite the
+      // neighbouring elements. Leave the remainder to single stores.
+      if (RI->Access->isStore())
+        RE -= (RE - RI) % ElementsPerBeat;
+
+      if (RE - RI > 1) {
+        BurstTy B;
+        B.Stream = K.first;
+        B.ElementBits = ElementBits;
+        B.ElementsPerBeat = ElementsPerBeat;
+        B.Beats = (RE - RI + ElementsPerBeat - 1) / ElementsPerBeat;
+
+        for (std::vector<OffsetTy>::const_iterator I = RI; I != RE; ++I)
+          B.Accesses.push_back(I->Access);
+
+        B.Name = getOpName(*(RI->Access)) + "_burst";
+
+        const streamindex_p Index = RI->Access->getIndex();
+        if (staticstreamindex_p SI = std::dynamic_pointer_cast<StaticStreamIndex>(Index))
+          B.Address = SI->getIndex()->getUniqueName();
+        else
+          B.Address = getOpName(std::static_pointer_cast<DynamicStreamIndex>(Index)->getIndex());
+
+        ODEBUG(B.Name << ": " << B.Accesses.size() << " elements in " << B.Beats << " beats");
+
+        Bursts.push_back(B);
+      }
+
+      RI = Next;
+    }
+  }
+
+  return Bursts;
+}
+
+} // end anonymous ns
+
+const BurstListTy oclacc::getLoadBursts(const Block &B) {
+  return getBursts(B, B.getLoads());
+}
+
+const BurstListTy oclacc::getStoreBursts(const Block &B) {
+  return getBursts(B, B.getStores());
+}
+
+const BurstTy *oclacc::findBurst(const BurstListTy &Bursts, const StreamAccess &A) {
+  for (const BurstTy &B : Bursts) {
+    for (streamaccess_p BA : B.Accesses) {
+      if (BA.get() == &A)
+        return &B;
+    }
+  }
+
+  return nullptr;
+}
+
+#ifdef DEBUG_TYPE
+#undef DEBUG_TYPE
+#endif
@@ -0,0 +1,65 @@
+#ifndef BURST_H
+#define BURST_H
+
+#include <string>
+#include <vector>
+
+#include "HW/typedefs.h"
+
+namespace oclacc {
+
+class Block;
+class StreamAccess;
+
+/// \brief Accesses of a Block to consecutive elements of a StreamPort
+///
+/// All accesses of a burst share a single address handshake. Data is
+/// transferred in beats of the global memory bus width, each carrying
+/// ElementsPerBeat elements.
+struct BurstTy {
+  std::string Name;
+  streamport_p Stream;
+
+  /// Ordered by their offset, the first access determines the address.
+  std::vector<streamaccess_p> Accesses;
+
+  /// Signal or constant holding the bus-aligned byte index of the first
+  /// element
+  std::string Address;
+
+  unsigned ElementBits;
+  unsigned ElementsPerBeat;
+  unsigned Beats;
+
+  inline unsigned getBusBits() const {
+    return ElementBits * ElementsPerBeat;
+  }
+
+  /// \brief Position of access \p I in the burst.
+  inline unsigned getBeat(unsigned I) const {
+    return I / ElementsPerBeat;
+  }
+
+  inline unsigned getLane(unsigned I) const {
+    return I % ElementsPerBeat;
+  }
+};
+
+typedef std::vector<BurstTy> BurstListTy;
+
+/// \brief Group loads of \p B to consecutive elements into bursts.
+///
+/// Indices are byte offsets. Consecutive elements are static indices and
+/// dynamic indices X+C with the same X whose constants differ by the element
+/// size. A burst starts at an offset aligned to the bus width, store bursts
+/// cover whole beats. No access between the members in program order may
+/// depend on them. Only groups of at least two accesses are returned.
+const BurstListTy getLoadBursts(const Block &B);
+const BurstListTy getStoreBursts(const Block &B);
+
+/// \brief Return the burst containing \p A or nullptr.
+const BurstTy *findBurst(const BurstListTy &Bursts, const StreamAccess &A);
+
+} // end ns oclacc
+
+#endif /* BURST_H */
@@ -0,0 +1,115 @@
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+
+#include "Coalescer.h"
+#include "Burst.h"
+#include "Naming.h"
+#include "Macros.h"
+
+#include "HW/Kernel.h"
+#include "HW/Port.h"
+#include "Passes/HardwareModel.h"
+
+#define DEBUG_TYPE "coalescer"
+
+using namespace oclacc;
+using namespace llvm;
+
+namespace {
+
+/// \brief The memory of \p S is not written while the kernel runs.
+///
+/// Streams of arguments without restrict may refer to the same buffer, so
+/// all other global streams of the kernel must be free of stores, too.
+bool isReadOnly(const Block &B, streamport_p S) {
+  if (S->hasStores())
+    return false;
+
+  if (S->isNoAlias())
+    return true;
+
+  for (streamport_p O : B.getParent()->getStreams()) {
+    if (O->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
+    if (O->hasStores() && !O->isNoAlias())
+      return false;
+  }
+
+  return true;
+}
+
+} // end anonymous ns
+
+static cl::opt<bool> NoCoalescing("no-coalescing", cl::init(false), cl::desc("Load each element of consecutive work-items separately instead of keeping the whole memory line.") );
+
+const CoalescerListTy oclacc::getCoalescers(const Block &B) {
+  CoalescerListTy Coalescers;
+
+  if (NoCoalescing)
+    return Coalescers;
+
+  const unsigned BusBits = Loopus::HardwareModel::getHardwareModel().getGMemBusWidthInBits();
+  if (!isPowerOf2_32(BusBits))
+    return Coalescers;
+
+  const BurstListTy Bursts = getLoadBursts(B);
+
+  for (loadaccess_p L : B.getLoads()) {
+    if (!L->isConsecutive())
+      continue;
+
+    streamport_p S = L->getStream();
+
+    // Local memory is accessed through BRAMs
+    if (S->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
+    if (!isReadOnly(B, S))
+      continue;
+
+    if (findBurst(Bursts, *L))
+      continue;
+
+    // Elements must be byte-addressable and at least two must fit into a
+    // line
+    const unsigned ElementBits = L->getBitWidth();
+    if (ElementBits < 8 || !isPowerOf2_32(ElementBits) || 2 * ElementBits > BusBits)
+      continue;
+
+    CoalescerTy C;
+    C.Name = getOpName(L) + "_co";
+    C.Stream = S;
+    C.Load = L;
+    C.ElementBits = ElementBits;
+    C.ElementsPerLine = BusBits / ElementBits;
+
+    ODEBUG(C.Name << ": " << C.ElementsPerLine << " elements of " << ElementBits << " bits per line");
+
+    Coalescers.push_back(C);
+  }
+
+  return Coalescers;
+}
+
+bool oclacc::hasCoalescers(const Kernel &K) {
+  for (block_p B : K.getBlocks()) {
+    if (!getCoalescers(*B).empty())
+      return true;
+  }
+
+  return false;
+}
+
+const CoalescerTy *oclacc::findCoalescer(const CoalescerListTy &Coalescers, const StreamAccess &A) {
+  for (const CoalescerTy &C : Coalescers) {
+    if (C.Load.get() == &A)
+      return &C;
+  }
+
+  return nullptr;
+}
+
+#ifdef DEBUG_TYPE
+#undef DEBUG_TYPE
+#endif
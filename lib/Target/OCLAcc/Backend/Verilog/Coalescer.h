@@ -0,0 +1,68 @@
+#ifndef COALESCER_H
+#define COALESCER_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/MathExtras.h"
+
+#include "HW/typedefs.h"
+
+namespace oclacc {
+
+class Block;
+class Kernel;
+class StreamAccess;
+
+/// \brief Line buffer of a load of consecutive elements by consecutive
+/// work-items
+///
+/// The coalescer fetches the whole line of the global memory bus containing
+/// the element and keeps it, so the following work-items loading from the
+/// same line are served without a memory request. Only streams whose memory
+/// is not written by the kernel are coalesced, so the line cannot become
+/// stale while the kernel runs. The line is dropped on start, when the host
+/// launches the next NDRange.
+struct CoalescerTy {
+  std::string Name;
+  streamport_p Stream;
+  loadaccess_p Load;
+
+  unsigned ElementBits;
+  unsigned ElementsPerLine;
+
+  inline unsigned getLineBits() const {
+    return ElementBits * ElementsPerLine;
+  }
+
+  /// \brief Low bits of the byte address selecting the byte in a line.
+  inline unsigned getLineOffsetBits() const {
+    return llvm::Log2_32(getLineBits() / 8);
+  }
+
+  /// \brief Low bits of the byte address selecting the byte in an element.
+  inline unsigned getElementOffsetBits() const {
+    return llvm::Log2_32(ElementBits / 8);
+  }
+
+  inline unsigned getSelWidth() const {
+    return std::max(1u, getLineOffsetBits() - getElementOffsetBits());
+  }
+};
+
+typedef std::vector<CoalescerTy> CoalescerListTy;
+
+/// \brief Coalescers of \p B for its consecutive loads of global StreamPorts
+/// without stores which are not part of a burst.
+const CoalescerListTy getCoalescers(const Block &B);
+
+/// \brief Any Block of \p K has a coalescer and needs the start signal.
+bool hasCoalescers(const Kernel &K);
+
+/// \brief Return the coalescer of \p A or nullptr.
+const CoalescerTy *findCoalescer(const CoalescerListTy &Coalescers, const StreamAccess &A);
+
+} // end ns oclacc
+
+#endif /* COALESCER_H */
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "Divider.h"
+#include "Utils.h"
+#include "VerilogMacros.h"
+
+using namespace oclacc;
+using namespace llvm;
+
+static cl::opt<unsigned> DividerRadix("divider-radix", cl::init(4), cl::desc("Radix of the pipelined integer dividers, 2 computes one quotient bit per stage, 4 two.") );
+
+namespace {
+
+/// \brief Quotient bits computed per stage.
+unsigned getBitsPerStage() {
+  unsigned K = 0;
+  while ((2u << K) <= DividerRadix)
+    K++;
+
+  if (K == 0 || (1u << K) != DividerRadix)
+    report_fatal_error("-divider-radix must be a power of 2");
+
+  return K;
+}
+
+} // end anonymous ns
+
+ip::DividerImpl::DividerImpl(unsigned BitWidth, bool Signed) : BitWidth(std::max(2u, BitWidth)), Signed(Signed) {
+}
+
+const std::string ip::DividerImpl::getName() const {
+  return "IntDiv_" + std::to_string(BitWidth) + (Signed ? "_s" : "_u") + "_r" + std::to_string(DividerRadix);
+}
+
+unsigned ip::DividerImpl::getLatency() const {
+  const unsigned K = getBitsPerStage();
+  return (BitWidth + K - 1) / K;
+}
+
+const std::string ip::DividerImpl::define() const {
+  const std::string Name = getName();
+  const std::string Filename = Name + ".v";
+
+  static std::set<std::string> Written;
+  if (Written.count(Name))
+    return Filename;
+
+  const unsigned N = BitWidth;
+  const unsigned K = getBitsPerStage();
+  const unsigned S = getLatency();
+
+  std::stringstream D;
+  unsigned II = 0;
+
+  D << "// Pipelined radix-" << DividerRadix << " restoring divider, latency " << S << "\n";
+  D << "module " << Name << "(\n";
+  D << Indent(1) << "input clk,\n";
+  D << Indent(1) << "input rst,\n";
+  D << Indent(1) << "input [" << N-1 << ":0] X,\n";
+  D << Indent(1) << "input [" << N-1 << ":0] Y,\n";
+  D << Indent(1) << "output [" << N-1 << ":0] Q,\n";
+  D << Indent(1) << "output [" << N-1 << ":0] R\n";
+  D << ");\n\n";
+
+  // Partial remainder, dividend shifted into the quotient, divisor and the
+  // signs of quotient and remainder of each stage
+  D << "wire [" << N-1 << ":0] rem_w [0:" << S << "];\n";
+  D << "wire [" << N-1 << ":0] quo_w [0:" << S << "];\n";
+  D << "wire [" << N-1 << ":0] dvs_w [0:" << S << "];\n";
+  D << "wire nq_w [0:" << S << "];\n";
+  D << "wire nr_w [0:" << S << "];\n\n";
+
+  D << "assign rem_w[0] = " << N << "'b0;\n";
+  if (Signed) {
+    D << "assign quo_w[0] = X[" << N-1 << "] ? -X : X;\n";
+    D << "assign dvs_w[0] = Y[" << N-1 << "] ? -Y : Y;\n";
+    D << "assign nq_w[0] = X[" << N-1 << "] ^ Y[" << N-1 << "];\n";
+    D << "assign nr_w[0] = X[" << N-1 << "];\n\n";
+  } else {
+    D << "assign quo_w[0] = X;\n";
+    D << "assign dvs_w[0] = Y;\n";
+    D << "assign nq_w[0] = 1'b0;\n";
+    D << "assign nr_w[0] = 1'b0;\n\n";
+  }
+
+  D << "genvar s;\n";
+  D << "generate\n";
+  D << "for (s = 0; s < " << S << "; s = s + 1)\n";
+  D << Indent(++II) << "begin : stage\n";
+  D << Indent(II) << "reg [" << N-1 << ":0] rem_r;\n";
+  D << Indent(II) << "reg [" << N-1 << ":0] quo_r;\n";
+  D << Indent(II) << "reg [" << N-1 << ":0] dvs_r;\n";
+  D << Indent(II) << "reg nq_r;\n";
+  D << Indent(II) << "reg nr_r;\n\n";
+  D << Indent(II) << "reg [" << N << ":0] r;\n";
+  D << Indent(II) << "reg [" << N-1 << ":0] q;\n";
+  D << Indent(II) << "integer i;\n\n";
+
+  D << Indent(II) << "always @(posedge clk)\n";
+  BEGIN(D);
+  D << Indent(II) << "r = {1'b0, rem_w[s]};\n";
+  D << Indent(II) << "q = quo_w[s];\n";
+  D << Indent(II) << "for (i = 0; i < " << K << "; i = i + 1)\n";
+  BEGIN(D);
+  D << Indent(II) << "if (s * " << K << " + i < " << N << ")\n";
+  BEGIN(D);
+  D << Indent(II) << "r = {r[" << N-1 << ":0], q[" << N-1 << "]};\n";
+  D << Indent(II) << "q = q << 1;\n";
+  D << Indent(II) << "if (r >= {1'b0, dvs_w[s]})\n";
+  BEGIN(D);
+  D << Indent(II) << "r = r - {1'b0, dvs_w[s]};\n";
+  D << Indent(II) << "q[0] = 1'b1;\n";
+  END(D);
+  END(D);
+  END(D);
+  D << Indent(II) << "rem_r <= r[" << N-1 << ":0];\n";
+  D << Indent(II) << "quo_r <= q;\n";
+  D << Indent(II) << "dvs_r <= dvs_w[s];\n";
+  D << Indent(II) << "nq_r <= nq_w[s];\n";
+  D << Indent(II) << "nr_r <= nr_w[s];\n";
+  END(D);
+
+  D << "\n";
+  D << Indent(II) << "assign rem_w[s+1] = rem_r;\n";
+  D << Indent(II) << "assign quo_w[s+1] = quo_r;\n";
+  D << Indent(II) << "assign dvs_w[s+1] = dvs_r;\n";
+  D << Indent(II) << "assign nq_w[s+1] = nq_r;\n";
+  D << Indent(II) << "assign nr_w[s+1] = nr_r;\n";
+  END(D);
+  D << "endgenerate\n\n";
+
+  D << "assign Q = nq_w[" << S << "] ? -quo_w[" << S << "] : quo_w[" << S << "];\n";
+  D << "assign R = nr_w[" << S << "] ? -rem_w[" << S << "] : rem_w[" << S << "];\n\n";
+  D << "endmodule\n";
+
+  FileTy FS = openFile(Filename);
+  (*FS) << D.str();
+  FS->close();
+
+  Written.insert(Name);
+
+  return Filename;
+}
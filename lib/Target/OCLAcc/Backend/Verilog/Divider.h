@@ -0,0 +1,40 @@
+#ifndef DIVIDER_H
+#define DIVIDER_H
+
+#include <string>
+
+namespace oclacc {
+namespace ip {
+
+/// \brief Pipelined restoring divider computing quotient Q and remainder R
+/// of X and Y with \p BitWidth bits.
+///
+/// Each pipeline stage computes -divider-radix bits of the quotient, so the
+/// latency is known in advance. Signed dividers divide the magnitudes and
+/// correct the signs after the last stage, as in C.
+class DividerImpl {
+  private:
+    unsigned BitWidth;
+    bool Signed;
+
+  public:
+    DividerImpl(unsigned BitWidth, bool Signed);
+
+    inline unsigned getBitWidth() const {
+      return BitWidth;
+    }
+
+    const std::string getName() const;
+
+    unsigned getLatency() const;
+
+    /// \brief Write the module to its own file once.
+    ///
+    /// \return the filename
+    const std::string define() const;
+};
+
+} // end ns ip
+} // end ns oclacc
+
+#endif /* DIVIDER_H */
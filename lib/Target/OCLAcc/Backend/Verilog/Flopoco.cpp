@@ -1,6 +1,16 @@
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <regex>
+#include <thread>
+#include <vector>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 #include "Macros.h"
 #include "Flopoco.h"
@@ -8,6 +18,11 @@
 #include "OperatorInstances.h"
 #include "DesignFiles.h"
 #include "BlockModule.h"
+#include "Verilog.h"
+
+#include "HW/Arith.h"
+#include "HW/Constant.h"
+#include "Passes/HardwareModel.h"
 
 #define DEBUG_TYPE "flopoco"
 
@@ -15,6 +30,14 @@ using namespace oclacc;
 using namespace llvm;
 using namespace flopoco;
 
+static cl::opt<unsigned> FlopocoJobs("flopoco-jobs", cl::init(0), cl::desc("Number of FloPoCo processes run in parallel, 0 for one per core.") );
+
+static cl::opt<unsigned> FlopocoFrequency("flopoco-frequency", cl::init(200), cl::value_desc("MHz"), cl::desc("Target frequency of FloPoCo operators, the device's frequency if not set.") );
+
+static cl::opt<unsigned> ShiftAddTerms("const-mult-terms", cl::init(3), cl::desc("Multiply by integer constants with up to this many nonzero signed digits by shifted additions instead of IntConstMult.") );
+
+static cl::opt<std::string> FlopocoCache("flopoco-cache", cl::init(""), cl::value_desc("directory"), cl::desc("Reuse FloPoCo operators generated by previous runs from this directory.") );
+
 namespace flopoco {
 
 // Map Name to ModuleInstantiation
@@ -22,25 +45,116 @@ ModMapTy ModuleMap;
 
 } // end ns flopoco
 
-/// \brief Generate modules
-unsigned flopoco::genModule(const std::string Name, const std::string M, BlockModule &BM) {
-
-  // check if module already exists and return latency
-  ModMapConstItTy MI = ModuleMap.find(Name);
-  if (MI != ModuleMap.end()) return MI->second;
+unsigned flopoco::getFrequency() {
+  if (FlopocoFrequency.getNumOccurrences())
+    return FlopocoFrequency;
 
-  std::string Path = getFPExPath("flopoco"); 
+  return Loopus::HardwareModel::getHardwareModel().getFrequency();
+}
 
+/// \brief Arguments passed to FloPoCo for module \p M
+static std::string getArguments(const std::string &M) {
   std::stringstream CS;
-  CS << Path << " target=" << "Stratix5";
-  CS << " frequency=200";
+  CS << "target=" << Loopus::HardwareModel::getHardwareModel().getDevice().Family;
+  CS << " frequency=" << getFrequency();
   CS << " plainVHDL=no";
   CS << " " << M;
-  CS << " 2>&1";
 
-  ODEBUG(CS.str());
+  return CS.str();
+}
 
-  const std::string Result = execute(CS.str());
+/// \brief Key of a module in the cache.
+///
+/// Path, modification time and size of the executable identify the FloPoCo
+/// version without running it.
+static std::string getCacheKey(const std::string &Path, const std::string &Args) {
+  sys::fs::file_status Status;
+  if (std::error_code EC = sys::fs::status(Path, Status))
+    report_fatal_error("Failed to stat " + Path + ": " + EC.message());
+
+  MD5 Hash;
+  Hash.update(Path);
+  Hash.update(std::to_string(Status.getLastModificationTime().toEpochTime()));
+  Hash.update(std::to_string(Status.getSize()));
+  Hash.update(Args);
+
+  MD5::MD5Result Result;
+  Hash.final(Result);
+
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+
+  return Key.str();
+}
+
+static std::string getCachePath(const std::string &Key, const std::string &Ext) {
+  SmallString<128> P(FlopocoCache);
+  sys::path::append(P, Key + Ext);
+  return P.str();
+}
+
+/// \brief Copy the cached module \p Key to \p FileName and return its
+/// latency. The latency is written last, so only complete entries are used.
+static bool readCache(const std::string &Key, const std::string &FileName, unsigned &Latency) {
+  const std::string LatencyPath = getCachePath(Key, ".latency");
+  const std::string VHDPath = getCachePath(Key, ".vhd");
+
+  ErrorOr<std::unique_ptr<MemoryBuffer> > Buf = MemoryBuffer::getFile(LatencyPath);
+  if (!Buf)
+    return false;
+
+  if ((*Buf)->getBuffer().trim().getAsInteger(10, Latency))
+    return false;
+
+  if (sys::fs::copy_file(VHDPath, FileName))
+    return false;
+
+  return true;
+}
+
+/// \brief Write \p Content or a copy of \p From to \p To in the cache
+/// directory without exposing partially written files to concurrent runs.
+static std::error_code writeCacheFile(const std::string &Key, const std::string &To, const std::string &Content, const std::string &From) {
+  SmallString<128> Tmp;
+  int FD;
+
+  if (std::error_code EC = sys::fs::createUniqueFile(getCachePath(Key, "-%%%%%%.tmp"), FD, Tmp))
+    return EC;
+
+  {
+    raw_fd_ostream OS(FD, true);
+    OS << Content;
+  }
+
+  if (!From.empty()) {
+    if (std::error_code EC = sys::fs::copy_file(From, Tmp.str())) {
+      sys::fs::remove(Tmp.str());
+      return EC;
+    }
+  }
+
+  return sys::fs::rename(Tmp.str(), To);
+}
+
+static void writeCache(const std::string &Key, const std::string &FileName, unsigned Latency) {
+  std::error_code EC = sys::fs::create_directories(FlopocoCache);
+
+  if (!EC)
+    EC = writeCacheFile(Key, getCachePath(Key, ".vhd"), "", FileName);
+
+  if (!EC)
+    EC = writeCacheFile(Key, getCachePath(Key, ".latency"), std::to_string(Latency) + "\n", "");
+
+  if (EC)
+    errs() << "Failed to cache " << FileName << " in " << FlopocoCache << ": " << EC.message() << "\n";
+}
+
+/// \brief Run FloPoCo for module \p M or take it from the cache.
+///
+/// Called concurrently by genModules(), so the result is returned instead
+/// of being added to ModuleMap.
+static ModuleTy runFlopoco(const std::string &Name, const std::string &M) {
+  ModuleTy Module;
 
   // Extract FileName from Command; Pattern: outputFile=<name>
   std::regex RgxFileName("(?:outputFile=)\\S+(?= )");
@@ -49,7 +163,25 @@ unsigned flopoco::genModule(const std::string Name, const std::string M, BlockMo
     llvm_unreachable("Getting outputFile failed");
 
   std::string FileName = FileNameMatch[0];
-  FileName = FileName.substr(FileName.find("=")+1);
+  Module.FileName = FileName.substr(FileName.find("=")+1);
+
+  std::string Path = getFPExPath("flopoco"); 
+
+  const std::string Args = getArguments(M);
+
+  std::string Key;
+  if (!FlopocoCache.empty()) {
+    Key = getCacheKey(Path, Args);
+
+    if (readCache(Key, Module.FileName, Module.Latency))
+      return Module;
+  }
+
+  std::stringstream CS;
+  CS << Path << " " << Args;
+  CS << " 2>&1";
+
+  const std::string Result = execute(CS.str());
 
   // Look for pipeline depth; Pattern: Entity: <name>
   std::regex RgxNoPipe("(?:\\n\\s+Not pipelined)(?=\\n)");
@@ -57,7 +189,7 @@ unsigned flopoco::genModule(const std::string Name, const std::string M, BlockMo
 
   std::smatch Match;
 
-  unsigned Latency = 0;
+  Module.Latency = 0;
 
   if (std::regex_search(Result, Match, RgxNoPipe)) {
     // pass
@@ -66,18 +198,342 @@ unsigned flopoco::genModule(const std::string Name, const std::string M, BlockMo
     std::string Res = Match[0];
     std::regex_search(Res, NumMatch, std::regex("\\d+"));
 
-    Latency = stoul(NumMatch[0]);
+    Module.Latency = stoul(NumMatch[0]);
 
   } else
     llvm_unreachable("Invalid flopoco output");
 
-  BM.addFile(FileName);
+  if (!Key.empty())
+    writeCache(Key, Module.FileName, Module.Latency);
+
+  return Module;
+}
+
+/// \brief Generate modules
+unsigned flopoco::genModule(const std::string Name, const std::string M, BlockModule &BM) {
+
+  // Generate the module if it was not generated in advance
+  ModMapConstItTy MI = ModuleMap.find(Name);
+  if (MI == ModuleMap.end()) {
+    ODEBUG(Name << ": " << M);
+    MI = ModuleMap.insert(ModMapElem(Name, runFlopoco(Name, M))).first;
+  }
+
+  const ModuleTy &Module = MI->second;
+
+  const BlockModule::FileListTy &Files = BM.getFiles();
+  if (std::find(Files.begin(), Files.end(), Module.FileName) == Files.end())
+    BM.addFile(Module.FileName);
+
+  ODEBUG("Latency of " << Name << ": " << Module.Latency << " clock cycles");
+
+  return Module.Latency;
+}
+
+void flopoco::genModules(const ModuleListTy &Modules) {
+  std::vector<ModuleListTy::const_iterator> Todo;
 
-  ModuleMap[Name] = Latency;
+  for (ModuleListTy::const_iterator MI = Modules.begin(), ME = Modules.end(); MI != ME; ++MI) {
+    if (ModuleMap.find(MI->first) == ModuleMap.end())
+      Todo.push_back(MI);
+  }
+
+  if (Todo.empty())
+    return;
+
+  unsigned Jobs = FlopocoJobs;
+  if (Jobs == 0)
+    Jobs = std::max(1u, std::thread::hardware_concurrency());
+  Jobs = std::min<unsigned>(Jobs, Todo.size());
+
+  ODEBUG("Generate " << Todo.size() << " modules with " << Jobs << " jobs");
+
+  std::vector<ModuleTy> Results(Todo.size());
+  std::atomic<unsigned> Next(0);
+
+  auto Worker = [&]() {
+    for (unsigned I = Next++; I < Todo.size(); I = Next++)
+      Results[I] = runFlopoco(Todo[I]->first, Todo[I]->second);
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned J = 0; J < Jobs; ++J)
+    Threads.push_back(std::thread(Worker));
+
+  for (std::thread &T : Threads)
+    T.join();
+
+  for (unsigned I = 0; I < Todo.size(); ++I) {
+    ModuleMap[Todo[I]->first] = Results[I];
+    ODEBUG("Latency of " << Todo[I]->first << ": " << Results[I].Latency << " clock cycles");
+  }
+}
 
-  ODEBUG("Latency of " << Name << ": " << Latency << " clock cycles");
+std::string flopoco::getIntMultiplier(const Mul &R, std::string &Name) {
+  const std::string WX = std::to_string(R.getIn(0)->getBitWidth());
+  const std::string WY = std::to_string(R.getIn(1)->getBitWidth());
+  const std::string WOut = std::to_string(R.getBitWidth());
+
+  bool isSigned = true;
+
+  Name = "IntMultiplier_" + WX + "_" + WY + "_" + WOut;
+
+  std::stringstream FInst;
+
+  FInst << "IntMultiplier" << " wX=" << WX << " wY=" << WY << " WOut=" << WOut << " ";
+  FInst << "signedIO=" << conf::to_string(isSigned) << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+std::string flopoco::getFPAdd(const FAdd &R, std::string &Name) {
+  const std::string isSub = "false";
+
+  const std::string dualPath = conf::to_string(conf::FPAdd_DualPath);
+
+  const std::string WE = std::to_string(R.getExponentBitWidth());
+  const std::string WF = std::to_string(R.getMantissaBitWidth());
+
+  Name = "FPAdd_" + WE + "_" + WF;
+
+  std::stringstream FInst;
+
+  FInst << "FPAdd" << " wE=" << WE << " wF=" << WF << " ";
+  FInst << "sub=" << isSub << " ";
+  FInst << "dualPath=" << dualPath << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+std::string flopoco::getFPMult(const FMul &R, std::string &Name) {
+  const std::string WE = std::to_string(R.getExponentBitWidth());
+  const std::string WF = std::to_string(R.getMantissaBitWidth());
+
+  const std::string WFout = WF;
+
+  Name = "FPMult_" + WE + "_" + WF;
+
+  std::stringstream FInst;
+
+  FInst << "FPMult" << " wE=" << WE << " wF=" << WF << " ";
+  FInst << "wFout=" << WFout << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+std::string flopoco::getFPDiv(const FDiv &R, std::string &Name) {
+  const std::string WE = std::to_string(R.getExponentBitWidth());
+  const std::string WF = std::to_string(R.getMantissaBitWidth());
+
+  Name = "FPDiv_" + WE + "_" + WF;
+
+  std::stringstream FInst;
+
+  FInst << "FPDiv" << " wE=" << WE << " wF=" << WF << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+/// \brief The variable operand has the format of the result. It may be any
+/// HW object, e.g. a port or a lane of a vector.
+std::string flopoco::getFPConstMult(const FMul &R, const const_p ConstOp, std::string &Name) {
+  const std::string WEin = std::to_string(R.getExponentBitWidth());
+  const std::string WFin = std::to_string(R.getMantissaBitWidth());
+
+  const std::string WEout = std::to_string(R.getExponentBitWidth());
+  const std::string WFout = std::to_string(R.getMantissaBitWidth());
+
+  // Use the name as it will be converted.
+  const std::string constant = ConstOp->getName();
+
+  std::string ConstOpName = ConstOp->getName();
+  std::replace(ConstOpName.begin(), ConstOpName.end(), '.', '_');
+
+  Name = "FPConstMult_" + WEout + "_" + WFout + "_" + ConstOpName;
+
+  std::stringstream FInst;
+
+  FInst << "FPConstMult" << " wE_in=" << WEin << " wF_in=" << WFin << " ";
+  FInst << "wE_out=" << WEout << " wF_out=" << WFout << " ";
+  FInst << "constant=\"" << constant << "\" ";
+  FInst << "cst_width=0 ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+/// \brief FloPoCo only provides an IEEE FMA, so the Verilog backend converts
+/// its operands and result.
+std::string flopoco::getFMA(const FMA &R, std::string &Name) {
+  const std::string WE = std::to_string(R.getExponentBitWidth());
+  const std::string WF = std::to_string(R.getMantissaBitWidth());
+
+  Name = "IEEEFMA_" + WE + "_" + WF;
+
+  std::stringstream FInst;
+
+  FInst << "IEEEFMA" << " wE=" << WE << " wF=" << WF << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+/// \brief The fixed point value is signed with its MSB as sign bit and
+/// truncated to the LSB.
+std::string flopoco::getFP2Fix(const FPToFixed &R, std::string &Name) {
+  const std::string WE = std::to_string(R.getInExponentBitWidth());
+  const std::string WF = std::to_string(R.getInMantissaBitWidth());
+
+  const std::string MSB = std::to_string(static_cast<int>(R.getBitWidth()) - static_cast<int>(R.getFracBits()) - 1);
+  const std::string LSB = std::to_string(-static_cast<int>(R.getFracBits()));
+
+  Name = "FP2Fix_" + WE + "_" + WF + "_" + std::to_string(R.getBitWidth()) + "_" + std::to_string(R.getFracBits());
+
+  std::stringstream FInst;
+
+  FInst << "FP2Fix" << " wE=" << WE << " wF=" << WF << " ";
+  FInst << "signed=true MSB=" << MSB << " LSB=" << LSB << " trunc=true ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+std::string flopoco::getFix2FP(const FixedToFP &R, std::string &Name) {
+  const std::string WE = std::to_string(R.getExponentBitWidth());
+  const std::string WF = std::to_string(R.getMantissaBitWidth());
+
+  const std::string MSB = std::to_string(static_cast<int>(R.getFixedBitWidth()) - static_cast<int>(R.getFracBits()) - 1);
+  const std::string LSB = std::to_string(-static_cast<int>(R.getFracBits()));
+
+  Name = "Fix2FP_" + std::to_string(R.getFixedBitWidth()) + "_" + std::to_string(R.getFracBits()) + "_" + WE + "_" + WF;
+
+  std::stringstream FInst;
+
+  FInst << "Fix2FP" << " signed=true MSB=" << MSB << " LSB=" << LSB << " ";
+  FInst << "wE=" << WE << " wF=" << WF << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+StageListTy flopoco::getFPFunction(const FPMath &R) {
+  const unsigned E = R.getExponentBitWidth();
+  const unsigned M = R.getMantissaBitWidth();
+
+  const std::string WE = std::to_string(E);
+  const std::string WF = std::to_string(M);
+
+  // Flopoco FP signals carry two exception bits
+  const unsigned FPBits = E + M + 3;
+
+  StageListTy Stages;
+
+  auto addStage = [&](const std::string &Op, const std::string &Name, const std::string &Args, std::vector<std::string> Ins, const std::string &Out, unsigned OutBits, unsigned InBits) {
+    std::stringstream FInst;
+    FInst << Op << " " << Args;
+    FInst << "name=" << Name << " ";
+    FInst << "outputFile=" << Name << ".vhd" << " ";
+
+    Stages.push_back(StageTy{Name, FInst.str(), Ins, Out, OutBits, InBits});
+  };
+
+  const std::string FPArgs = "wE=" + WE + " wF=" + WF + " ";
+
+  switch (R.getFunc()) {
+    case FPMath::Sqrt:
+      addStage("FPSqrt", "FPSqrt_" + WE + "_" + WF, FPArgs, {"X"}, "R", FPBits, 0);
+      break;
+    case FPMath::Exp:
+      addStage("FPExp", "FPExp_" + WE + "_" + WF, FPArgs, {"X"}, "R", FPBits, 0);
+      break;
+    case FPMath::Log:
+      addStage("FPLog", "FPLog_" + WE + "_" + WF, FPArgs, {"X"}, "R", FPBits, 0);
+      break;
+    case FPMath::Pow:
+      addStage("FPPow", "FPPow_" + WE + "_" + WF, FPArgs + "type=0 ", {"X", "Y"}, "R", FPBits, 0);
+      break;
+    case FPMath::Sin:
+    case FPMath::Cos: {
+      // Fixed point of x/pi with the LSB of the sin/cos input. |x/pi| is
+      // below 2^bias for all finite x, so the integer part holds the whole
+      // exponent range of wE with the sign at the MSB.
+      const unsigned LSB = M + 1;
+      const std::string L = std::to_string(LSB);
+      const unsigned MSB = (1u << (E - 1)) - 1;
+      const std::string H = std::to_string(MSB);
+      const unsigned FixBits = MSB + LSB + 1;
+
+      addStage("FPConstMult", "FPConstMult_" + WE + "_" + WF + "_inv_pi",
+          "wE_in=" + WE + " wF_in=" + WF + " wE_out=" + WE + " wF_out=" + WF + " constant=\"1/pi\" cst_width=0 ",
+          {"X"}, "R", FPBits, 0);
+      addStage("FP2Fix", "FP2Fix_" + WE + "_" + WF + "_" + H + "_" + L,
+          FPArgs + "signed=true MSB=" + H + " LSB=-" + L + " trunc=true ",
+          {"I"}, "O", FixBits, 0);
+      // Dropping the integer bits reduces x/pi modulo 2
+      addStage("FixSinCos", "FixSinCos_" + L, "lsb=-" + L + " ",
+          {"X"}, R.getFunc() == FPMath::Sin ? "S" : "C", LSB + 1, LSB + 1);
+      addStage("Fix2FP", "Fix2FP_0_" + L + "_" + WE + "_" + WF,
+          "signed=true MSB=0 LSB=-" + L + " " + FPArgs,
+          {"I"}, "O", FPBits, 0);
+      break;
+    }
+  }
+
+  return Stages;
+}
+
+std::string flopoco::getIntConstMult(const Mul &R, const APInt &C, unsigned WIn, std::string &Name) {
+  const std::string N = C.toString(10, false);
+
+  Name = "IntConstMult_" + std::to_string(WIn) + "_" + N;
+
+  std::stringstream FInst;
+
+  FInst << "IntConstMult" << " wIn=" << WIn << " n=" << N << " ";
+  FInst << "name=" << Name << " ";
+  FInst << "outputFile=" << Name << ".vhd" << " ";
+
+  return FInst.str();
+}
+
+std::vector<int> flopoco::getNAF(const APInt &C) {
+  std::vector<int> Digits;
+
+  // One more bit for the carry of negative digits
+  APInt V = C.zext(C.getBitWidth()+1);
+
+  while (V != 0) {
+    int D = 0;
+    if (V[0])
+      D = V[1] ? -1 : 1;
+
+    Digits.push_back(D);
+
+    if (D == 1)
+      --V;
+    else if (D == -1)
+      ++V;
+
+    V = V.lshr(1);
+  }
+
+  return Digits;
+}
 
-  return Latency;
+unsigned flopoco::getShiftAddTerms() {
+  return ShiftAddTerms;
 }
 
 std::string flopoco::convert(double V, unsigned MantissaBitWidth, unsigned ExponentBitwidth) {
@@ -1,25 +1,48 @@
 #ifndef FLOPOCO_H
 #define FLOPOCO_H
 
+#include <array>
 #include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "Utils.h"
+#include "HW/typedefs.h"
 
+#include "llvm/ADT/APInt.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 
 namespace oclacc {
 class BlockModule;
+class Mul;
+class FAdd;
+class FMul;
+class FDiv;
+class FPMath;
+class FMA;
 } // end ns oclacc
 
 // Flopoco functions
 namespace flopoco {
 
-typedef std::map<std::string, unsigned> ModMapTy;
+/// \brief Generated module with its pipeline depth and VHDL file
+struct ModuleTy {
+  unsigned Latency;
+  std::string FileName;
+};
+
+typedef std::map<std::string, ModuleTy> ModMapTy;
 typedef ModMapTy::const_iterator ModMapConstItTy;
-typedef std::pair<std::string, unsigned> ModMapElem;
+typedef std::pair<std::string, ModuleTy> ModMapElem;
+
+/// \brief Target frequency of all operators in MHz
+unsigned getFrequency();
+
+/// \brief Module instantiation strings by module name
+typedef std::map<std::string, std::string> ModuleListTy;
 
 /// \brief Generate a module
 ///
@@ -28,6 +51,51 @@ typedef std::pair<std::string, unsigned> ModMapElem;
 /// \param F - File collection
 unsigned genModule(const std::string Name, const std::string M, oclacc::BlockModule &BM);
 
+/// \brief Generate all modules in parallel, so genModule() only looks up
+/// their latency.
+void genModules(const ModuleListTy &Modules);
+
+// Module instantiation strings shared by the Verilog backend and the
+// collection of modules. Each sets \p Name to the module's name.
+std::string getIntMultiplier(const oclacc::Mul &R, std::string &Name);
+std::string getFPAdd(const oclacc::FAdd &R, std::string &Name);
+std::string getFPMult(const oclacc::FMul &R, std::string &Name);
+std::string getFPDiv(const oclacc::FDiv &R, std::string &Name);
+std::string getFPConstMult(const oclacc::FMul &R, const oclacc::const_p ConstOp, std::string &Name);
+std::string getIntConstMult(const oclacc::Mul &R, const llvm::APInt &C, unsigned WIn, std::string &Name);
+
+/// \brief Signed digits of \p C in non-adjacent form, least significant
+/// first.
+std::vector<int> getNAF(const llvm::APInt &C);
+
+/// \brief Integer constants with at most this many nonzero digits are
+/// multiplied by shifted additions instead of IntConstMult.
+unsigned getShiftAddTerms();
+std::string getFMA(const oclacc::FMA &R, std::string &Name);
+std::string getFP2Fix(const oclacc::FPToFixed &R, std::string &Name);
+std::string getFix2FP(const oclacc::FixedToFP &R, std::string &Name);
+
+/// \brief One module of a function core.
+///
+/// The inputs of the first stage are the operands, each later stage takes
+/// the low \p InBits of the previous stage's output, all bits if 0.
+struct StageTy {
+  std::string Name;
+  std::string Inst;
+  std::vector<std::string> Ins;
+  std::string Out;
+  unsigned OutBits;
+  unsigned InBits;
+};
+
+typedef std::vector<StageTy> StageListTy;
+
+/// \brief Modules computing the math function of \p R.
+///
+/// Sin and cos are computed in fixed point: x/pi is reduced to [-1,1) by
+/// dropping its integer bits and fed to FixSinCos.
+StageListTy getFPFunction(const oclacc::FPMath &R);
+
 std::string convert(double V, unsigned MantissaBitWidth, unsigned ExponentBitwidth);
 
 inline std::string getFPExPath(const std::string &E) {
@@ -52,8 +120,8 @@ inline std::string getFPExPath(const std::string &E) {
 }
 
 inline std::string execute(const std::string &C) {
-  FileTy Log = openFile("flopoco.log");
-  (*Log) << "[exec] " << C << "\n";
+  // Modules are generated concurrently, but share the log.
+  static std::mutex LogMutex;
 
   std::array<char, 128> buffer;
   std::string Result;
@@ -74,6 +142,10 @@ inline std::string execute(const std::string &C) {
     exit(1);
   }
 
+  std::lock_guard<std::mutex> Lock(LogMutex);
+
+  FileTy Log = openFile("flopoco.log");
+  (*Log) << "[exec] " << C << "\n";
   (*Log) << Result;
   (*Log) << "\n";
   Log->flush();
@@ -36,7 +36,7 @@ int FlopocoFPFormat::visit(ConstVal &R) {
 int FlopocoFPFormat::visit(ScalarPort &R) {
   VISIT_ONCE(R);
   if (R.isFP()) {
-    R.setBitWidth(R.getBitWidth()+2);
+    R.setBitWidth(R.getBitWidth()+2*R.getLanes());
     ODEBUG("set bitwidth for " << R.getUniqueName());
   }
   super::visit(R);
@@ -46,7 +46,7 @@ int FlopocoFPFormat::visit(ScalarPort &R) {
 int FlopocoFPFormat::visit(StreamPort &R) {
   VISIT_ONCE(R);
   if (R.isFP()) {
-    R.setBitWidth(R.getBitWidth()+2);
+    R.setBitWidth(R.getBitWidth()+2*R.getLanes());
     ODEBUG("set bitwidth for " << R.getUniqueName());
   }
   super::visit(R);
@@ -59,6 +59,17 @@ int FlopocoFPFormat::visit(StreamAccess &R) {
   streamport_p S = R.getStream();
 
   if (S->isFP()) {
+    R.setBitWidth(R.getBitWidth()+2*R.getLanes());
+    ODEBUG("set bitwidth for " << R.getUniqueName());
+  }
+  super::visit(R);
+  return 0;
+}
+
+/// \brief Each lane of a floating point vector gets the exception bits.
+int FlopocoFPFormat::visit(Slice &R) {
+  VISIT_ONCE(R);
+  if (R.isFP()) {
     R.setBitWidth(R.getBitWidth()+2);
     ODEBUG("set bitwidth for " << R.getUniqueName());
   }
@@ -66,6 +77,16 @@ int FlopocoFPFormat::visit(StreamAccess &R) {
   return 0;
 }
 
+int FlopocoFPFormat::visit(Concat &R) {
+  VISIT_ONCE(R);
+  if (R.isFP()) {
+    R.setBitWidth(R.getBitWidth()+2*R.getLanes());
+    ODEBUG("set bitwidth for " << R.getUniqueName());
+  }
+  super::visit(R);
+  return 0;
+}
+
 int FlopocoFPFormat::visit(FPArith &R) {
   VISIT_ONCE(R);
   R.setBitWidth(R.getBitWidth()+2);
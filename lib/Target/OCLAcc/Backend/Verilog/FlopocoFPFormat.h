@@ -29,6 +29,8 @@ class FlopocoFPFormat : public DFVisitor {
     // Arith
     int visit(FPArith &);
     int visit(FPCompare &);
+    int visit(Slice &);
+    int visit(Concat &);
 };
 
 } // end ns oclacc
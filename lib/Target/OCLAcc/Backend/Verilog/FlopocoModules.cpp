@@ -0,0 +1,232 @@
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+#include "FlopocoModules.h"
+
+#include "HW/Arith.h"
+#include "HW/Constant.h"
+#include "HW/typedefs.h"
+#include "Macros.h"
+
+
+#define DEBUG_TYPE "flopoco"
+
+using namespace oclacc;
+using namespace llvm;
+
+static cl::opt<unsigned> OperatorAreaBudget("operator-area-budget", cl::init(80), cl::desc("Percentage of the device the FloPoCo operators may use before they are shared, 0 disables sharing."));
+
+FlopocoModules::FlopocoModules() {
+  ODEBUG(__PRETTY_FUNCTION__);
+}
+
+FlopocoModules::~FlopocoModules() {
+  ODEBUG(__PRETTY_FUNCTION__);
+}
+
+void FlopocoModules::addInstance(const HW &R, const std::string &Name) {
+  const std::string BName = R.getParent() ? R.getParent()->getUniqueName() : "";
+  Instances[BName][Name]++;
+
+  if (Resources.find(Name) != Resources.end())
+    return;
+
+  // Module names start with the FloPoCo operator
+  const std::string Op = Name.substr(0, Name.find('_'));
+
+  // FloPoCo adds two exception bits to FP signals, the operators are
+  // calibrated by their IEEE width.
+  unsigned BitWidth = R.getBitWidth();
+  if (const FPHW *FP = dynamic_cast<const FPHW *>(&R))
+    BitWidth = FP->getExponentBitWidth() + FP->getMantissaBitWidth() + 1;
+
+  Resources[Name] = Loopus::HardwareModel::getHardwareModel().getOperatorResources(Op, BitWidth);
+}
+
+std::map<std::string, unsigned> FlopocoModules::getResourceLimits() const {
+  std::map<std::string, unsigned> Limits;
+
+  if (OperatorAreaBudget == 0)
+    return Limits;
+
+  // Each Block instantiates its own operators
+  std::map<std::string, unsigned> MaxInstances;
+  Loopus::ResourceUsage Total;
+
+  for (const auto &B : Instances) {
+    for (const auto &I : B.second) {
+      Total += Resources.at(I.first) * I.second;
+      unsigned &M = MaxInstances[I.first];
+      M = std::max(M, I.second);
+    }
+  }
+
+  const Loopus::ResourceUsage Budget = Loopus::HardwareModel::getHardwareModel().getAreaBudget(OperatorAreaBudget);
+
+  if (Budget.fits(Total) >= 1)
+    return Limits;
+
+  // Scale all operators by the scarcest resource
+  double Scale = 1.0;
+  if (Total.ALMs > Budget.ALMs) Scale = std::min(Scale, (double) Budget.ALMs / Total.ALMs);
+  if (Total.DSPs > Budget.DSPs) Scale = std::min(Scale, (double) Budget.DSPs / Total.DSPs);
+  if (Total.M20Ks > Budget.M20Ks) Scale = std::min(Scale, (double) Budget.M20Ks / Total.M20Ks);
+
+  ODEBUG("Operators need " << Total.ALMs << " ALMs, " << Total.DSPs << " DSPs, "
+      << Total.M20Ks << " M20Ks, scale instances by " << Scale);
+
+  for (const auto &M : MaxInstances) {
+    const unsigned N = std::max(1u, static_cast<unsigned>(M.second * Scale));
+    if (N < M.second) {
+      Limits[M.first] = N;
+      ODEBUG("Limit " << M.first << " to " << N << " instances per Block");
+    }
+  }
+
+  return Limits;
+}
+
+/// \brief Same distinction between constant and variable multiplication as
+/// in the Verilog backend.
+int FlopocoModules::visit(Mul &R) {
+  VISIT_ONCE(R);
+
+  const_p In0 = std::dynamic_pointer_cast<ConstVal>(R.getIn(0));
+  const_p In1 = std::dynamic_pointer_cast<ConstVal>(R.getIn(1));
+
+  std::string Name;
+  std::string M;
+
+  if (In0 && In1) {
+    // pass
+  } else if (In0 || In1) {
+    const_p ConstOp = In0 ? In0 : In1;
+    const base_p VarOp = In0 ? R.getIn(1) : R.getIn(0);
+
+    const unsigned N = std::max(R.getBitWidth(), VarOp->getBitWidth());
+    const APInt C = ConstOp->getAPInt(N);
+
+    const std::vector<int> Digits = flopoco::getNAF(C);
+    const unsigned Terms = Digits.size() - std::count(Digits.begin(), Digits.end(), 0);
+
+    // Shifted additions need no module
+    if (Terms > flopoco::getShiftAddTerms())
+      M = flopoco::getIntConstMult(R, C, N, Name);
+  } else
+    M = flopoco::getIntMultiplier(R, Name);
+
+  if (!M.empty()) {
+    Modules[Name] = M;
+    addInstance(R, Name);
+  }
+
+  super::visit(R);
+  return 0;
+}
+
+int FlopocoModules::visit(FAdd &R) {
+  VISIT_ONCE(R);
+
+  std::string Name;
+  const std::string M = flopoco::getFPAdd(R, Name);
+  Modules[Name] = M;
+  addInstance(R, Name);
+
+  super::visit(R);
+  return 0;
+}
+
+/// \brief Same distinction between constant and variable multiplication as
+/// in the Verilog backend.
+int FlopocoModules::visit(FMul &R) {
+  VISIT_ONCE(R);
+
+  const_p In0 = std::dynamic_pointer_cast<ConstVal>(R.getIn(0));
+  const_p In1 = std::dynamic_pointer_cast<ConstVal>(R.getIn(1));
+
+  std::string Name;
+  std::string M;
+
+  if (In0 || In1) {
+    const_p ConstOp = In0 ? In0 : In1;
+
+    // Leave unsupported operands to the Verilog backend
+    if (!(In0 && In1))
+      M = flopoco::getFPConstMult(R, ConstOp, Name);
+  } else
+    M = flopoco::getFPMult(R, Name);
+
+  if (!M.empty()) {
+    Modules[Name] = M;
+    addInstance(R, Name);
+  }
+
+  super::visit(R);
+  return 0;
+}
+
+int FlopocoModules::visit(FDiv &R) {
+  VISIT_ONCE(R);
+
+  std::string Name;
+  const std::string M = flopoco::getFPDiv(R, Name);
+  Modules[Name] = M;
+  addInstance(R, Name);
+
+  super::visit(R);
+  return 0;
+}
+
+int FlopocoModules::visit(FPMath &R) {
+  VISIT_ONCE(R);
+
+  for (const flopoco::StageTy &S : flopoco::getFPFunction(R)) {
+    Modules[S.Name] = S.Inst;
+    addInstance(R, S.Name);
+  }
+
+  super::visit(R);
+  return 0;
+}
+
+int FlopocoModules::visit(FMA &R) {
+  VISIT_ONCE(R);
+
+  std::string Name;
+  const std::string M = flopoco::getFMA(R, Name);
+  Modules[Name] = M;
+  addInstance(R, Name);
+
+  super::visit(R);
+  return 0;
+}
+
+int FlopocoModules::visit(FPToFixed &R) {
+  VISIT_ONCE(R);
+
+  std::string Name;
+  const std::string M = flopoco::getFP2Fix(R, Name);
+  Modules[Name] = M;
+  addInstance(R, Name);
+
+  super::visit(R);
+  return 0;
+}
+
+int FlopocoModules::visit(FixedToFP &R) {
+  VISIT_ONCE(R);
+
+  std::string Name;
+  const std::string M = flopoco::getFix2FP(R, Name);
+  Modules[Name] = M;
+  addInstance(R, Name);
+
+  super::visit(R);
+  return 0;
+}
+
+#ifdef DEBUG_TYPE
+#undef DEBUG_TYPE
+#endif
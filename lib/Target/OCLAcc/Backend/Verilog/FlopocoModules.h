@@ -0,0 +1,58 @@
+#ifndef FLOPOCOMODULES_H
+#define FLOPOCOMODULES_H
+
+#include "HW/Visitor/DFVisitor.h"
+#include "Passes/HardwareModel.h"
+#include "Flopoco.h"
+
+#include <map>
+#include <string>
+
+namespace oclacc {
+
+/// \brief Collect the FloPoCo modules used by a design, so they can be
+/// generated in parallel before the Verilog backend needs their latencies.
+///
+/// The number of instances per Block and the calibrated resources of each
+/// module are recorded to derive operator limits for the scheduler when the
+/// design does not fit the device.
+class FlopocoModules : public DFVisitor {
+  private:
+    typedef DFVisitor super;
+
+    flopoco::ModuleListTy Modules;
+
+    // Block -> Module -> Instances
+    std::map<std::string, std::map<std::string, unsigned> > Instances;
+    std::map<std::string, Loopus::ResourceUsage> Resources;
+
+    void addInstance(const HW &R, const std::string &Name);
+
+  public:
+    FlopocoModules();
+    ~FlopocoModules();
+
+    inline const flopoco::ModuleListTy &getModules() const {
+      return Modules;
+    }
+
+    /// \brief Instances per Block of each module, so that the operators of
+    /// all Blocks fit into -operator-area-budget percent of the device.
+    ///
+    /// Modules are only returned if the unshared design exceeds the budget.
+    std::map<std::string, unsigned> getResourceLimits() const;
+
+    // Arith
+    int visit(Mul &);
+    int visit(FAdd &);
+    int visit(FMul &);
+    int visit(FDiv &);
+    int visit(FPMath &);
+    int visit(FMA &);
+    int visit(FPToFixed &);
+    int visit(FixedToFP &);
+};
+
+} // end ns oclacc
+
+#endif /* FLOPOCOMODULES_H */
@@ -17,6 +17,8 @@
 #include "OCLAccHW.h"
 #include "OCL/OpenCLDefines.h"
 #include "FlopocoFPFormat.h"
+#include "FlopocoModules.h"
+#include "BlockModule.h"
 
 #define DEBUG_TYPE "verilog"
 
@@ -66,6 +68,12 @@ bool GenerateVerilog::runOnModule(Module &M) {
   FlopocoFPFormat F;
   Design.accept(F);
 
+  // Generate all FloPoCo operators at once
+  FlopocoModules FM;
+  Design.accept(FM);
+  flopoco::genModules(FM.getModules());
+  BlockModule::setAreaLimits(FM.getResourceLimits());
+
   Verilog V;
   Design.accept(V);
 
@@ -7,6 +7,7 @@
 #include <unordered_set>
 #include <map>
 #include <set>
+#include <cstdlib>
 
 #include "../../HW/Kernel.h"
 
@@ -21,9 +22,186 @@
 
 #include "VerilogModule.h"
 
+#include "Macros.h"
+#include "Utils.h"
+#include "Passes/HardwareModel.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
 #define DEBUG_TYPE "verilog"
 
 using namespace oclacc;
+using namespace llvm;
+
+static cl::opt<unsigned> ComputeUnits("oclacc-cu", cl::init(1), cl::desc("Number of compute units each kernel is replicated to"));
+
+static cl::opt<unsigned> TimingMemLatency("timing-mem-latency", cl::init(100), cl::value_desc("cycles"), cl::desc("Latency of a global memory access assumed by the timing report, the device's latency if not set"));
+
+static cl::opt<bool> NoBlockFifos("no-block-fifos", cl::init(false), cl::desc("Connect Blocks by a handshake instead of FIFOs."));
+
+static cl::opt<unsigned> BlockFifoDepth("block-fifo-depth", cl::init(0), cl::desc("Depth of the FIFOs between Blocks, derived from the Blocks' timing if 0"));
+
+static cl::opt<unsigned> BlockFifoMaxDepth("block-fifo-max-depth", cl::init(64), cl::desc("Maximum depth of derived FIFOs between Blocks"));
+
+static cl::list<std::string> KernelComputeUnits("oclacc-cu-kernel", cl::CommaSeparated, cl::desc("Number of compute units of a single kernel, e.g. vadd=4"), cl::value_desc("Kernel=N"));
+
+unsigned oclacc::getNumComputeUnits(const Kernel &K) {
+  for (const std::string &L : KernelComputeUnits) {
+    std::string::size_type Pos = L.find('=');
+    if (Pos == std::string::npos || Pos == 0)
+      report_fatal_error("Invalid compute units " + L + ", expected Kernel=N");
+
+    if (L.substr(0, Pos) != K.getName())
+      continue;
+
+    const int N = std::atoi(L.substr(Pos+1).c_str());
+    if (N <= 0)
+      report_fatal_error("Invalid compute units " + L + ", at least one required");
+
+    return N;
+  }
+
+  if (ComputeUnits == 0)
+    report_fatal_error("At least one compute unit required");
+
+  return ComputeUnits;
+}
+
+const std::string oclacc::defineArbiter() {
+  const std::string Filename = "rr_arbiter.v";
+
+  static bool Written = false;
+  if (Written)
+    return Filename;
+
+  // Keep the grant while its request is active, otherwise pass it to the
+  // next requester.
+  std::string R = R"BLOCK(
+module rr_arbiter #(
+    parameter N = 2,
+    parameter W = 1
+) (
+    input   wire            clk,
+    input   wire            rst,
+    input   wire    [N-1:0] req,
+    output  reg     [W-1:0] grant
+);
+
+integer i;
+reg [W-1:0] next;
+reg found;
+
+always @(*) begin
+    next = grant;
+    found = 0;
+    for (i = 1; i <= N; i = i + 1)
+        if (!found && req[(grant + i) % N]) begin
+            next = (grant + i) % N;
+            found = 1;
+        end
+end
+
+always @(posedge clk)
+    if (rst)
+        grant <= '0;
+    else if (req[grant] == 0)
+        grant <= next;
+
+endmodule
+)BLOCK";
+
+  FileTy FS = openFile(Filename);
+  (*FS) << R;
+  FS->close();
+
+  Written = true;
+
+  return Filename;
+}
+
+const std::string oclacc::defineBlockFifo() {
+  const std::string Filename = "block_fifo.v";
+
+  static bool Written = false;
+  if (Written)
+    return Filename;
+
+  // The input is acknowledged in the cycle it is written, so a producer
+  // only waits while the FIFO is full. The head is presented to the consumer
+  // until it is acknowledged.
+  std::string R = R"BLOCK(
+module block_fifo #(
+    parameter W = 1,
+    parameter AW = 1
+) (
+    input   wire            clk,
+    input   wire            rst,
+    input   wire    [W-1:0] in,
+    input   wire            in_valid,
+    output  wire            in_ack,
+    output  wire    [W-1:0] out,
+    output  wire            out_valid,
+    input   wire            out_ack
+);
+
+reg [W-1:0] data [0:(1<<AW)-1];
+reg [AW-1:0] rd;
+reg [AW-1:0] wr;
+reg [AW:0] count;
+
+wire push = in_valid && count != (1<<AW);
+wire pop = out_ack && count != 0;
+
+assign in_ack = push;
+assign out = data[rd];
+assign out_valid = count != 0;
+
+always @(posedge clk)
+    if (rst) begin
+        rd <= '0;
+        wr <= '0;
+        count <= '0;
+    end else begin
+        if (push) begin
+            data[wr] <= in;
+            wr <= wr + 1;
+        end
+        if (pop)
+            rd <= rd + 1;
+        if (push && !pop)
+            count <= count + 1;
+        else if (!push && pop)
+            count <= count - 1;
+    end
+
+endmodule
+)BLOCK";
+
+  FileTy FS = openFile(Filename);
+  (*FS) << R;
+  FS->close();
+
+  Written = true;
+
+  return Filename;
+}
+
+/// \brief Latency of a global memory access in cycles.
+static unsigned getMemLatency() {
+  if (TimingMemLatency.getNumOccurrences())
+    return TimingMemLatency;
+
+  return Loopus::HardwareModel::getHardwareModel().getGMemLatency();
+}
+
+/// \brief Cycles between two work-items entering a Block, including the
+/// memory latency of Blocks accessing memory.
+static unsigned getBlockInterval(const BlockTimingTy &T) {
+  if (T.Loads || T.Stores)
+    return T.InitiationInterval + getMemLatency();
+
+  return T.InitiationInterval;
+}
 
 KernelModule::KernelModule(Kernel &K) : VerilogModule(K), Comp(K) {
 }
@@ -48,6 +226,98 @@ const std::string KernelModule::declHeader() const {
   return S.str();
 }
 
+const BlockTimingTy &KernelModule::getBlockTiming(const Block &B) const {
+  for (const BlockTimingTy &T : BlockTimings) {
+    if (T.Name == B.getName())
+      return T;
+  }
+
+  llvm_unreachable("Block not scheduled");
+}
+
+bool KernelModule::isFifoEdge(const ScalarPort &Src, const ScalarPort &Sink) const {
+  if (NoBlockFifos)
+    return false;
+
+  if (!Src.isPipelined() || !Sink.isPipelined())
+    return false;
+
+  if (Src.isBackEdge() || Sink.isBackEdge())
+    return false;
+
+  if (!Src.getParent()->isBlock() || Src.getParent() == Sink.getParent())
+    return false;
+
+  return Src.getOuts().size() == 1 && Sink.getIns().size() == 1;
+}
+
+/// \brief While the consumer works on a single work-item, the producer
+/// completes one every interval. The FIFO holds all of them, so the producer
+/// only stalls when the consumer is slower on average.
+unsigned KernelModule::getFifoDepth(const ScalarPort &Src, const ScalarPort &Sink) const {
+  if (BlockFifoDepth)
+    return BlockFifoDepth;
+
+  const BlockTimingTy &SrcT = getBlockTiming(static_cast<const Block &>(*Src.getParent()));
+  const BlockTimingTy &SinkT = getBlockTiming(static_cast<const Block &>(*Sink.getParent()));
+
+  unsigned SinkLatency = SinkT.Latency + 1;
+  if (SinkT.Loads || SinkT.Stores)
+    SinkLatency += getMemLatency();
+
+  const unsigned SrcInterval = getBlockInterval(SrcT);
+
+  unsigned Depth = (SinkLatency + SrcInterval - 1) / SrcInterval + 1;
+  Depth = std::min(Depth, std::max(2u, (unsigned) BlockFifoMaxDepth));
+
+  ODEBUG("FIFO " << getOpName(Src) << " -> " << getOpName(Sink) << ": " << Depth);
+
+  return Depth;
+}
+
+const std::string KernelModule::declBlockFifo(const ScalarPort &Src, const ScalarPort &Sink) const {
+  std::stringstream S;
+
+  const Signal::SignalListTy SrcSigs = getOutSignals(Src);
+  const Signal::SignalListTy SinkSigs = getInSignals(Sink);
+
+  assert(SrcSigs.size() == 3 && SinkSigs.size() == 3);
+
+  // Depth is rounded up to a power of two
+  unsigned AddrWidth = 1;
+  while ((1u << AddrWidth) < getFifoDepth(Src, Sink))
+    ++AddrWidth;
+
+  S << "// " << getOpName(Src) << " -> " << getOpName(Sink) << "\n";
+  S << "block_fifo #(.W(" << Src.getBitWidth() << "), .AW(" << AddrWidth << ")) "
+    << getOpName(Src) << "_to_" << getOpName(Sink) << "_fifo(\n";
+  S << I(1) << ".clk(clk),\n";
+  S << I(1) << ".rst(rst),\n";
+  S << I(1) << ".in(" << SrcSigs[0].Name << "),\n";
+  S << I(1) << ".in_valid(" << SrcSigs[1].Name << "),\n";
+  S << I(1) << ".in_ack(" << SrcSigs[2].Name << "),\n";
+  S << I(1) << ".out(" << SinkSigs[0].Name << "),\n";
+  S << I(1) << ".out_valid(" << SinkSigs[1].Name << "),\n";
+  S << I(1) << ".out_ack(" << SinkSigs[2].Name << ")\n";
+  S << ");\n";
+
+  return S.str();
+}
+
+bool KernelModule::hasBlockFifos() const {
+  for (const block_p &B : Comp.getBlocks()) {
+    for (const scalarport_p &P : B->getOutScalars()) {
+      if (P->getOuts().size() != 1)
+        continue;
+
+      if (isFifoEdge(*P, static_cast<const ScalarPort &>(*P->getOut(0))))
+        return true;
+    }
+  }
+
+  return false;
+}
+
 /// \brief Declare Wires for the Blocks' Ports and connect them with the
 /// Kernel inputs
 ///
@@ -60,6 +330,10 @@ const std::string KernelModule::declHeader() const {
 /// one, depending on the condition which must be true for a transition of the
 /// originating Block to the input's Block.
 ///
+/// Ports with a single source and sink in different Blocks are connected by
+/// a FIFO, so the producing Block continues with the next work-item before
+/// the consumer accepted the previous one.
+///
 const std::string KernelModule::declBlockWires() const {
   std::stringstream S;
 
@@ -139,6 +413,10 @@ const std::string KernelModule::declBlockWires() const {
 
     assert(SrcPortSigs.size() == SinkPortSigs.size());
 
+    const bool Fifo = isFifoEdge(*Src, *Sink);
+    if (Fifo)
+      Logic << declBlockFifo(*Src, *Sink);
+
     for (Signal::SignalListConstItTy
         SinkI = SinkPortSigs.begin(),
         SrcI = SrcPortSigs.begin(),
@@ -150,6 +428,9 @@ const std::string KernelModule::declBlockWires() const {
       Signal LocDef(SinkI->Name, SinkI->BitWidth, Signal::Local, Signal::Wire);
       Wires << LocDef.getDefStr() << ";\n";
 
+      if (Fifo)
+        continue;
+
       if (SinkI->Direction == Signal::Out) {
         if (NumSourceOuts == 1)
           Assignments << "assign " << SrcI->Name << " = " << SinkI->Name << ";\n"; 
@@ -174,6 +455,9 @@ const std::string KernelModule::declBlockWires() const {
 
     assert(SinkPortSigs.size() == ThisPortSigs.size());
 
+    // Connected by the FIFO declared for the sink
+    const bool Fifo = isFifoEdge(*P, *SP);
+
     for (Signal::SignalListConstItTy
         TI = ThisPortSigs.begin(),
         SI = SinkPortSigs.begin(),
@@ -184,7 +468,7 @@ const std::string KernelModule::declBlockWires() const {
       Signal LocDef(TI->Name, TI->BitWidth, Signal::Local, Signal::Wire);
       Wires << LocDef.getDefStr() << ";\n";
 
-      if (NumSinkInputs == 1) {
+      if (NumSinkInputs == 1 && !Fifo) {
         if (TI->Direction == Signal::Out)
           Assignments << "assign " << SI->Name << " = " << TI->Name << ";\n"; 
         else
@@ -414,3 +698,363 @@ const std::string KernelModule::instBlocks() const {
   }
   return SBlock.str();
 }
+
+const std::string KernelModule::getInstModuleName() const {
+  if (getNumComputeUnits(Comp) > 1)
+    return Comp.getName() + "_cu";
+
+  return Comp.getName();
+}
+
+namespace {
+
+inline bool ends_with_ctrl(const std::string &Name) {
+  return ends_with(Name, "_valid") || ends_with(Name, "_ack") || ends_with(Name, "_ready");
+}
+
+inline const std::string getCUName(const std::string &Name, unsigned CU) {
+  return Name + "_cu" + std::to_string(CU);
+}
+
+} // end anonymous ns
+
+const std::string KernelModule::declComputeUnits() const {
+  std::stringstream S;
+
+  const unsigned N = getNumComputeUnits(Comp);
+  assert(N > 1);
+
+  unsigned SW = 1;
+  while ((1u << SW) < N)
+    SW++;
+
+  const Signal::SignalListTy KernelPorts = getSignals(Comp);
+
+  // Tags of load units are extended by the compute unit
+  std::set<std::string> TagNames;
+  for (const streamport_p P : Comp.getStreams()) {
+    if (P->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
+    for (const SignalGroupTy &G : getSignalGroups(P)) {
+      for (const Signal &Sig : G.second) {
+        if (ends_with(Sig.Name, "_tag"))
+          TagNames.insert(Sig.Name);
+      }
+    }
+  }
+
+  S << "module " << getInstModuleName() << "(\n";
+
+  Signal::SignalListTy Ports = KernelPorts;
+  for (Signal &Sig : Ports) {
+    Sig.Type = Signal::Wire;
+    if (TagNames.count(Sig.Name))
+      Sig.BitWidth += SW;
+  }
+  S << createPortList(Ports);
+
+  S << "\n); // end ports\n";
+
+  // Wires of each compute unit
+  S << "// Compute unit wires\n";
+  for (unsigned CU = 0; CU < N; ++CU) {
+    for (const Signal &Sig : KernelPorts) {
+      if (Sig.Name == "clk" || Sig.Name == "rst" || Sig.Name == "start")
+        continue;
+
+      Signal W(getCUName(Sig.Name, CU), Sig.BitWidth, Signal::Local, Signal::Wire);
+      S << W.getDefStr() << ";\n";
+    }
+  }
+
+  S << "// Compute units\n";
+  for (unsigned CU = 0; CU < N; ++CU) {
+    S << Comp.getName() << " " << getCUName(Comp.getUniqueName(), CU) << "(\n";
+
+    std::string Linebreak = "";
+    for (const Signal &Sig : KernelPorts) {
+      std::string Conn = Sig.Name;
+      if (Sig.Name != "clk" && Sig.Name != "rst" && Sig.Name != "start")
+        Conn = getCUName(Sig.Name, CU);
+
+      S << Linebreak << I(1) << "." << Sig.Name << "(" << Conn << ")";
+      Linebreak = ",\n";
+    }
+    S << "\n);\n";
+  }
+
+  // Arguments are the same for all compute units
+  S << "// Kernel arguments\n";
+  std::vector<scalarport_p> WorkItemPorts;
+  for (const scalarport_p P : Comp.getInScalars()) {
+    if (P->isPipelined()) {
+      WorkItemPorts.push_back(P);
+      continue;
+    }
+
+    for (unsigned CU = 0; CU < N; ++CU)
+      S << "assign " << getCUName(getOpName(P), CU) << " = " << getOpName(P) << ";\n";
+  }
+
+  // Work-groups must stay on a single compute unit to share local memory and
+  // barriers. A new work-group starts with all local ids being zero.
+  bool ByGroup = false;
+  for (const streamport_p P : Comp.getStreams())
+    ByGroup |= P->getAddressSpace() == ocl::AS_LOCAL;
+  for (const block_p B : Comp.getBlocks())
+    ByGroup |= B->getBarrier() != nullptr;
+
+  std::vector<std::string> LocalIDs;
+  for (const scalarport_p P : WorkItemPorts) {
+    if (P->getName().compare(0, 12, "get_local_id") == 0)
+      LocalIDs.push_back(getOpName(P));
+  }
+
+  if (ByGroup && LocalIDs.empty())
+    report_fatal_error("Kernel " + Comp.getName() + " uses local memory or barriers but no local id to detect work-groups for multiple compute units");
+
+  unsigned II = 0;
+
+  if (!WorkItemPorts.empty()) {
+    const unsigned NP = WorkItemPorts.size();
+
+    S << "// Work-item dispatcher\n";
+    S << Signal("dispatch_cu", SW, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+    S << Signal("dispatch_next", SW, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+    S << Signal("dispatch_target", SW, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+    S << Signal("dispatch_taken", NP, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+    S << Signal("dispatch_acks", NP, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+
+    S << "assign dispatch_next = (dispatch_cu == " << N-1 << ") ? 0 : dispatch_cu + 1;\n";
+
+    if (ByGroup) {
+      S << Signal("dispatch_started", 1, Signal::Local, Signal::Reg).getDefStr() << ";\n";
+
+      S << "assign dispatch_target = (dispatch_started == 1 && dispatch_taken == 0";
+      for (const std::string &ID : LocalIDs)
+        S << " && " << ID << "_unbuf == 0";
+      S << ") ? dispatch_next : dispatch_cu;\n";
+    } else
+      S << "assign dispatch_target = dispatch_cu;\n";
+
+    for (unsigned p = 0; p < NP; ++p) {
+      const std::string PName = getOpName(WorkItemPorts[p]);
+
+      std::string Prefix = "";
+      S << "assign dispatch_acks[" << p << "] = ";
+      for (unsigned CU = 0; CU < N; ++CU) {
+        S << Prefix << "(" << getCUName(PName+"_ack", CU) << " && dispatch_target == " << CU << ")";
+        Prefix = " || ";
+      }
+      S << ";\n";
+
+      S << "assign " << PName << "_ack = dispatch_acks[" << p << "];\n";
+
+      for (unsigned CU = 0; CU < N; ++CU) {
+        S << "assign " << getCUName(PName+"_unbuf", CU) << " = " << PName << "_unbuf;\n";
+        S << "assign " << getCUName(PName+"_unbuf_valid", CU) << " = " << PName << "_unbuf_valid && dispatch_taken[" << p << "] == 0 && dispatch_target == " << CU << ";\n";
+      }
+    }
+
+    // The next work-item is dispatched when all inputs of the current one are
+    // taken by the compute unit.
+    S << "always @(posedge clk)\n";
+      BEGIN(S);
+      S << Indent(II) << "if (rst==1)\n";
+        BEGIN(S);
+        S << Indent(II) << "dispatch_cu <= '0;\n";
+        S << Indent(II) << "dispatch_taken <= '0;\n";
+        if (ByGroup)
+          S << Indent(II) << "dispatch_started <= 0;\n";
+        END(S);
+      S << Indent(II) << "else\n";
+        BEGIN(S);
+        S << Indent(II) << "dispatch_taken <= dispatch_taken | dispatch_acks;\n";
+        if (ByGroup)
+          S << Indent(II) << "if (dispatch_taken == 0 && dispatch_acks != 0) dispatch_cu <= dispatch_target;\n";
+        S << Indent(II) << "if ((dispatch_taken | dispatch_acks) == " << ((1ull << NP) - 1) << ")\n";
+          BEGIN(S);
+          S << Indent(II) << "dispatch_taken <= '0;\n";
+          if (ByGroup)
+            S << Indent(II) << "dispatch_started <= 1;\n";
+          else
+            S << Indent(II) << "dispatch_cu <= dispatch_next;\n";
+          END(S);
+        END(S);
+      END(S);
+  }
+
+  // Each access, burst and load unit of a global StreamPort is shared by the
+  // compute units and granted while its request is active.
+  S << "// Stream arbiters\n";
+  for (const streamport_p P : Comp.getStreams()) {
+    if (P->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
+    for (const SignalGroupTy &G : getSignalGroups(P)) {
+      const std::string &GName = G.first;
+
+      std::string ReqName = GName + "_valid";
+      std::string TagName;
+      unsigned TagWidth = 0;
+      for (const Signal &Sig : G.second) {
+        if (Sig.Name == GName + "_address_valid")
+          ReqName = Sig.Name;
+        if (Sig.Name == GName + "_unbuf_tag") {
+          TagName = Sig.Name;
+          TagWidth = Sig.BitWidth;
+        }
+      }
+
+      const std::string Grant = GName + "_grant";
+
+      S << Signal(GName+"_req", N, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+      S << Signal(Grant, SW, Signal::Local, Signal::Wire).getDefStr() << ";\n";
+
+      S << "assign " << GName << "_req = {";
+      for (unsigned CU = N; CU-- > 0; )
+        S << getCUName(ReqName, CU) << (CU ? ", " : "");
+      S << "};\n";
+
+      S << "rr_arbiter #(.N(" << N << "), .W(" << SW << ")) " << GName << "_arbiter(.clk(clk), .rst(rst), .req(" << GName << "_req), .grant(" << Grant << "));\n";
+
+      for (const Signal &Sig : G.second) {
+        const std::string &Name = Sig.Name;
+
+        if (Sig.Direction == Signal::Out) {
+          // Only the compute unit receiving the response acknowledges it
+          if (Name == GName + "_ack") {
+            S << "assign " << Name << " = ";
+            for (unsigned CU = 0; CU < N; ++CU)
+              S << getCUName(Name, CU) << (CU+1 < N ? " | " : ";\n");
+            continue;
+          }
+
+          std::stringstream Mux;
+          for (unsigned CU = 0; CU+1 < N; ++CU)
+            Mux << "(" << Grant << " == " << CU << ") ? " << getCUName(Name, CU) << " : ";
+          Mux << getCUName(Name, N-1);
+
+          if (TagNames.count(Name))
+            S << "assign " << Name << " = {" << Grant << ", " << Mux.str() << "};\n";
+          else
+            S << "assign " << Name << " = " << Mux.str() << ";\n";
+
+          continue;
+        }
+
+        for (unsigned CU = 0; CU < N; ++CU) {
+          const std::string CUName = getCUName(Name, CU);
+
+          if (TagNames.count(Name))
+            S << "assign " << CUName << " = " << Name << "[" << TagWidth-1 << ":0];\n";
+          else if (!TagName.empty() && Name == GName + "_unbuf_valid")
+            // Tagged responses return to the compute unit of the request
+            S << "assign " << CUName << " = " << Name << " && " << TagName << "[" << TagWidth+SW-1 << ":" << TagWidth << "] == " << CU << ";\n";
+          else if (ends_with_ctrl(Name))
+            S << "assign " << CUName << " = " << Name << " && " << Grant << " == " << CU << ";\n";
+          else
+            S << "assign " << CUName << " = " << Name << ";\n";
+        }
+      }
+    }
+  }
+
+  S << "endmodule " << " // " << getInstModuleName() << "\n";
+
+  return S.str();
+}
+
+/// The Blocks of a Kernel form a dataflow pipeline, so its throughput is
+/// limited by the Block with the largest interval between two work-items.
+/// Blocks with memory accesses wait for the memory in addition to their
+/// schedule.
+void KernelModule::genTimingReport() const {
+  const std::string FileName = Comp.getName() + ".timing.json";
+
+  FileTy F = openFile(FileName);
+
+  const unsigned CUs = getNumComputeUnits(Comp);
+  const unsigned Frequency = flopoco::getFrequency();
+
+  unsigned Latency = 0;
+  unsigned Interval = 1;
+  unsigned Loads = 0;
+  unsigned Stores = 0;
+  std::string Bottleneck;
+
+  for (const BlockTimingTy &T : BlockTimings) {
+    unsigned BlockInterval = getBlockInterval(T);
+    unsigned BlockLatency = T.Latency;
+
+    if (T.Loads || T.Stores)
+      BlockLatency += getMemLatency();
+
+    Latency += BlockLatency;
+    Loads += T.Loads;
+    Stores += T.Stores;
+
+    if (BlockInterval > Interval || Bottleneck.empty()) {
+      Interval = std::max(Interval, BlockInterval);
+      Bottleneck = T.Name;
+    }
+  }
+
+  const double WorkItemsPerSecond = Frequency * 1e6 * CUs / Interval;
+
+  std::stringstream S;
+  unsigned II = 0;
+
+  S << "{\n";
+  II++;
+  S << Indent(II) << "\"kernel\": \"" << Comp.getName() << "\",\n";
+  S << Indent(II) << "\"frequency_mhz\": " << Frequency << ",\n";
+  S << Indent(II) << "\"compute_units\": " << CUs << ",\n";
+  S << Indent(II) << "\"memory_latency\": " << getMemLatency() << ",\n";
+  S << Indent(II) << "\"loads_per_work_item\": " << Loads << ",\n";
+  S << Indent(II) << "\"stores_per_work_item\": " << Stores << ",\n";
+  S << Indent(II) << "\"latency\": " << Latency << ",\n";
+  S << Indent(II) << "\"initiation_interval\": " << Interval << ",\n";
+  S << Indent(II) << "\"bottleneck\": \"" << Bottleneck << "\",\n";
+
+  std::string WIS;
+  raw_string_ostream WISS(WIS);
+  WISS << format("%.1f", WorkItemsPerSecond);
+  S << Indent(II) << "\"work_items_per_second\": " << WISS.str() << ",\n";
+
+  S << Indent(II) << "\"blocks\": [\n";
+  II++;
+  for (unsigned b = 0, be = BlockTimings.size(); b < be; ++b) {
+    const BlockTimingTy &T = BlockTimings[b];
+
+    S << Indent(II) << "{\n";
+    II++;
+    S << Indent(II) << "\"name\": \"" << T.Name << "\",\n";
+    S << Indent(II) << "\"latency\": " << T.Latency << ",\n";
+    S << Indent(II) << "\"initiation_interval\": " << T.InitiationInterval << ",\n";
+    S << Indent(II) << "\"pipelined\": " << (T.Pipelined ? "true" : "false") << ",\n";
+    S << Indent(II) << "\"loads\": " << T.Loads << ",\n";
+    S << Indent(II) << "\"stores\": " << T.Stores << ",\n";
+    S << Indent(II) << "\"operations\": [";
+
+    std::string Prefix = "\n";
+    for (const BlockTimingTy::OpTimingTy &O : T.Ops) {
+      S << Prefix << Indent(II+1) << "{\"name\": \"" << O.Name << "\", \"operator\": \"" << O.Operator << "\", \"start\": " << O.Start << ", \"latency\": " << O.Latency << "}";
+      Prefix = ",\n";
+    }
+    if (!T.Ops.empty())
+      S << "\n" << Indent(II);
+    S << "]\n";
+    II--;
+    S << Indent(II) << "}" << (b+1 < be ? "," : "") << "\n";
+  }
+  II--;
+  S << Indent(II) << "]\n";
+  S << "}\n";
+
+  (*F) << S.str();
+  F->close();
+
+  ODEBUG(Comp.getName() << ": " << WISS.str() << " work-items/s, limited by " << Bottleneck);
+}
@@ -1,12 +1,29 @@
 #ifndef KERNELMODULE_H
 #define KERNELMODULE_H
 
+#include <vector>
+
 #include "VerilogModule.h"
+#include "BlockModule.h"
 
 namespace oclacc {
 
 class Kernel;
 
+/// \brief Number of compute units of \p K set by -oclacc-cu or
+/// -oclacc-cu-kernel.
+unsigned getNumComputeUnits(const Kernel &K);
+
+/// \brief Write the round-robin arbiter used by compute units once.
+///
+/// \return the filename
+const std::string defineArbiter();
+
+/// \brief Write the FIFO buffering values passed between Blocks once.
+///
+/// \return the filename
+const std::string defineBlockFifo();
+
 /// \brief Implementation of Kernel Function
 class KernelModule : public VerilogModule{
   public:
@@ -14,12 +31,52 @@ class KernelModule : public VerilogModule{
 
     virtual const std::string declHeader() const;
 
+    /// \brief Wires connecting the Blocks' ports.
+    ///
+    /// Must be called after all Blocks are scheduled, as the depth of the
+    /// FIFOs between Blocks depends on their timing.
     const std::string declBlockWires() const;
 
+    /// \brief True if any pair of Blocks is connected by a FIFO.
+    bool hasBlockFifos() const;
+
     const std::string instBlocks() const;
 
+    /// \brief Wrapper replicating the Kernel getNumComputeUnits() times.
+    ///
+    /// A dispatcher hands out the work-items arriving at the pipelined
+    /// inputs round-robin. Kernels using local memory or barriers are
+    /// dispatched by work-groups. Shared StreamPorts are arbitrated.
+    const std::string declComputeUnits() const;
+
+    /// \brief Name of the module to instantiate for the Kernel
+    const std::string getInstModuleName() const;
+
+    inline void addBlockTiming(const BlockTimingTy &T) {
+      BlockTimings.push_back(T);
+    }
+
+    /// \brief Write the static timing estimate of all Blocks and the
+    /// expected throughput to <Kernel>.timing.json.
+    void genTimingReport() const;
+
   private:
     Kernel &Comp;
+
+    std::vector<BlockTimingTy> BlockTimings;
+
+    const BlockTimingTy &getBlockTiming(const Block &) const;
+
+    /// \brief True if the output \p Src is passed to \p Sink through a FIFO.
+    ///
+    /// FIFOs are used for ports with a single source and a single sink in
+    /// different Blocks. Multiplexed and back-edge ports keep the handshake.
+    bool isFifoEdge(const ScalarPort &Src, const ScalarPort &Sink) const;
+
+    /// \brief Number of work-items the FIFO from \p Src to \p Sink holds.
+    unsigned getFifoDepth(const ScalarPort &Src, const ScalarPort &Sink) const;
+
+    const std::string declBlockFifo(const ScalarPort &Src, const ScalarPort &Sink) const;
 };
 
 } // end ns oclacc
@@ -0,0 +1,79 @@
+#include <map>
+
+#include "llvm/Support/CommandLine.h"
+
+#include "LoadUnit.h"
+#include "Burst.h"
+#include "Coalescer.h"
+#include "Macros.h"
+
+#include "HW/Kernel.h"
+#include "HW/Port.h"
+
+#define DEBUG_TYPE "loadunit"
+
+using namespace oclacc;
+using namespace llvm;
+
+static cl::opt<unsigned> LoadOutstanding("load-outstanding", cl::init(4), cl::desc("Number of requests a load unit keeps in flight per stream. 0 disables load units.") );
+
+const LoadUnitListTy oclacc::getLoadUnits(const Block &B) {
+  LoadUnitListTy Units;
+
+  if (LoadOutstanding == 0)
+    return Units;
+
+  const BurstListTy Bursts = getLoadBursts(B);
+  const CoalescerListTy Coalescers = getCoalescers(B);
+
+  std::vector<streamport_p> Streams;
+  std::map<streamport_p, std::vector<loadaccess_p> > Loads;
+
+  for (loadaccess_p L : B.getLoads()) {
+    streamport_p S = L->getStream();
+
+    // Local memory is accessed through BRAMs
+    if (S->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
+    if (findBurst(Bursts, *L) || findCoalescer(Coalescers, *L))
+      continue;
+
+    if (Loads.find(S) == Loads.end())
+      Streams.push_back(S);
+
+    Loads[S].push_back(L);
+  }
+
+  for (streamport_p S : Streams) {
+    if (Loads[S].size() < 2)
+      continue;
+
+    LoadUnitTy U;
+    U.Name = S->getName() + "_" + B.getUniqueName() + "_lu";
+    U.Stream = S;
+    U.Loads = Loads[S];
+    U.Outstanding = LoadOutstanding;
+
+    ODEBUG(U.Name << ": " << U.Loads.size() << " loads, " << U.Outstanding << " outstanding");
+
+    Units.push_back(U);
+  }
+
+  return Units;
+}
+
+const LoadUnitTy *oclacc::findLoadUnit(const LoadUnitListTy &Units, const StreamAccess &A) {
+  for (const LoadUnitTy &U : Units) {
+    for (loadaccess_p L : U.Loads) {
+      if (L.get() == &A)
+        return &U;
+    }
+  }
+
+  return nullptr;
+}
+
+#ifdef DEBUG_TYPE
+#undef DEBUG_TYPE
+#endif
@@ -0,0 +1,56 @@
+#ifndef LOADUNIT_H
+#define LOADUNIT_H
+
+#include <string>
+#include <vector>
+
+#include "HW/typedefs.h"
+
+namespace oclacc {
+
+class Block;
+class StreamAccess;
+
+/// \brief Loads of a Block from the same StreamPort sharing a load unit
+///
+/// The unit issues the requests of its loads in program order as soon as
+/// their addresses are ready. Up to Outstanding requests are in flight,
+/// each identified by a tag. Responses may return out of order and are
+/// written to a reorder buffer indexed by the tag, from which they retire
+/// in request order into the buffers of the loads.
+struct LoadUnitTy {
+  std::string Name;
+  streamport_p Stream;
+
+  /// Program order of the Block
+  std::vector<loadaccess_p> Loads;
+
+  unsigned Outstanding;
+
+  inline unsigned getTagWidth() const {
+    unsigned W = 1;
+    while ((1u << W) < Outstanding)
+      W++;
+    return W;
+  }
+
+  inline unsigned getSelWidth() const {
+    unsigned W = 1;
+    while ((1u << W) < Loads.size())
+      W++;
+    return W;
+  }
+};
+
+typedef std::vector<LoadUnitTy> LoadUnitListTy;
+
+/// \brief Load units of \p B for all global StreamPorts with at least two
+/// loads that are not part of a burst or coalescer.
+const LoadUnitListTy getLoadUnits(const Block &B);
+
+/// \brief Return the load unit containing \p A or nullptr.
+const LoadUnitTy *findLoadUnit(const LoadUnitListTy &Units, const StreamAccess &A);
+
+} // end ns oclacc
+
+#endif /* LOADUNIT_H */
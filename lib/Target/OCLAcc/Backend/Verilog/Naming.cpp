@@ -1,5 +1,6 @@
 #include <sstream>
 #include <cmath>
+#include <map>
 
 #include "llvm/Support/ErrorHandling.h"
 
@@ -15,6 +16,7 @@ using namespace oclacc;
 
 extern Signal Clk;
 extern Signal Rst;
+extern Signal Start;
 
 const std::string oclacc::getOpName(const base_p P) {
   if (const_p SI = std::dynamic_pointer_cast<ConstVal>(P)) {
@@ -60,6 +62,13 @@ const Signal::SignalListTy oclacc::getSignals(const DesignUnit &R) {
   L.push_back(Clk);
   L.push_back(Rst);
 
+  for (kernel_p K : R.getKernels()) {
+    if (hasCoalescers(*K)) {
+      L.push_back(Start);
+      break;
+    }
+  }
+
   // Only global memory access results in a port. Local memory is handled inside
   // of the DesignUnit.
   bool GlobalMem = false;
@@ -102,7 +111,31 @@ const Signal::SignalListTy oclacc::getSignals(const Block &R) {
     const Signal::SignalListTy SISC = getInSignals(P);
     L.insert(std::end(L),std::begin(SISC), std::end(SISC)); 
   }
+  // Accesses grouped to a burst share the signals of the burst
+  const BurstListTy LoadBursts = getLoadBursts(R);
+  for (const BurstTy &B : LoadBursts) {
+    const Signal::SignalListTy SIST = getSignals(B);
+    L.insert(std::end(L),std::begin(SIST), std::end(SIST)); 
+  }
+
+  const LoadUnitListTy LoadUnits = getLoadUnits(R);
+  for (const LoadUnitTy &U : LoadUnits) {
+    const Signal::SignalListTy SIST = getSignals(U);
+    L.insert(std::end(L),std::begin(SIST), std::end(SIST)); 
+  }
+
+  const CoalescerListTy Coalescers = getCoalescers(R);
+  if (!Coalescers.empty())
+    L.push_back(Start);
+  for (const CoalescerTy &C : Coalescers) {
+    const Signal::SignalListTy SIST = getSignals(C);
+    L.insert(std::end(L),std::begin(SIST), std::end(SIST)); 
+  }
+
   for (const loadaccess_p P : R.getLoads()) {
+    if (findBurst(LoadBursts, *P) || findLoadUnit(LoadUnits, *P) || findCoalescer(Coalescers, *P))
+      continue;
+
     const Signal::SignalListTy SIST = getSignals(P);
     L.insert(std::end(L),std::begin(SIST), std::end(SIST)); 
   }
@@ -113,7 +146,16 @@ const Signal::SignalListTy oclacc::getSignals(const Block &R) {
     L.insert(std::end(L),std::begin(SOSC), std::end(SOSC)); 
   }
 
+  const BurstListTy StoreBursts = getStoreBursts(R);
+  for (const BurstTy &B : StoreBursts) {
+    const Signal::SignalListTy SOST = getSignals(B);
+    L.insert(std::end(L),std::begin(SOST), std::end(SOST)); 
+  }
+
   for (const storeaccess_p P : R.getStores()) {
+    if (findBurst(StoreBursts, *P))
+      continue;
+
     const Signal::SignalListTy SOST = getSignals(P);
     L.insert(std::end(L),std::begin(SOST), std::end(SOST)); 
   }
@@ -133,6 +175,8 @@ const Signal::SignalListTy oclacc::getSignals(const Kernel &R) {
 
   L.push_back(Clk);
   L.push_back(Rst);
+  if (hasCoalescers(R))
+    L.push_back(Start);
   
   // Scalars
   for (const scalarport_p P : R.getInScalars()) {
@@ -144,8 +188,11 @@ const Signal::SignalListTy oclacc::getSignals(const Kernel &R) {
     const Signal::SignalListTy SOSC = getOutSignals(P);
     L.insert(std::end(L),std::begin(SOSC), std::end(SOSC)); 
   }
-  // Streams
+  // Streams, local memory is implemented inside of the Kernel
   for (const streamport_p P : R.getStreams()) {
+    if (P->getAddressSpace() == ocl::AS_LOCAL)
+      continue;
+
     const Signal::SignalListTy SIST = getSignals(P);
     L.insert(std::end(L),std::begin(SIST), std::end(SIST)); 
   }
@@ -194,11 +241,63 @@ const Signal::SignalListTy oclacc::getInMuxSignals(const ScalarPort &Sink, const
 const Signal::SignalListTy oclacc::getSignals(const StreamPort &P) {
   Signal::SignalListTy L;
 
-  const std::string PName = getOpName(P);
+  for (const SignalGroupTy &G : getSignalGroups(P))
+    L.insert(std::end(L), std::begin(G.second), std::end(G.second));
+
+  return L;
+}
+
+const SignalGroupListTy oclacc::getSignalGroups(const StreamPort &P) {
+  SignalGroupListTy L;
+
+  // Signals of each burst and load unit are added once for its first access
+  std::map<const Block *, BurstListTy> LoadBursts;
+  std::map<const Block *, BurstListTy> StoreBursts;
+  std::map<const Block *, LoadUnitListTy> LoadUnits;
+  std::map<const Block *, CoalescerListTy> Coalescers;
 
   for (streamaccess_p S : P.getAccessList()) {
-    const Signal::SignalListTy Ports = getSignals(S);
-    L.insert(std::end(L), std::begin(Ports), std::end(Ports));
+    const block_p B = std::static_pointer_cast<Block>(S->getParent());
+
+    std::map<const Block *, BurstListTy> &Bursts = S->isLoad() ? LoadBursts : StoreBursts;
+
+    if (Bursts.find(B.get()) == Bursts.end())
+      Bursts[B.get()] = S->isLoad() ? getLoadBursts(*B) : getStoreBursts(*B);
+
+    const BurstListTy &BL = Bursts[B.get()];
+
+    const BurstTy *Burst = findBurst(BL, *S);
+
+    if (Burst) {
+      if (Burst->Accesses.front() == S)
+        L.push_back(std::make_pair(Burst->Name, getSignals(*Burst)));
+      continue;
+    }
+
+    if (S->isLoad()) {
+      if (LoadUnits.find(B.get()) == LoadUnits.end())
+        LoadUnits[B.get()] = getLoadUnits(*B);
+
+      const LoadUnitTy *Unit = findLoadUnit(LoadUnits[B.get()], *S);
+
+      if (Unit) {
+        if (Unit->Loads.front() == S)
+          L.push_back(std::make_pair(Unit->Name, getSignals(*Unit)));
+        continue;
+      }
+
+      if (Coalescers.find(B.get()) == Coalescers.end())
+        Coalescers[B.get()] = getCoalescers(*B);
+
+      const CoalescerTy *Coalescer = findCoalescer(Coalescers[B.get()], *S);
+
+      if (Coalescer) {
+        L.push_back(std::make_pair(Coalescer->Name, getSignals(*Coalescer)));
+        continue;
+      }
+    }
+
+    L.push_back(std::make_pair(getOpName(*S), getSignals(S)));
   }
 
   return L;
@@ -262,6 +361,71 @@ const Signal::SignalListTy oclacc::getSignals(const StoreAccess &R) {
   return L;
 }
 
+const Signal::SignalListTy oclacc::getSignals(const BurstTy &R) {
+  Signal::SignalListTy L;
+
+  unsigned AddressWidth = 64;
+  unsigned DataWidth = R.getBusBits();
+  unsigned CountWidth = std::ceil(std::log2(R.Beats+1));
+
+  const std::string PName = R.Name;
+
+  if (R.Accesses.front()->isLoad()) {
+    L.push_back(Signal(PName+"_address", AddressWidth, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_burstcount", CountWidth, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_address_valid", 1, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_unbuf", DataWidth, Signal::In, Signal::Wire));
+    L.push_back(Signal(PName+"_unbuf_valid", 1, Signal::In, Signal::Wire));
+    L.push_back(Signal(PName+"_ack", 1, Signal::Out, Signal::Reg));
+  } else {
+    L.push_back(Signal(PName+"_address", AddressWidth, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_burstcount", CountWidth, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_buf", DataWidth, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_valid", 1, Signal::Out, Signal::Reg));
+    L.push_back(Signal(PName+"_ack", 1, Signal::In, Signal::Wire));
+  }
+
+  return L;
+}
+
+const Signal::SignalListTy oclacc::getSignals(const LoadUnitTy &R) {
+  Signal::SignalListTy L;
+
+  unsigned AddressWidth = 64;
+  unsigned DataWidth = R.Stream->getBitWidth();
+  unsigned TagWidth = R.getTagWidth();
+
+  const std::string PName = R.Name;
+
+  L.push_back(Signal(PName+"_address", AddressWidth, Signal::Out, Signal::Reg));
+  L.push_back(Signal(PName+"_address_tag", TagWidth, Signal::Out, Signal::Reg));
+  L.push_back(Signal(PName+"_address_valid", 1, Signal::Out, Signal::Reg));
+  L.push_back(Signal(PName+"_address_ready", 1, Signal::In, Signal::Wire));
+  L.push_back(Signal(PName+"_unbuf", DataWidth, Signal::In, Signal::Wire));
+  L.push_back(Signal(PName+"_unbuf_tag", TagWidth, Signal::In, Signal::Wire));
+  L.push_back(Signal(PName+"_unbuf_valid", 1, Signal::In, Signal::Wire));
+  L.push_back(Signal(PName+"_ack", 1, Signal::Out, Signal::Reg));
+
+  return L;
+}
+
+const Signal::SignalListTy oclacc::getSignals(const CoalescerTy &R) {
+  Signal::SignalListTy L;
+
+  unsigned AddressWidth = 64;
+  unsigned DataWidth = R.getLineBits();
+
+  const std::string PName = R.Name;
+
+  L.push_back(Signal(PName+"_address", AddressWidth, Signal::Out, Signal::Reg));
+  L.push_back(Signal(PName+"_address_valid", 1, Signal::Out, Signal::Reg));
+  L.push_back(Signal(PName+"_unbuf", DataWidth, Signal::In, Signal::Wire));
+  L.push_back(Signal(PName+"_unbuf_valid", 1, Signal::In, Signal::Wire));
+  L.push_back(Signal(PName+"_ack", 1, Signal::Out, Signal::Reg));
+
+  return L;
+}
+
 const Signal::SignalListTy oclacc::getSignals(const Barrier &R) {
   Signal::SignalListTy L;
 
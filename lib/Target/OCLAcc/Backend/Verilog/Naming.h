@@ -3,6 +3,9 @@
 
 
 #include "Signal.h"
+#include "Burst.h"
+#include "LoadUnit.h"
+#include "Coalescer.h"
 #include "HW/Port.h"
 #include "../../HW/typedefs.h"
 
@@ -47,6 +50,16 @@ inline const Signal::SignalListTy getSignals(const streamport_p P) {
   return getSignals(*P);
 }
 
+/// \brief Signals of a StreamPort grouped by the single access, burst, load
+/// unit or coalescer they belong to, identified by its name.
+typedef std::pair<std::string, Signal::SignalListTy> SignalGroupTy;
+typedef std::vector<SignalGroupTy> SignalGroupListTy;
+
+const SignalGroupListTy getSignalGroups(const StreamPort &);
+inline const SignalGroupListTy getSignalGroups(const streamport_p P) {
+  return getSignalGroups(*P);
+}
+
 
 const std::string createPortList(const Signal::SignalListTy &);
 
@@ -78,6 +91,15 @@ inline const Signal::SignalListTy getSignals(const storeaccess_p P) {
   return getSignals(*P);
 }
 
+/// \brief Signals of a burst replacing the signals of its accesses
+const Signal::SignalListTy getSignals(const BurstTy &);
+
+/// \brief Signals of a load unit replacing the signals of its loads
+const Signal::SignalListTy getSignals(const LoadUnitTy &);
+
+/// \brief Signals of a coalescer replacing the signals of its load
+const Signal::SignalListTy getSignals(const CoalescerTy &);
+
 // Used for delegation
 inline const Signal::SignalListTy getSignals(const StreamAccess &R) {
   if (R.isLoad()) return getSignals(static_cast<const LoadAccess &>(R));
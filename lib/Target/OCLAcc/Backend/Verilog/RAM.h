@@ -4,55 +4,60 @@
 #include "VerilogMacros.h"
 
 #include <sstream>
-#include <cmath>
+#include <string>
 
 namespace oclacc {
 
-/// \brief BlockRAM with \param Size in bytes
+/// \brief BlockRAM with \param Length words of \param BitWidth bits
 ///
-/// We need no definition because we use an IP block.
+/// Port A and B are both read/write ports of the same clock domain. The
+/// definition is the inferable module in IP/bram.v.
 class BRamImpl {
   private:
     unsigned BitWidth;
-    unsigned Size;
+    unsigned Length;
     std::string InstName;
 
   public:
-    BRAM(std::string Name, unsigned Size) : BitWidht(S->getBitWidth()), Size(Size), InstName(Name) {
+    BRamImpl(const std::string &Name, unsigned BitWidth, unsigned Length) : BitWidth(BitWidth), Length(Length), InstName(Name) {
     }
 
-    std::string instantiate() {
-      std::stringstream S;
-
-      // Calc Address wisth and round up if size is not a power of 2.
-      unsigned AddrWidth = log2(Size / BitWdith);
-      if (pow(2,AddrWidth) < Size) 
+    /// \brief Address width, rounded up if Length is not a power of 2.
+    unsigned getAddrWidth() const {
+      unsigned AddrWidth = 1;
+      while ((1ull << AddrWidth) < Length)
         AddrWidth++;
 
+      return AddrWidth;
+    }
+
+    std::string instantiate() const {
+      std::stringstream S;
+
       S << "bram #(\n";
-      S << I(1) << "DATA(" << BitWidth << "),\n";
-      S << I(1) << "ADDR(" << AddrWidth << ")\n";
-      S << ")" << InstName << "(\n";
+      S << I(1) << ".DATA(" << BitWidth << "),\n";
+      S << I(1) << ".ADDR(" << getAddrWidth() << ")\n";
+      S << ") " << InstName << "(\n";
 
       S << I(1) << "// Port A\n";
-      S << I(1) << "a_clk(clk)\n";
-      S << I(1) << "a_wr(" << InstName << "_a_wr),\n";
-      S << I(1) << "a_addr(" << InstName << "_a_addr),\n";
-      S << I(1) << "a_din(" << InstName << "_a_din),\n";
-      S << I(1) << "a_dout(" << InstName << "_a_dout),\n";
-
-      S << I(1)  << "// Port B\n";
-      S << I(1) << "b_clk(" << InstName << "clk),\n";
-      S << I(1) << "b_wr(" << InstName << "_b_wr),\n";
-      S << I(1) << "b_addr(" << InstName << "_b_addr),\n";
-      S << I(1) << "b_din(" << InstName << "_b_din),\n";
-      S << I(1) << "b_dout(" << InstName << "_b_dout)\n";
+      S << I(1) << ".a_clk(clk),\n";
+      S << I(1) << ".a_wr(" << InstName << "_a_wr),\n";
+      S << I(1) << ".a_addr(" << InstName << "_a_addr),\n";
+      S << I(1) << ".a_din(" << InstName << "_a_din),\n";
+      S << I(1) << ".a_dout(" << InstName << "_a_dout),\n";
+
+      S << I(1) << "// Port B\n";
+      S << I(1) << ".b_clk(clk),\n";
+      S << I(1) << ".b_wr(" << InstName << "_b_wr),\n";
+      S << I(1) << ".b_addr(" << InstName << "_b_addr),\n";
+      S << I(1) << ".b_din(" << InstName << "_b_din),\n";
+      S << I(1) << ".b_dout(" << InstName << "_b_dout)\n";
       S << ");\n";
 
       return S.str();
     }
 
-    std::string define() {
+    static std::string define() {
       std::string R = R"BLOCK(
 // http://danstrother.com/2010/09/11/inferring-rams-in-fpgas/
 // A parameterized, inferable, true dual-port, dual-clock block RAM in Verilog.
@@ -97,22 +102,9 @@ always @(posedge b_clk) begin
     end
 end
 
-endmodule)BLOCK"
-    return R;
-}
-
-/// \brief Instantiate BlockRAM and a frontent queue to support read/write
-/// synchronization for multiple access to a limited number of ports.
-///
-class BRam {
-  public:
-    BRam(streamport_p S) {
-    }
-
-    std::string instantiate() {
-      std::stringstream S;
-
-      return S.str();
+endmodule
+)BLOCK";
+      return R;
     }
 };
 
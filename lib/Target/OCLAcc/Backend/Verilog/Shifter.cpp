@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "Shifter.h"
+#include "Utils.h"
+#include "VerilogMacros.h"
+
+using namespace oclacc;
+using namespace llvm;
+
+static cl::opt<unsigned> ShifterLevels("shifter-levels", cl::init(2), cl::desc("Levels of the pipelined barrel shifters computed per clock cycle.") );
+
+namespace {
+
+unsigned getLevelsPerStage() {
+  if (ShifterLevels == 0)
+    report_fatal_error("-shifter-levels must be at least 1");
+
+  return ShifterLevels;
+}
+
+} // end anonymous ns
+
+ip::ShifterImpl::ShifterImpl(unsigned BitWidth, KindTy Kind) : BitWidth(std::max(2u, BitWidth)), Kind(Kind) {
+}
+
+unsigned ip::ShifterImpl::getAmountWidth() const {
+  unsigned L = 0;
+  while ((1u << L) < BitWidth)
+    L++;
+
+  return L;
+}
+
+const std::string ip::ShifterImpl::getName() const {
+  std::string K;
+  switch (Kind) {
+    case Left: K = "shl"; break;
+    case LogicalRight: K = "lshr"; break;
+    case ArithmeticRight: K = "ashr"; break;
+  }
+
+  return "Shift_" + K + "_" + std::to_string(BitWidth) + "_l" + std::to_string(getLevelsPerStage());
+}
+
+unsigned ip::ShifterImpl::getLatency() const {
+  const unsigned C = getLevelsPerStage();
+  return (getAmountWidth() + C - 1) / C;
+}
+
+const std::string ip::ShifterImpl::define() const {
+  const std::string Name = getName();
+  const std::string Filename = Name + ".v";
+
+  static std::set<std::string> Written;
+  if (Written.count(Name))
+    return Filename;
+
+  const unsigned N = BitWidth;
+  const unsigned L = getAmountWidth();
+  const unsigned C = getLevelsPerStage();
+
+  std::string Shift;
+  switch (Kind) {
+    case Left: Shift = "val_w[l] << (1 << l)"; break;
+    case LogicalRight: Shift = "val_w[l] >> (1 << l)"; break;
+    case ArithmeticRight: Shift = "$signed(val_w[l]) >>> (1 << l)"; break;
+  }
+
+  std::stringstream D;
+  unsigned II = 0;
+
+  D << "// Pipelined barrel shifter, latency " << getLatency() << "\n";
+  D << "module " << Name << "(\n";
+  D << Indent(1) << "input clk,\n";
+  D << Indent(1) << "input rst,\n";
+  D << Indent(1) << "input [" << N-1 << ":0] X,\n";
+  D << Indent(1) << "input [" << L-1 << ":0] S,\n";
+  D << Indent(1) << "output [" << N-1 << ":0] R\n";
+  D << ");\n\n";
+
+  // Value and remaining shift amount after each level
+  D << "wire [" << N-1 << ":0] val_w [0:" << L << "];\n";
+  D << "wire [" << L-1 << ":0] amt_w [0:" << L << "];\n\n";
+
+  D << "assign val_w[0] = X;\n";
+  D << "assign amt_w[0] = S;\n\n";
+
+  D << "genvar l;\n";
+  D << "generate\n";
+  D << "for (l = 0; l < " << L << "; l = l + 1)\n";
+  D << Indent(++II) << "begin : level\n";
+  // Separate wire, so the selection does not make the arithmetic shift
+  // unsigned
+  D << Indent(II) << "wire [" << N-1 << ":0] shifted_by = " << Shift << ";\n";
+  D << Indent(II) << "wire [" << N-1 << ":0] shifted = amt_w[l][l] ? shifted_by : val_w[l];\n\n";
+
+  // Register after every C levels and after the last
+  D << Indent(II) << "if ((l + 1) % " << C << " == 0 || l == " << L-1 << ")\n";
+  D << Indent(++II) << "begin : stage\n";
+  D << Indent(II) << "reg [" << N-1 << ":0] val_r;\n";
+  D << Indent(II) << "reg [" << L-1 << ":0] amt_r;\n\n";
+  D << Indent(II) << "always @(posedge clk)\n";
+  BEGIN(D);
+  D << Indent(II) << "val_r <= shifted;\n";
+  D << Indent(II) << "amt_r <= amt_w[l];\n";
+  END(D);
+  D << "\n";
+  D << Indent(II) << "assign val_w[l+1] = val_r;\n";
+  D << Indent(II) << "assign amt_w[l+1] = amt_r;\n";
+  END(D);
+  D << Indent(II) << "else\n";
+  D << Indent(++II) << "begin : comb\n";
+  D << Indent(II) << "assign val_w[l+1] = shifted;\n";
+  D << Indent(II) << "assign amt_w[l+1] = amt_w[l];\n";
+  END(D);
+  END(D);
+  D << "endgenerate\n\n";
+
+  D << "assign R = val_w[" << L << "];\n\n";
+  D << "endmodule\n";
+
+  FileTy FS = openFile(Filename);
+  (*FS) << D.str();
+  FS->close();
+
+  Written.insert(Name);
+
+  return Filename;
+}
@@ -0,0 +1,50 @@
+#ifndef SHIFTER_H
+#define SHIFTER_H
+
+#include <string>
+
+namespace oclacc {
+namespace ip {
+
+/// \brief Pipelined barrel shifter shifting X with \p BitWidth bits by S.
+///
+/// Level l shifts by 2^l if bit l of S is set. -shifter-levels levels are
+/// computed per pipeline stage, so the latency is known in advance. Bits of
+/// S above log2(BitWidth) are ignored. BitWidth may be narrower than the IR
+/// type, so the user replaces X by its fill value if any of them is set.
+class ShifterImpl {
+  public:
+    enum KindTy {
+      Left,
+      LogicalRight,
+      ArithmeticRight
+    };
+
+  private:
+    unsigned BitWidth;
+    KindTy Kind;
+
+  public:
+    ShifterImpl(unsigned BitWidth, KindTy Kind);
+
+    inline unsigned getBitWidth() const {
+      return BitWidth;
+    }
+
+    /// \brief Width of the shift amount S.
+    unsigned getAmountWidth() const;
+
+    const std::string getName() const;
+
+    unsigned getLatency() const;
+
+    /// \brief Write the module to its own file once.
+    ///
+    /// \return the filename
+    const std::string define() const;
+};
+
+} // end ns ip
+} // end ns oclacc
+
+#endif /* SHIFTER_H */
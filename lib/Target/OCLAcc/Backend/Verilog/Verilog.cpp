@@ -1,3 +1,4 @@
+#include "llvm/ADT/APInt.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/ErrorHandling.h"
 
@@ -24,6 +25,8 @@
 #include "DesignFiles.h"
 #include "Flopoco.h"
 #include "BramArbiter.h"
+#include "Divider.h"
+#include "Shifter.h"
 
 
 #define DEBUG_TYPE "verilog"
@@ -41,6 +44,8 @@ OperatorInstances TheOps;
 
 Signal Clk("clk", 1, Signal::In, Signal::Wire);
 Signal Rst("rst", 1, Signal::In, Signal::Wire);
+// Set by the host for a single cycle when it launches an NDRange
+Signal Start("start", 1, Signal::In, Signal::Wire);
 
 
 
@@ -90,8 +95,9 @@ int Verilog::visit(DesignUnit &R) {
   for (kernel_p K : R.getKernels()) {
     Signal::SignalListTy Ports = getSignals(K);
 
-    // Block instance name
-    SS << K->getName() << " " << K->getUniqueName() << "(\n";
+    // Kernel instance name, replicated Kernels are wrapped
+    const std::string KName = getNumComputeUnits(*K) > 1 ? K->getName() + "_cu" : K->getName();
+    SS << KName << " " << K->getUniqueName() << "(\n";
 
     Linebreak = "";
     for (const Signal &P : Ports) {
@@ -131,22 +137,43 @@ int Verilog::visit(Kernel &R) {
 
   (*FS) << KM->declHeader();
 
+  // Schedule the Blocks first, the connections between them depend on their
+  // timing.
+  super::visit(R);
+
   (*FS) << KM->declBlockWires();
 
   (*FS) << KM->instBlocks();
 
+  if (KM->hasBlockFifos())
+    KM->addFile(defineBlockFifo());
+
   // Local memory
   for (streamport_p P : R.getStreams()) {
-    if (P->getAddressSpace() == ocl::AS_LOCAL)
+    if (P->getAddressSpace() == ocl::AS_LOCAL) {
       (*FS) << ip::declBramArbiter(P);
+      KM->addFile(ip::defineBram());
+    }
   }
 
   (*FS) << KM->declFooter();
 
-  super::visit(R);
-
   FS->close();
 
+  KM->genTimingReport();
+
+  if (getNumComputeUnits(R) > 1) {
+    const std::string CUFilename = KM->getInstModuleName() + ".v";
+    FileTy CUFS = openFile(CUFilename);
+    KM->addFile(CUFilename);
+    KM->addFile(defineArbiter());
+
+    (*CUFS) << header();
+    (*CUFS) << KM->declComputeUnits();
+
+    CUFS->close();
+  }
+
   return 0;
 }
 
@@ -173,9 +200,18 @@ int Verilog::visit(Block &R) {
   // Write constant assignments
   (*FS) << BM->declConstValues();
 
+  // Inferred operators are registered depending on the chains they are part
+  // of, so decide before generating them.
+  BM->chainOperators();
+
   // Create instances for all operations
   super::visit(R);
 
+  // Determine critical path
+  BM->schedule(TheOps);
+  BM->genScheduleReport();
+  KM->addBlockTiming(BM->getTiming(TheOps));
+
   (*FS) << BM->declPortControlSignals();
 
   // Write signals
@@ -184,15 +220,15 @@ int Verilog::visit(Block &R) {
   // Write constant assignments
   (*FS) << BM->declConstSignals();
 
+  // Balance operands of pipelined Blocks
+  (*FS) << BM->declOperandDelays();
+
   // Write local operators
   (*FS) << BM->declLocalOperators();
 
   // Write assignments
   (*FS) << BM->declBlockAssignments();
 
-  // Determine critical path
-  BM->schedule(TheOps);
-
   // State Machine
   (*FS) << BM->declFSMSignals();
   (*FS) << BM->declFSM();
@@ -206,6 +242,8 @@ int Verilog::visit(Block &R) {
   // Write component instantiations
   (*FS) << BM->declBlockComponents();
 
+  (*FS) << BM->declSharedOperators();
+
   (*FS) << BM->declFooter();
 
   BM->genTestBench();
@@ -271,28 +309,126 @@ int Verilog::visit(DynamicStreamIndex &R) {
   return 0;
 }
 
-///  \brief Constant Shifts do not use a register
-void Verilog::handleConstShift(const Shl &R, uint64_t C) {
+/// \brief \p Op of \p W bits extended to \p N bits.
+static std::string getExtended(const std::string &Op, unsigned W, unsigned N, bool Signed) {
+  if (W == 0 || W >= N)
+    return Op;
+
+  if (Signed)
+    return "{{" + std::to_string(N-W) + "{" + Op + "[" + std::to_string(W-1) + "]}}, " + Op + "}";
+
+  return "{" + std::to_string(N-W) + "'b0, " + Op + "}";
+}
+
+/// \brief Shifts by a constant are wires.
+///
+/// The operand is extended to the result, so \p Op ">>>" fills in its sign.
+void Verilog::handleConstShift(const Arith &R, uint64_t C, const std::string Op) {
   std::stringstream &BS = BM->getBlockSignals();
   std::stringstream &LO = BM->getLocalOperators();
 
   const base_p In0 = R.getIn(0);
-  const std::string Op0 = getOpName(In0);
-  const std::string Res = getOpName(R);
+  std::string Op0 = BM->getOperandName(R, In0);
 
   const std::string RName = getOpName(R);
 
   Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
   BS << S.getDefStr() << ";\n";
 
-  uint64_t BitsOp = In0->getBitWidth();
-  uint64_t Start = BitsOp - 1;
-  if (BitsOp > C)
-    Start -= C;
+  if (Op == ">>>")
+    Op0 = "$signed(" + Op0 + ")";
 
-  LO << "assign " << Res << " = {{" << Op0 << "[" << Start << ":0]},{" << C << "{0}" << "}};\n";
+  LO << "assign " << RName << " = " << Op0 << " " << Op << " " << C << ";\n";
 }
 
+/// \brief Shift by a constant or by the pipelined barrel shifter.
+void Verilog::handleShift(const Arith &R, const std::string Op) {
+  std::stringstream &BS = BM->getBlockSignals();
+  std::stringstream &BC = BM->getBlockComponents();
+
+  assert(R.getIns().size() == 2);
+
+  const base_p In0 = R.getIn(0);
+  const base_p In1 = R.getIn(1);
+
+  if (const_p C = std::dynamic_pointer_cast<ConstVal>(In1)) {
+    handleConstShift(R, C->getAPInt(64).getLimitedValue(), Op);
+    return;
+  }
+
+  ip::ShifterImpl::KindTy Kind = ip::ShifterImpl::Left;
+  if (Op == ">>")
+    Kind = ip::ShifterImpl::LogicalRight;
+  else if (Op == ">>>")
+    Kind = ip::ShifterImpl::ArithmeticRight;
+
+  const unsigned N = std::max(R.getBitWidth(), In0->getBitWidth());
+
+  ip::ShifterImpl Shift(N, Kind);
+  const std::string Name = Shift.getName();
+  const unsigned Latency = Shift.getLatency();
+
+  const std::string FileName = Shift.define();
+  const BlockModule::FileListTy &Files = BM->getFiles();
+  if (std::find(Files.begin(), Files.end(), FileName) == Files.end())
+    BM->addFile(FileName);
+
+  const std::string RName = R.getUniqueName();
+
+  std::string X = getExtended(BM->getOperandName(R, In0), In0->getBitWidth(), Shift.getBitWidth(), Kind == ip::ShifterImpl::ArithmeticRight);
+
+  // Only the low bits of the amount are used by the shifter. The operands may
+  // be narrower than the IR type, so amounts with higher bits set are valid
+  // and shift out all bits of X. X is replaced by its fill value then, which
+  // any shift keeps.
+  const unsigned AW = Shift.getAmountWidth();
+  const unsigned SW = In1->getBitWidth();
+  std::string Amount = BM->getOperandName(R, In1);
+  if (SW > AW) {
+    const std::string XName = RName + "_x";
+    Signal SX(XName, Shift.getBitWidth(), Signal::Local, Signal::Wire);
+    BS << SX.getDefStr() << ";\n";
+
+    std::string Fill = "'0";
+    if (Kind == ip::ShifterImpl::ArithmeticRight)
+      Fill = "{" + std::to_string(Shift.getBitWidth()) + "{" + RName + "_x_in[" + std::to_string(Shift.getBitWidth()-1) + "]}}";
+
+    Signal SXI(XName + "_in", Shift.getBitWidth(), Signal::Local, Signal::Wire);
+    BS << SXI.getDefStr() << ";\n";
+
+    std::stringstream &LO = BM->getLocalOperators();
+    LO << "assign " << XName << "_in = " << X << ";\n";
+    LO << "assign " << XName << " = (|" << Amount << "[" << SW-1 << ":" << AW << "]) ? " << Fill << " : " << XName << "_in;\n";
+
+    X = XName;
+    Amount += "[" + std::to_string(AW-1) + ":0]";
+  } else
+    Amount = getExtended(Amount, SW, AW, false);
+
+  TheOps.addOperator(RName, Name, Latency);
+
+  if (BM->isSharedOperator(Name)) {
+    BM->addSharedOperator(R, Name, Latency, {
+        {"X", X, Shift.getBitWidth()},
+        {"S", Amount, AW}
+        }, "R");
+    return;
+  }
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BS << S.getDefStr() << ";\n";
+
+  // Instantiate component
+  BC << "// " << RName << "\n";
+  BC << Name << " " << Name << "_" << RName << "(\n";
+  BC << Indent(1) << ".clk(clk)," << "\n";
+  BC << Indent(1) << ".rst(rst)," << "\n";
+  BC << Indent(1) << ".X(" << X << ")," << "\n";
+  BC << Indent(1) << ".S(" << Amount << ")," << "\n";
+  BC << Indent(1) << ".R(" << RName << ")" << "\n";
+  BC << ");\n";
+}
 
 // The following methods create arithmetic cores. The block then instantiates
 // them and takes care of the critical path.
@@ -303,12 +439,22 @@ void Verilog::handleInferableMath(const Arith &R, const std::string Op) {
   std::stringstream &BS = BM->getBlockSignals();
   std::stringstream &LO = BM->getLocalOperators();
 
-  const std::string Op0 = getOpName(R.getIn(0));
-  const std::string Op1 = getOpName(R.getIn(1));
+  const std::string Op0 = BM->getOperandName(R, R.getIn(0));
+  const std::string Op1 = BM->getOperandName(R, R.getIn(1));
   const std::string Res = getOpName(R);
 
   const std::string RName = getOpName(R);
 
+  if (BM->isChained(R)) {
+    Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+    BS << S.getDefStr() << ";\n";
+
+    LO << "assign " << Res << " = " << Op0 << " " << Op << " " << Op1 << ";\n";
+
+    TheOps.addOperator(RName, RName, 0);
+    return;
+  }
+
   Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Reg);
   BS << S.getDefStr() << ";\n";
 
@@ -365,6 +511,115 @@ std::string addRegister(const std::string &RName, unsigned BitWidth, std::string
   return OutName;
 }
 
+/// \brief Multiply by a constant without a generic multiplier.
+///
+/// Constants with few nonzero signed digits are shifted additions, all
+/// others use FloPoCo's IntConstMult. Only the low bits of the product are
+/// used, so negative constants are multiplied by their two's complement.
+void Verilog::handleConstMult(const Mul &R, const_p C, const base_p VarOp) {
+  std::stringstream &BS = BM->getBlockSignals();
+  std::stringstream &BC = BM->getBlockComponents();
+  std::stringstream &LO = BM->getLocalOperators();
+
+  const std::string RName = R.getUniqueName();
+  const unsigned Bits = R.getBitWidth();
+
+  const unsigned N = std::max(Bits, VarOp->getBitWidth());
+  const std::string X = getExtended(BM->getOperandName(R, VarOp), VarOp->getBitWidth(), N, true);
+
+  const llvm::APInt CV = C->getAPInt(N);
+  const std::vector<int> Digits = flopoco::getNAF(CV);
+  const unsigned Terms = Digits.size() - std::count(Digits.begin(), Digits.end(), 0);
+
+  if (Terms <= flopoco::getShiftAddTerms()) {
+    std::stringstream E;
+
+    for (unsigned i = 0; i < Digits.size(); ++i) {
+      if (!Digits[i])
+        continue;
+
+      if (E.tellp() > 0)
+        E << (Digits[i] < 0 ? " - " : " + ");
+      else if (Digits[i] < 0)
+        E << "-";
+
+      E << "(" << X << " << " << i << ")";
+    }
+
+    if (Terms == 0)
+      E << N << "'b0";
+
+    // A single shift is a wire
+    if (Terms == 0 || (Terms == 1 && !CV.isNegative() && CV.isPowerOf2())) {
+      Signal S(RName, Bits, Signal::Local, Signal::Wire);
+      BS << S.getDefStr() << ";\n";
+
+      LO << "assign " << RName << " = " << E.str() << ";\n";
+      return;
+    }
+
+    Signal S(RName, Bits, Signal::Local, Signal::Reg);
+    BS << S.getDefStr() << ";\n";
+
+    unsigned II = 0;
+    LO << "always @(posedge clk)\n";
+    BEGIN(LO);
+    LO << Indent(II) << "if (rst==1)\n";
+      LO << Indent(II+1) << RName << " = '0;\n";
+
+    LO << Indent(II) << "else\n";
+      LO << Indent(II+1) << RName << " = " << E.str() << ";\n";
+    END(LO);
+
+    TheOps.addOperator(RName, RName, 1);
+    return;
+  }
+
+  std::string Name;
+  const std::string FInst = flopoco::getIntConstMult(R, CV, N, Name);
+
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+
+  const std::string ProdName = RName + "_prod";
+  Signal SP(ProdName, N + CV.getActiveBits(), Signal::Local, Signal::Wire);
+  BS << SP.getDefStr() << ";\n";
+
+  BC << "// " << RName << "\n";
+  BC << Name << " " << Name << "_" << RName << "(\n";
+  BC << Indent(1) << ".clk(clk)," << "\n";
+  BC << Indent(1) << ".rst(rst)," << "\n";
+  BC << Indent(1) << ".X(" << X << ")," << "\n";
+  BC << Indent(1) << ".R(" << ProdName << ")" << "\n";
+  BC << ");\n";
+
+  const std::string Low = ProdName + "[" + std::to_string(Bits-1) + ":0]";
+
+  // Combinational constant multipliers get an output register like Mul
+  if (Latency == 0) {
+    Signal S(RName, Bits, Signal::Local, Signal::Reg);
+    BS << S.getDefStr() << ";\n";
+
+    unsigned II = 0;
+    BC << "always @(posedge clk)\n";
+    BEGIN(BC);
+    BC << Indent(II) << "if (rst==1)\n";
+    BC << Indent(II+1) << RName << " = '0;\n";
+
+    BC << Indent(II) << "else\n";
+    BC << Indent(II+1) << RName << " = " << Low << ";\n";
+    END(BC);
+
+    Latency++;
+  } else {
+    Signal S(RName, Bits, Signal::Local, Signal::Wire);
+    BS << S.getDefStr() << ";\n";
+
+    LO << "assign " << RName << " = " << Low << ";\n";
+  }
+
+  TheOps.addOperator(RName, Name, Latency);
+}
+
 int Verilog::visit(Mul &R) {
   VISIT_ONCE(R);
   assert(R.getIns().size() == 2);
@@ -372,24 +627,33 @@ int Verilog::visit(Mul &R) {
   std::stringstream &BS = BM->getBlockSignals();
   std::stringstream &BC = BM->getBlockComponents();
 
-  const std::string WX = std::to_string(R.getIn(0)->getBitWidth());
-  const std::string WY = std::to_string(R.getIn(1)->getBitWidth());
-  const std::string WOut = std::to_string(R.getBitWidth());
+  const std::string RName = R.getUniqueName();
 
-  bool isSigned = true;
+  const_p In0 = std::dynamic_pointer_cast<ConstVal>(R.getIn(0));
+  const_p In1 = std::dynamic_pointer_cast<ConstVal>(R.getIn(1));
 
-  const std::string Name = "IntMultiplier_" + WX + "_" + WY + "_" + WOut;
+  if ((In0 || In1) && !(In0 && In1)) {
+    handleConstMult(R, In0 ? In0 : In1, In0 ? R.getIn(1) : R.getIn(0));
 
-  const std::string RName = R.getUniqueName();
+    super::visit(R);
+    return 0;
+  }
 
-  std::stringstream FInst;
+  std::string Name;
+  const std::string FInst = flopoco::getIntMultiplier(R, Name);
 
-  FInst << "IntMultiplier" << " wX=" << WX << " wY=" << WY << " WOut=" << WOut << " ";
-  FInst << "signedIO=" << conf::to_string(isSigned) << " ";
-  FInst << "name=" << Name << " ";
-  FInst << "outputFile=" << Name << ".vhd" << " ";
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
 
-  unsigned Latency = flopoco::genModule(Name, FInst.str(), *BM);
+  if (BM->isSharedOperator(Name)) {
+    TheOps.addOperator(RName, Name, Latency);
+    BM->addSharedOperator(R, Name, Latency, {
+        {"X", BM->getOperandName(R, R.getIn(0)), R.getIn(0)->getBitWidth()},
+        {"Y", BM->getOperandName(R, R.getIn(1)), R.getIn(1)->getBitWidth()}
+        }, "R");
+
+    super::visit(R);
+    return 0;
+  }
 
   // Latency is typically 0, so add a register to the output.
 
@@ -416,8 +680,8 @@ int Verilog::visit(Mul &R) {
   BC << Name << " " << Name << "_" << RName << "(\n";
   BC << Indent(1) << ".clk(clk)," << "\n";
   BC << Indent(1) << ".rst(rst)," << "\n";
-  BC << Indent(1) << ".X(" << getOpName(R.getIn(0)) << ")," << "\n";
-  BC << Indent(1) << ".Y(" << getOpName(R.getIn(1)) << ")," << "\n";
+  BC << Indent(1) << ".X(" << BM->getOperandName(R, R.getIn(0)) << ")," << "\n";
+  BC << Indent(1) << ".Y(" << BM->getOperandName(R, R.getIn(1)) << ")," << "\n";
   BC << Indent(1) << ".R(" << OutName << ")" << "\n";
   BC << ");\n";
 
@@ -435,28 +699,24 @@ int Verilog::visit(FAdd &R) {
   std::stringstream &BlockSignals = BM->getBlockSignals();
   std::stringstream &BlockComponents = BM->getBlockComponents();
 
-  const std::string isSub = "false";
-
-  const std::string dualPath = conf::to_string(conf::FPAdd_DualPath);
-
-  const std::string WE = std::to_string(R.getExponentBitWidth());
-  const std::string WF = std::to_string(R.getMantissaBitWidth());
-
-  const std::string Name = "FPAdd_" + WE + "_" + WF;
-
   const std::string RName = R.getUniqueName();
 
-  std::stringstream FInst;
+  std::string Name;
+  const std::string FInst = flopoco::getFPAdd(R, Name);
 
-  FInst << "FPAdd" << " wE=" << WE << " wF=" << WF << " ";
-  FInst << "sub=" << isSub << " ";
-  FInst << "dualPath=" << dualPath << " ";
-  FInst << "name=" << Name << " ";
-  FInst << "outputFile=" << Name << ".vhd" << " ";
-
-  unsigned Latency = flopoco::genModule(Name, FInst.str(), *BM);
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
   TheOps.addOperator(RName, Name, Latency);
 
+  if (BM->isSharedOperator(Name)) {
+    BM->addSharedOperator(R, Name, Latency, {
+        {"X", BM->getOperandName(R, R.getIn(0)), R.getIn(0)->getBitWidth()},
+        {"Y", BM->getOperandName(R, R.getIn(1)), R.getIn(1)->getBitWidth()}
+        }, "R");
+
+    super::visit(R);
+    return 0;
+  }
+
   // Add output signal
   Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
   BlockSignals << S.getDefStr() << ";\n";
@@ -466,8 +726,8 @@ int Verilog::visit(FAdd &R) {
   BlockComponents << Name << " " << Name << "_" << RName << "(\n";
   BlockComponents << Indent(1) << ".clk(clk)," << "\n";
   BlockComponents << Indent(1) << ".rst(rst)," << "\n";
-  BlockComponents << Indent(1) << ".X(" << getOpName(R.getIn(0)) << ")," << "\n";
-  BlockComponents << Indent(1) << ".Y(" << getOpName(R.getIn(1)) << ")," << "\n";
+  BlockComponents << Indent(1) << ".X(" << BM->getOperandName(R, R.getIn(0)) << ")," << "\n";
+  BlockComponents << Indent(1) << ".Y(" << BM->getOperandName(R, R.getIn(1)) << ")," << "\n";
   BlockComponents << Indent(1) << ".R(" << RName << ")" << "\n";
   BlockComponents << ");\n";
 
@@ -498,36 +758,22 @@ int Verilog::visit(FMul &R) {
     assert(!(In0 && In1));
     const_p ConstOp = In0 ? In0 : In1;
 
-    basefp_p VarOp = std::dynamic_pointer_cast<FPHW>(In0 ? R.getIn(1) : R.getIn(0));
-
-    // TODO will fail when ine input is of type Port and the other is constVal
-    assert(VarOp);
-
-    const std::string WEin = std::to_string(VarOp->getExponentBitWidth());
-    const std::string WFin = std::to_string(VarOp->getMantissaBitWidth());
-
-    const std::string WEout = std::to_string(R.getExponentBitWidth());
-    const std::string WFout = std::to_string(R.getMantissaBitWidth());
+    const base_p VarOp = In0 ? R.getIn(1) : R.getIn(0);
 
-    // Use the name as it will be converted.
-    const std::string constant = ConstOp->getName();
+    std::string Name;
+    const std::string FInst = flopoco::getFPConstMult(R, ConstOp, Name);
 
-    std::string ConstOpName = ConstOp->getName();
-    std::replace(ConstOpName.begin(), ConstOpName.end(), '.', '_');
-
-    const std::string Name = "FPConstMult_" + WEout + "_" + WFout + "_" + ConstOpName;
-
-    std::stringstream FInst;
+    unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+    TheOps.addOperator(RName, Name, Latency);
 
-    FInst << "FPConstMult" << " wE_in=" << WEin << " wF_in=" << WFin << " ";
-    FInst << "wE_out=" << WEout << " wF_out=" << WFout << " ";
-    FInst << "constant=\"" << constant << "\" ";
-    FInst << "cst_width=0 ";
-    FInst << "name=" << Name << " ";
-    FInst << "outputFile=" << Name << ".vhd" << " ";
+    if (BM->isSharedOperator(Name)) {
+      BM->addSharedOperator(R, Name, Latency, {
+          {"X", BM->getOperandName(R, VarOp), VarOp->getBitWidth()}
+          }, "R");
 
-    unsigned Latency = flopoco::genModule(Name, FInst.str(), *BM);
-    TheOps.addOperator(RName, Name, Latency);
+      super::visit(R);
+      return 0;
+    }
 
     // Add output signal
     Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
@@ -538,27 +784,26 @@ int Verilog::visit(FMul &R) {
     BlockComponents << Name << " " << Name << "_" << RName << "(\n";
     BlockComponents << Indent(1) << ".clk(clk)," << "\n";
     BlockComponents << Indent(1) << ".rst(rst)," << "\n";
-    BlockComponents << Indent(1) << ".X(" << VarOp->getUniqueName() << ")," << "\n";
+    BlockComponents << Indent(1) << ".X(" << BM->getOperandName(R, VarOp) << ")," << "\n";
     BlockComponents << Indent(1) << ".R(" << RName << ")" << "\n";
     BlockComponents << ");\n";
 
   } else {
-    const std::string WE = std::to_string(R.getExponentBitWidth());
-    const std::string WF = std::to_string(R.getMantissaBitWidth());
-
-    const std::string WFout = WF;
-
-    const std::string Name = "FPMult_" + WE + "_" + WF;
+    std::string Name;
+    const std::string FInst = flopoco::getFPMult(R, Name);
 
-    std::stringstream FInst;
+    unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+    TheOps.addOperator(RName, Name, Latency);
 
-    FInst << "FPMult" << " wE=" << WE << " wF=" << WF << " ";
-    FInst << "wFout=" << WFout << " ";
-    FInst << "name=" << Name << " ";
-    FInst << "outputFile=" << Name << ".vhd" << " ";
+    if (BM->isSharedOperator(Name)) {
+      BM->addSharedOperator(R, Name, Latency, {
+          {"X", BM->getOperandName(R, R.getIn(0)), R.getIn(0)->getBitWidth()},
+          {"Y", BM->getOperandName(R, R.getIn(1)), R.getIn(1)->getBitWidth()}
+          }, "R");
 
-    unsigned Latency = flopoco::genModule(Name, FInst.str(), *BM);
-    TheOps.addOperator(RName, Name, Latency);
+      super::visit(R);
+      return 0;
+    }
 
     // Add output signal
     Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
@@ -569,8 +814,8 @@ int Verilog::visit(FMul &R) {
     BlockComponents << Name << " " << Name << "_" << RName << "(\n";
     BlockComponents << Indent(1) << ".clk(clk)," << "\n";
     BlockComponents << Indent(1) << ".rst(rst)," << "\n";
-    BlockComponents << Indent(1) << ".X(" << R.getIn(0)->getUniqueName() << ")," << "\n";
-    BlockComponents << Indent(1) << ".Y(" << R.getIn(1)->getUniqueName() << ")," <<"\n";
+    BlockComponents << Indent(1) << ".X(" << BM->getOperandName(R, R.getIn(0)) << ")," << "\n";
+    BlockComponents << Indent(1) << ".Y(" << BM->getOperandName(R, R.getIn(1)) << ")," <<"\n";
     BlockComponents << Indent(1) << ".R(" << RName << ")" << "\n";
     BlockComponents << ");\n";
   }
@@ -578,34 +823,528 @@ int Verilog::visit(FMul &R) {
   super::visit(R);
   return 0;
 }
+/// \brief Chain the stages of the function core, the latency of R is the sum
+/// of their pipeline depths.
+int Verilog::visit(FPMath &R) {
+  VISIT_ONCE(R);
+
+  std::stringstream &BlockSignals = BM->getBlockSignals();
+  std::stringstream &BlockComponents = BM->getBlockComponents();
+
+  const std::string RName = R.getUniqueName();
+
+  const flopoco::StageListTy Stages = flopoco::getFPFunction(R);
+  assert(!Stages.empty());
+
+  const HW::HWListTy &Ops = R.getOperands();
+
+  const flopoco::StageTy &First = Stages.front();
+  assert(First.Ins.size() == Ops.size());
+
+  unsigned Latency = 0;
+  for (const flopoco::StageTy &S : Stages)
+    Latency += flopoco::genModule(S.Name, S.Inst, *BM);
+
+  TheOps.addOperator(RName, Stages.size() == 1 ? First.Name : R.getOp(), Latency);
+
+  if (Stages.size() == 1 && BM->isSharedOperator(First.Name)) {
+    BlockModule::SharedPortsTy Ports;
+    for (unsigned i = 0; i < First.Ins.size(); ++i)
+      Ports.push_back({First.Ins[i], BM->getOperandName(R, Ops[i]), Ops[i]->getBitWidth()});
+
+    BM->addSharedOperator(R, First.Name, Latency, Ports, First.Out);
+
+    super::visit(R);
+    return 0;
+  }
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BlockSignals << S.getDefStr() << ";\n";
+
+  BlockComponents << "// " << RName << "\n";
+
+  std::string Prev;
+
+  for (unsigned i = 0, e = Stages.size(); i < e; ++i) {
+    const flopoco::StageTy &Stage = Stages[i];
+
+    std::string Out = RName;
+
+    // Intermediate results
+    if (i + 1 < e) {
+      Out = RName + "_s" + std::to_string(i);
+      Signal SS(Out, Stage.OutBits, Signal::Local, Signal::Wire);
+      BlockSignals << SS.getDefStr() << ";\n";
+    }
+
+    BlockComponents << Stage.Name << " " << Stage.Name << "_" << RName << "_s" << i << "(\n";
+    BlockComponents << Indent(1) << ".clk(clk)," << "\n";
+    BlockComponents << Indent(1) << ".rst(rst)," << "\n";
+
+    for (unsigned j = 0; j < Stage.Ins.size(); ++j) {
+      std::string In;
+
+      if (i == 0)
+        In = BM->getOperandName(R, Ops[j]);
+      else if (Stage.InBits)
+        In = Prev + "[" + std::to_string(Stage.InBits-1) + ":0]";
+      else
+        In = Prev;
+
+      BlockComponents << Indent(1) << "." << Stage.Ins[j] << "(" << In << ")," << "\n";
+    }
+
+    BlockComponents << Indent(1) << "." << Stage.Out << "(" << Out << ")" << "\n";
+    BlockComponents << ");\n";
+
+    Prev = Out;
+  }
+
+  super::visit(R);
+  return 0;
+}
+
+/// \brief IEEE encoding of the FloPoCo FP signal \p S.
+static std::string getIEEE(const std::string &S, unsigned E, unsigned M) {
+  const unsigned Sign = E + M;
+  const std::string Exn = S + "[" + std::to_string(Sign+2) + ":" + std::to_string(Sign+1) + "]";
+  const std::string SignBit = S + "[" + std::to_string(Sign) + "]";
+
+  std::stringstream IS;
+  IS << "(" << Exn << " == 2'b00) ? {" << SignBit << ", " << E + M << "'b0} : ";
+  IS << "(" << Exn << " == 2'b01) ? " << S << "[" << Sign << ":0] : ";
+  IS << "(" << Exn << " == 2'b10) ? {" << SignBit << ", {" << E << "{1'b1}}, " << M << "'b0} : ";
+  IS << "{1'b0, {" << E << "{1'b1}}, 1'b1, " << M-1 << "'b0}";
+
+  return IS.str();
+}
+
+/// \brief FloPoCo encoding of the IEEE signal \p S, subnormals are flushed
+/// to zero.
+static std::string getFlopoco(const std::string &S, unsigned E, unsigned M) {
+  const std::string Exp = S + "[" + std::to_string(E+M-1) + ":" + std::to_string(M) + "]";
+  const std::string Frac = S + "[" + std::to_string(M-1) + ":0]";
+
+  std::stringstream FS;
+  FS << "(" << Exp << " == " << E << "'b0) ? {2'b00, " << S << "[" << E+M << "], " << E+M << "'b0} : ";
+  FS << "(" << Exp << " == {" << E << "{1'b1}}) ? {" << Frac << " == " << M << "'b0 ? 2'b10 : 2'b11, " << S << "} : ";
+  FS << "{2'b01, " << S << "}";
+
+  return FS.str();
+}
+
+/// \brief The FMA core is IEEE encoded, so operands and result are converted
+/// by wires. It is not shared, as the result register would hold the IEEE
+/// value.
+int Verilog::visit(FMA &R) {
+  VISIT_ONCE(R);
+
+  const HW::HWListTy &Ops = R.getOperands();
+  assert(Ops.size() == 3);
+
+  std::stringstream &BlockSignals = BM->getBlockSignals();
+  std::stringstream &BlockComponents = BM->getBlockComponents();
+  std::stringstream &LO = BM->getLocalOperators();
+
+  const std::string RName = R.getUniqueName();
+
+  const unsigned E = R.getExponentBitWidth();
+  const unsigned M = R.getMantissaBitWidth();
+
+  std::string Name;
+  const std::string FInst = flopoco::getFMA(R, Name);
+
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+  TheOps.addOperator(RName, Name, Latency);
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BlockSignals << S.getDefStr() << ";\n";
+
+  const char *Ports[] = {"A", "B", "C"};
+
+  for (unsigned i = 0; i < 3; ++i) {
+    const std::string IName = RName + "_" + Ports[i];
+
+    Signal IS(IName, E + M + 1, Signal::Local, Signal::Wire);
+    BlockSignals << IS.getDefStr() << ";\n";
+
+    LO << "assign " << IName << " = " << getIEEE(BM->getOperandName(R, Ops[i]), E, M) << ";\n";
+  }
+
+  const std::string OName = RName + "_R";
+  Signal OS(OName, E + M + 1, Signal::Local, Signal::Wire);
+  BlockSignals << OS.getDefStr() << ";\n";
+
+  LO << "assign " << RName << " = " << getFlopoco(OName, E, M) << ";\n";
+
+  // Instantiate component
+  BlockComponents << "// " << RName << "\n";
+  BlockComponents << Name << " " << Name << "_" << RName << "(\n";
+  BlockComponents << Indent(1) << ".clk(clk)," << "\n";
+  BlockComponents << Indent(1) << ".rst(rst)," << "\n";
+  for (unsigned i = 0; i < 3; ++i)
+    BlockComponents << Indent(1) << "." << Ports[i] << "(" << RName << "_" << Ports[i] << ")," << "\n";
+  BlockComponents << Indent(1) << ".negateAB(1'b" << R.isNegateAB() << ")," << "\n";
+  BlockComponents << Indent(1) << ".negateC(1'b" << R.isNegateC() << ")," << "\n";
+  BlockComponents << Indent(1) << ".RndMode(2'b00)," << "\n";
+  BlockComponents << Indent(1) << ".R(" << OName << ")" << "\n";
+  BlockComponents << ");\n";
+
+  super::visit(R);
+  return 0;
+}
+
+/// \brief Conversion into the fixed point format of a component. Both
+/// conversions are single-input FloPoCo operators and may be shared.
+int Verilog::visit(FPToFixed &R) {
+  VISIT_ONCE(R);
+  assert(R.getIns().size() == 1);
+
+  std::stringstream &BlockSignals = BM->getBlockSignals();
+  std::stringstream &BlockComponents = BM->getBlockComponents();
+
+  const std::string RName = R.getUniqueName();
+
+  std::string Name;
+  const std::string FInst = flopoco::getFP2Fix(R, Name);
+
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+  TheOps.addOperator(RName, Name, Latency);
+
+  if (BM->isSharedOperator(Name)) {
+    BM->addSharedOperator(R, Name, Latency, {
+        {"I", BM->getOperandName(R, R.getIn(0)), R.getIn(0)->getBitWidth()}
+        }, "O");
+
+    super::visit(R);
+    return 0;
+  }
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BlockSignals << S.getDefStr() << ";\n";
+
+  // Instantiate component
+  BlockComponents << "// " << RName << "\n";
+  BlockComponents << Name << " " << Name << "_" << RName << "(\n";
+  BlockComponents << Indent(1) << ".clk(clk)," << "\n";
+  BlockComponents << Indent(1) << ".rst(rst)," << "\n";
+  BlockComponents << Indent(1) << ".I(" << BM->getOperandName(R, R.getIn(0)) << ")," << "\n";
+  BlockComponents << Indent(1) << ".O(" << RName << ")" << "\n";
+  BlockComponents << ");\n";
+
+  super::visit(R);
+  return 0;
+}
+
+int Verilog::visit(FixedToFP &R) {
+  VISIT_ONCE(R);
+  assert(R.getIns().size() == 1);
+
+  std::stringstream &BlockSignals = BM->getBlockSignals();
+  std::stringstream &BlockComponents = BM->getBlockComponents();
+
+  const std::string RName = R.getUniqueName();
+
+  std::string Name;
+  const std::string FInst = flopoco::getFix2FP(R, Name);
+
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+  TheOps.addOperator(RName, Name, Latency);
+
+  if (BM->isSharedOperator(Name)) {
+    BM->addSharedOperator(R, Name, Latency, {
+        {"I", BM->getOperandName(R, R.getIn(0)), R.getIn(0)->getBitWidth()}
+        }, "O");
+
+    super::visit(R);
+    return 0;
+  }
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BlockSignals << S.getDefStr() << ";\n";
+
+  // Instantiate component
+  BlockComponents << "// " << RName << "\n";
+  BlockComponents << Name << " " << Name << "_" << RName << "(\n";
+  BlockComponents << Indent(1) << ".clk(clk)," << "\n";
+  BlockComponents << Indent(1) << ".rst(rst)," << "\n";
+  BlockComponents << Indent(1) << ".I(" << BM->getOperandName(R, R.getIn(0)) << ")," << "\n";
+  BlockComponents << Indent(1) << ".O(" << RName << ")" << "\n";
+  BlockComponents << ");\n";
+
+  super::visit(R);
+  return 0;
+}
+
+/// \brief Divide by the pipelined divider or by a constant.
+///
+/// Dividers are instantiated with the widest operand, so the quotient and
+/// remainder of narrower operands are the same.
+void Verilog::handleDivision(const Arith &R, bool Signed, bool Rem) {
+  assert(R.getIns().size() == 2);
+
+  std::stringstream &BS = BM->getBlockSignals();
+  std::stringstream &BC = BM->getBlockComponents();
+
+  const base_p In0 = R.getIn(0);
+  const base_p In1 = R.getIn(1);
+
+  const unsigned N = std::max(R.getBitWidth(), std::max(In0->getBitWidth(), In1->getBitWidth()));
+
+  if (const_p C = std::dynamic_pointer_cast<ConstVal>(In1)) {
+    handleConstDivision(R, C, N, Signed, Rem);
+    return;
+  }
+
+  const std::string RName = R.getUniqueName();
+
+  ip::DividerImpl Div(N, Signed);
+  const std::string Name = Div.getName();
+  const unsigned Latency = Div.getLatency();
+
+  const std::string FileName = Div.define();
+  const BlockModule::FileListTy &Files = BM->getFiles();
+  if (std::find(Files.begin(), Files.end(), FileName) == Files.end())
+    BM->addFile(FileName);
+
+  const std::string X = getExtended(BM->getOperandName(R, In0), In0->getBitWidth(), Div.getBitWidth(), Signed);
+  const std::string Y = getExtended(BM->getOperandName(R, In1), In1->getBitWidth(), Div.getBitWidth(), Signed);
+  const std::string Out = Rem ? "R" : "Q";
+
+  TheOps.addOperator(RName, Name, Latency);
+
+  if (BM->isSharedOperator(Name)) {
+    BM->addSharedOperator(R, Name, Latency, {
+        {"X", X, Div.getBitWidth()},
+        {"Y", Y, Div.getBitWidth()}
+        }, Out);
+    return;
+  }
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BS << S.getDefStr() << ";\n";
+
+  // Instantiate component
+  BC << "// " << RName << "\n";
+  BC << Name << " " << Name << "_" << RName << "(\n";
+  BC << Indent(1) << ".clk(clk)," << "\n";
+  BC << Indent(1) << ".rst(rst)," << "\n";
+  BC << Indent(1) << ".X(" << X << ")," << "\n";
+  BC << Indent(1) << ".Y(" << Y << ")," << "\n";
+  BC << Indent(1) << "." << Out << "(" << RName << ")" << "\n";
+  BC << ");\n";
+}
+
+/// \brief Replace the division by the constant \p C by a multiplication
+/// with its reciprocal and shifts.
+///
+/// Powers of 2 and +-1 are wires, all other divisors take two cycles: one for
+/// the product of the magic number, one for the shifts and the remainder.
+void Verilog::handleConstDivision(const Arith &R, const_p C, unsigned N, bool Signed, bool Rem) {
+  std::stringstream &BS = BM->getBlockSignals();
+  std::stringstream &LO = BM->getLocalOperators();
+
+  const base_p In0 = R.getIn(0);
+  const std::string RName = getOpName(R);
+  const std::string X = getExtended(BM->getOperandName(R, In0), In0->getBitWidth(), N, Signed);
+
+  const llvm::APInt D = C->getAPInt(N);
+
+  if (D == 0)
+    report_fatal_error("Division by zero in " + RName);
+
+  const std::string NS = std::to_string(N);
+  const std::string DS = NS + "'h" + D.toString(16, false);
+
+  if (!Signed && D.isPowerOf2()) {
+    Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+    BS << S.getDefStr() << ";\n";
+
+    const unsigned K = D.logBase2();
+
+    if (Rem)
+      LO << "assign " << RName << " = " << X << " & " << NS << "'h" << (D-1).toString(16, false) << ";\n";
+    else
+      LO << "assign " << RName << " = " << X << " >> " << K << ";\n";
+
+    return;
+  }
+
+  if (Signed && (D == 1 || D.isAllOnesValue())) {
+    Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+    BS << S.getDefStr() << ";\n";
+
+    if (Rem)
+      LO << "assign " << RName << " = " << NS << "'b0;\n";
+    else
+      LO << "assign " << RName << " = " << (D == 1 ? "" : "-") << X << ";\n";
+
+    return;
+  }
+
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Reg);
+  BS << S.getDefStr() << ";\n";
+
+  Signal SP(RName + "_prod", 2*N, Signal::Local, Signal::Reg);
+  BS << SP.getDefStr() << ";\n";
+  Signal SX(RName + "_x", N, Signal::Local, Signal::Reg);
+  BS << SX.getDefStr() << ";\n";
+  Signal SH(RName + "_hi", N, Signal::Local, Signal::Wire);
+  BS << SH.getDefStr() << ";\n";
+  Signal SQ(RName + "_q", N, Signal::Local, Signal::Wire);
+  BS << SQ.getDefStr() << ";\n";
+
+  std::string Prod;
+
+  LO << "// " << RName << " = " << X << (Rem ? " % " : " / ") << C->getName() << "\n";
+
+  if (Signed) {
+    const llvm::APInt::ms Magic = D.magic();
+    const llvm::APInt &M = Magic.m;
+
+    Prod = "$signed(" + X + ") * $signed(" + NS + "'h" + M.toString(16, false) + ")";
+
+    std::string H = RName + "_hi";
+    if (D.isStrictlyPositive() && M.isNegative())
+      H = "$signed(" + RName + "_hi) + $signed(" + RName + "_x)";
+    else if (D.isNegative() && M.isStrictlyPositive())
+      H = "$signed(" + RName + "_hi) - $signed(" + RName + "_x)";
+
+    Signal SA(RName + "_h", N, Signal::Local, Signal::Wire);
+    BS << SA.getDefStr() << ";\n";
+    Signal SS(RName + "_q0", N, Signal::Local, Signal::Wire);
+    BS << SS.getDefStr() << ";\n";
+
+    // Round towards zero by adding the sign
+    LO << "assign " << RName << "_h = " << H << ";\n";
+    LO << "assign " << RName << "_q0 = $signed(" << RName << "_h) >>> " << Magic.s << ";\n";
+    LO << "assign " << RName << "_q = " << RName << "_q0 + " << RName << "_h[" << N-1 << "];\n";
+  } else {
+    const llvm::APInt::mu Magic = D.magicu();
+
+    Prod = X + " * " + NS + "'h" + Magic.m.toString(16, false);
+
+    if (Magic.a)
+      LO << "assign " << RName << "_q = (((" << RName << "_x - " << RName << "_hi) >> 1) + " << RName << "_hi) >> " << Magic.s - 1 << ";\n";
+    else
+      LO << "assign " << RName << "_q = " << RName << "_hi >> " << Magic.s << ";\n";
+  }
+
+  LO << "assign " << RName << "_hi = " << RName << "_prod[" << 2*N-1 << ":" << N << "];\n";
+
+  unsigned II = 0;
+  LO << "always @(posedge clk)\n";
+  BEGIN(LO);
+  LO << Indent(II) << "if (rst==1)\n";
+  BEGIN(LO);
+  LO << Indent(II) << RName << "_prod <= '0;\n";
+  LO << Indent(II) << RName << "_x <= '0;\n";
+  LO << Indent(II) << RName << " <= '0;\n";
+  END(LO);
+  LO << Indent(II) << "else\n";
+  BEGIN(LO);
+  LO << Indent(II) << RName << "_prod <= " << Prod << ";\n";
+  LO << Indent(II) << RName << "_x <= " << X << ";\n";
+  if (Rem)
+    LO << Indent(II) << RName << " <= " << RName << "_x - " << RName << "_q * " << DS << ";\n";
+  else
+    LO << Indent(II) << RName << " <= " << RName << "_q;\n";
+  END(LO);
+  END(LO);
+
+  TheOps.addOperator(RName, RName, 2);
+}
+
 int Verilog::visit(UDiv &R) {
   VISIT_ONCE(R);
+
+  handleDivision(R, false, false);
+
   super::visit(R);
   return 0;
 }
+
 int Verilog::visit(SDiv &R) {
   VISIT_ONCE(R);
+
+  handleDivision(R, true, false);
+
   super::visit(R);
   return 0;
 }
+
 int Verilog::visit(FDiv &R) {
   VISIT_ONCE(R);
+  assert(R.getIns().size() == 2);
+
+  std::stringstream &BlockSignals = BM->getBlockSignals();
+  std::stringstream &BlockComponents = BM->getBlockComponents();
+
+  const std::string RName = R.getUniqueName();
+
+  std::string Name;
+  const std::string FInst = flopoco::getFPDiv(R, Name);
+
+  unsigned Latency = flopoco::genModule(Name, FInst, *BM);
+  TheOps.addOperator(RName, Name, Latency);
+
+  if (BM->isSharedOperator(Name)) {
+    BM->addSharedOperator(R, Name, Latency, {
+        {"X", BM->getOperandName(R, R.getIn(0)), R.getIn(0)->getBitWidth()},
+        {"Y", BM->getOperandName(R, R.getIn(1)), R.getIn(1)->getBitWidth()}
+        }, "R");
+
+    super::visit(R);
+    return 0;
+  }
+
+  // Add output signal
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BlockSignals << S.getDefStr() << ";\n";
+
+  // Instantiate component
+  BlockComponents << "// " << RName << "\n";
+  BlockComponents << Name << " " << Name << "_" << RName << "(\n";
+  BlockComponents << Indent(1) << ".clk(clk)," << "\n";
+  BlockComponents << Indent(1) << ".rst(rst)," << "\n";
+  BlockComponents << Indent(1) << ".X(" << BM->getOperandName(R, R.getIn(0)) << ")," << "\n";
+  BlockComponents << Indent(1) << ".Y(" << BM->getOperandName(R, R.getIn(1)) << ")," << "\n";
+  BlockComponents << Indent(1) << ".R(" << RName << ")" << "\n";
+  BlockComponents << ");\n";
+
   super::visit(R);
   return 0;
 }
+
 int Verilog::visit(URem &R) {
   VISIT_ONCE(R);
+
+  handleDivision(R, false, true);
+
   super::visit(R);
   return 0;
 }
+
 int Verilog::visit(SRem &R) {
   VISIT_ONCE(R);
+
+  handleDivision(R, true, true);
+
   super::visit(R);
   return 0;
 }
+
+/// \brief FloPoCo has no remainder operator.
 int Verilog::visit(FRem &R) {
   VISIT_ONCE(R);
-  super::visit(R);
+
+  report_fatal_error("Floating point remainder not supported in hardware: " + R.getUniqueName());
+
   return 0;
 }
 
@@ -613,21 +1352,24 @@ int Verilog::visit(FRem &R) {
 int Verilog::visit(Shl &R) {
   VISIT_ONCE(R);
 
-  if (const_p C = std::dynamic_pointer_cast<ConstVal>(R.getIn(1))) {
-    assert(C->isStatic() && "Constant shifts must have a value");
-    handleConstShift(R, C->getValue());
-  } else
-    report_fatal_error("Shift with dynamic width");
+  handleShift(R, "<<");
 
+  super::visit(R);
   return 0;
 }
 int Verilog::visit(LShr &R) {
   VISIT_ONCE(R);
+
+  handleShift(R, ">>");
+
   super::visit(R);
   return 0;
 }
 int Verilog::visit(AShr &R) {
   VISIT_ONCE(R);
+
+  handleShift(R, ">>>");
+
   super::visit(R);
   return 0;
 }
@@ -656,14 +1398,76 @@ int Verilog::visit(Xor &R) {
   return 0;
 }
 
+/// \brief Lanes are wires selecting a part of the vector.
+int Verilog::visit(Slice &R) {
+  VISIT_ONCE(R);
+
+  std::stringstream &BS = BM->getBlockSignals();
+  std::stringstream &LO = BM->getLocalOperators();
+
+  const std::string Op0 = BM->getOperandName(R, R.getIn(0));
+  const std::string RName = getOpName(R);
+
+  const unsigned Bits = R.getBitWidth();
+  const unsigned Low = R.getIndex() * Bits;
+
+  Signal S(RName, Bits, Signal::Local, Signal::Wire);
+  BS << S.getDefStr() << ";\n";
+
+  LO << "assign " << RName << " = " << Op0 << "[" << Low + Bits - 1 << ":" << Low << "];\n";
+
+  super::visit(R);
+  return 0;
+}
+
+/// \brief Concatenate the lanes with lane 0 in the least significant bits.
+///
+/// Narrower elements, e.g. constants, are zero-extended to the lane width.
+int Verilog::visit(Concat &R) {
+  VISIT_ONCE(R);
+
+  std::stringstream &BS = BM->getBlockSignals();
+  std::stringstream &LO = BM->getLocalOperators();
+
+  const std::string RName = getOpName(R);
+  const HW::HWListTy &Elements = R.getElements();
+
+  assert(Elements.size() == R.getLanes() && "Lane missing");
+
+  const unsigned LaneBits = R.getBitWidth() / R.getLanes();
+
+  Signal S(RName, R.getBitWidth(), Signal::Local, Signal::Wire);
+  BS << S.getDefStr() << ";\n";
+
+  LO << "assign " << RName << " = {";
+  for (HW::HWListTy::const_reverse_iterator I = Elements.rbegin(), E = Elements.rend(); I != E; ++I) {
+    if (I != Elements.rbegin())
+      LO << ", ";
+
+    const unsigned Bits = (*I)->getBitWidth();
+    const std::string Op = BM->getOperandName(R, *I);
+
+    if (Bits < LaneBits)
+      LO << "{" << LaneBits - Bits << "'b0, " << Op << "}";
+    else if (Bits > LaneBits)
+      LO << Op << "[" << LaneBits - 1 << ":0]";
+    else
+      LO << Op;
+  }
+  LO << "};\n";
+
+  super::visit(R);
+  return 0;
+}
+
 int Verilog::visit(IntCompare &R) {
   VISIT_ONCE(R);
 
   std::stringstream &BS = BM->getBlockSignals();
   std::stringstream &LO = BM->getLocalOperators();
 
-  const std::string Op0 = getOpName(R.getIn(0));
-  const std::string Op1 = getOpName(R.getIn(1));
+  const std::string Op0 = BM->getOperandName(R, R.getIn(0));
+  const std::string Op1 = BM->getOperandName(R, R.getIn(1));
   const std::string Res = getOpName(R);
 
   unsigned BitWidth = R.getBitWidth();
@@ -750,7 +1554,13 @@ int Verilog::visit(Mux &R) {
       const std::string IName = M.first->getUniqueName();
       const std::string CName = M.second->getUniqueName();
 
-      LO << Indent(II) << " if (" << CName << "_valid == 1 && " << CName << " == 1) " << RName << " <= " << IName << ";\n";
+      // Loop-carried inputs are only valid for the next iteration and take
+      // precedence over the entry value.
+      scalarport_p SP = std::dynamic_pointer_cast<ScalarPort>(M.first);
+      if (SP && SP->isBackEdge())
+        LO << Indent(II) << " if (" << IName << "_valid == 1) " << RName << " <= " << IName << ";\n";
+      else
+        LO << Indent(II) << " if (" << CName << "_valid == 1 && " << CName << " == 1) " << RName << " <= " << IName << ";\n";
     }
     END(LO);
 
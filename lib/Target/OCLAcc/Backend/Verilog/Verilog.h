@@ -38,7 +38,11 @@ class Verilog : public DFVisitor {
     unsigned II=0;
 
     void handleInferableMath(const Arith &R, const std::string Op);
-    void handleConstShift(const Shl &, uint64_t C);
+    void handleConstShift(const Arith &R, uint64_t C, const std::string Op);
+    void handleShift(const Arith &R, const std::string Op);
+    void handleConstMult(const Mul &R, const_p C, const base_p VarOp);
+    void handleDivision(const Arith &R, bool Signed, bool Rem);
+    void handleConstDivision(const Arith &R, const_p C, unsigned BitWidth, bool Signed, bool Rem);
 
   public:
     Verilog();
@@ -66,6 +70,10 @@ class Verilog : public DFVisitor {
     int visit(UDiv &);
     int visit(SDiv &);
     int visit(FDiv &);
+    int visit(FPMath &);
+    int visit(FMA &);
+    int visit(FPToFixed &);
+    int visit(FixedToFP &);
     int visit(URem &);
     int visit(SRem &);
     int visit(FRem &);
@@ -76,6 +84,10 @@ class Verilog : public DFVisitor {
     int visit(Or &);
     int visit(Xor &);
 
+    // Vector
+    int visit(Slice &);
+    int visit(Concat &);
+
     // Compare
     int visit(IntCompare &);
     int visit(FPCompare &);
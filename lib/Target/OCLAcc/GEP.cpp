@@ -33,7 +33,7 @@ base_p OCLAccHW::computeSequentialIndex(BasicBlock *Parent, Value *IV, Sequentia
 
     A *= APInt(64, CurrSize, false);
 
-    HWOffset = std::make_shared<ConstVal>(
+    HWOffset = HWArena.make<ConstVal>(
         A.toString(10, false),
         Datatype::Integer,
         A.toString(2, false),
@@ -56,7 +56,7 @@ base_p OCLAccHW::computeSequentialIndex(BasicBlock *Parent, Value *IV, Sequentia
     int32_t Log = CurrSizeAP.exactLogBase2();
 
     if (Log != -1) {
-      const_p HWLogSize = std::make_shared<ConstVal>(Log);
+      const_p HWLogSize = HWArena.make<ConstVal>(Log);
       HWLogSize->setParent(HWParent);
 
       HWParent->addConstVal(HWLogSize);
@@ -65,7 +65,7 @@ base_p OCLAccHW::computeSequentialIndex(BasicBlock *Parent, Value *IV, Sequentia
       AddrWidth = Log + HWLocalIndex->getBitWidth();
       std::string IndexName = Name+"_shift";
 
-      shl_p HWShift = std::make_shared<Shl>(IndexName, AddrWidth);
+      shl_p HWShift = HWArena.make<Shl>(IndexName, AddrWidth);
       HWShift->setParent(HWParent);
       HWParent->addOp(HWShift);
 
@@ -74,13 +74,13 @@ base_p OCLAccHW::computeSequentialIndex(BasicBlock *Parent, Value *IV, Sequentia
 
       HWOffset = HWShift;
     } else {
-      const_p HWSize = std::make_shared<ConstVal>(std::to_string(CurrSize), CurrSizeAP.toString(2, false), AddrWidth);
+      const_p HWSize = HWArena.make<ConstVal>(std::to_string(CurrSize), CurrSizeAP.toString(2, false), AddrWidth);
       HWSize->setParent(HWParent);
       // No power of two, use multiplication
       AddrWidth = CurrSizeAP.getActiveBits() + HWLocalIndex->getBitWidth();
       std::string IndexName = Name+"_mul";
 
-      mul_p HWMul = std::make_shared<Mul>(IndexName, AddrWidth);
+      mul_p HWMul = HWArena.make<Mul>(IndexName, AddrWidth);
       HWMul->setParent(HWParent);
       HWParent->addOp(HWMul);
 
@@ -130,7 +130,7 @@ const_p OCLAccHW::computeStructIndex(BasicBlock *Parent, Value *IV, StructType *
 
   A *= APInt(64, Offset, false);
 
-  HWOffset = std::make_shared<ConstVal>(
+  HWOffset = HWArena.make<ConstVal>(
       A.toString(10, false),
       Datatype::Integer,
       A.toString(2, false),
@@ -189,7 +189,7 @@ void OCLAccHW::handleGEPOperator(GEPOperator &I) {
   // Constant zero address
   if (I.hasAllZeroIndices()) {
 
-    const_p HWIndex = std::make_shared<ConstVal>("0", "0", 1);
+    const_p HWIndex = HWArena.make<ConstVal>("0", "0", 1);
     HWParent->addConstVal(HWIndex);
 
     streamindex_p HWStreamIndex = makeHWBB<StaticStreamIndex>(Parent, InstValue, Name, HWStream, HWIndex, 1);
@@ -259,7 +259,7 @@ void OCLAccHW::handleGEPOperator(GEPOperator &I) {
 
     uint64_t BitWidth = APOffset.getActiveBits();
 
-    const_p HWIndex = std::make_shared<ConstVal>(APOffset.toString(10,false), APOffset.toString(2, false), BitWidth);
+    const_p HWIndex = HWArena.make<ConstVal>(APOffset.toString(10,false), APOffset.toString(2, false), BitWidth);
     HWParent->addConstVal(HWIndex);
 
     streamindex_p HWStreamIndex = makeHWBB<StaticStreamIndex>(Parent, InstValue, Name, HWStream, HWIndex, BitWidth);
@@ -313,7 +313,7 @@ void OCLAccHW::handleGEPOperator(GEPOperator &I) {
         uint64_t AddrWidth = std::max(HWOffset->getBitWidth(), HWIndex->getBitWidth())+1;
         std::string IndexName = Name+"_"+std::to_string(IndexNo)+"_add";
 
-        base_p HWAdd = std::make_shared<Add>(IndexName, AddrWidth);
+        base_p HWAdd = HWArena.make<Add>(IndexName, AddrWidth);
         HWAdd->setParent(HWParent);
         HWParent->addOp(HWAdd);
 
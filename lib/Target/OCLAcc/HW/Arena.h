@@ -0,0 +1,87 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "llvm/Support/Allocator.h"
+
+namespace oclacc {
+
+/// \brief Storage for the HW nodes of a design.
+///
+/// Nodes are created by allocate_shared, so each node and its reference
+/// count are a single chunk bumped from the Arena instead of separate heap
+/// allocations. Memory of destroyed nodes is not reused, it is released when
+/// the Arena and all nodes created by it are gone.
+class Arena
+{
+  private:
+    typedef llvm::BumpPtrAllocator StorageTy;
+    typedef std::shared_ptr<StorageTy> StorageRefTy;
+
+    StorageRefTy Storage;
+
+  public:
+    /// \brief Allocator handed to allocate_shared. Each copy keeps the
+    /// storage alive.
+    template<class T>
+    class Allocator {
+      template<class U> friend class Allocator;
+
+      private:
+        StorageRefTy Storage;
+
+      public:
+        typedef T value_type;
+
+        template<class U>
+        struct rebind {
+          typedef Allocator<U> other;
+        };
+
+        explicit Allocator(const StorageRefTy &S) : Storage(S) {
+        }
+
+        template<class U>
+        Allocator(const Allocator<U> &A) : Storage(A.Storage) {
+        }
+
+        T *allocate(std::size_t N) {
+          return static_cast<T *>(Storage->Allocate(N * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) {
+        }
+
+        template<class U>
+        bool operator==(const Allocator<U> &A) const {
+          return Storage == A.Storage;
+        }
+
+        template<class U>
+        bool operator!=(const Allocator<U> &A) const {
+          return Storage != A.Storage;
+        }
+    };
+
+    Arena() : Storage(std::make_shared<StorageTy>()) {
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator =(const Arena &) = delete;
+
+    template<class T, class ...Args>
+    std::shared_ptr<T> make(Args&& ...args) {
+      return std::allocate_shared<T>(Allocator<T>(Storage), std::forward<Args>(args)...);
+    }
+
+    inline std::size_t getTotalMemory() const {
+      return Storage->getTotalMemory();
+    }
+};
+
+} //ns oclacc
+
+#endif /* ARENA_H */
@@ -203,6 +203,159 @@ class FRem : public FPArith
     DECLARE_VISIT;
 };
 
+/// \brief Function of the OpenCL math library
+///
+/// Pow has two operands, all others a single one. The operands are kept in
+/// order, as the inputs of pow(x, x) are deduplicated.
+class FPMath : public FPArith
+{
+  public:
+    enum FuncTy {
+      Sqrt,
+      Exp,
+      Log,
+      Pow,
+      Sin,
+      Cos
+    };
+
+  private:
+    FuncTy Func;
+    HWListTy Operands;
+
+  public:
+    FPMath(const std::string &Name, FuncTy Func, unsigned MantissaBitWidth, unsigned ExponentBitWidth) : FPArith(Name, MantissaBitWidth, ExponentBitWidth), Func(Func)
+    {
+      //pass
+    }
+    virtual const std::string getOp() override {
+      switch (Func) {
+        case Sqrt: return "FPSqrt";
+        case Exp: return "FPExp";
+        case Log: return "FPLog";
+        case Pow: return "FPPow";
+        case Sin: return "FPSin";
+        case Cos: return "FPCos";
+      }
+      return "FPMath";
+    }
+
+    inline FuncTy getFunc() const {
+      return Func;
+    }
+
+    inline void addOperand(base_p O) {
+      Operands.push_back(O);
+    }
+
+    inline const HWListTy &getOperands() const {
+      return Operands;
+    }
+
+    DECLARE_VISIT;
+};
+
+/// \brief Fused multiply-add A*B+C with a single rounding
+///
+/// The operands are kept in order, as the inputs of x*x+c are deduplicated.
+class FMA : public FPArith
+{
+  private:
+    HWListTy Operands;
+    bool NegateAB;
+    bool NegateC;
+
+  public:
+    FMA(const std::string &Name, unsigned MantissaBitWidth, unsigned ExponentBitWidth, bool NegateAB, bool NegateC) : FPArith(Name, MantissaBitWidth, ExponentBitWidth), NegateAB(NegateAB), NegateC(NegateC)
+    {
+      //pass
+    }
+    virtual const std::string getOp() override {
+      return "FMA";
+    }
+
+    inline void addOperand(base_p O) {
+      Operands.push_back(O);
+    }
+
+    inline const HWListTy &getOperands() const {
+      return Operands;
+    }
+
+    inline bool isNegateAB() const {
+      return NegateAB;
+    }
+
+    inline bool isNegateC() const {
+      return NegateC;
+    }
+
+    DECLARE_VISIT;
+};
+
+/// \brief Conversion of a floating point value to a signed fixed point
+/// value with \p BitWidth bits, of which \p FracBits are fractional.
+///
+/// Used by the fixed point mode, see FixedPointAnalysis.
+class FPToFixed : public Arith
+{
+  private:
+    unsigned FracBits;
+    unsigned MantissaBitWidth;
+    unsigned ExponentBitWidth;
+
+  public:
+    FPToFixed(const std::string &Name, unsigned BitWidth, unsigned FracBits, unsigned MantissaBitWidth, unsigned ExponentBitWidth) : Arith(Name, BitWidth), FracBits(FracBits), MantissaBitWidth(MantissaBitWidth), ExponentBitWidth(ExponentBitWidth)
+    {
+      //pass
+    }
+    virtual const std::string getOp() override {
+      return "FPToFixed";
+    }
+
+    inline unsigned getFracBits() const {
+      return FracBits;
+    }
+
+    inline unsigned getInMantissaBitWidth() const {
+      return MantissaBitWidth;
+    }
+
+    inline unsigned getInExponentBitWidth() const {
+      return ExponentBitWidth;
+    }
+
+    DECLARE_VISIT;
+};
+
+/// \brief Conversion of a signed fixed point value with \p FixedBitWidth
+/// bits, of which \p FracBits are fractional, back to floating point.
+class FixedToFP : public FPArith
+{
+  private:
+    unsigned FixedBitWidth;
+    unsigned FracBits;
+
+  public:
+    FixedToFP(const std::string &Name, unsigned FixedBitWidth, unsigned FracBits, unsigned MantissaBitWidth, unsigned ExponentBitWidth) : FPArith(Name, MantissaBitWidth, ExponentBitWidth), FixedBitWidth(FixedBitWidth), FracBits(FracBits)
+    {
+      //pass
+    }
+    virtual const std::string getOp() override {
+      return "FixedToFP";
+    }
+
+    inline unsigned getFixedBitWidth() const {
+      return FixedBitWidth;
+    }
+
+    inline unsigned getFracBits() const {
+      return FracBits;
+    }
+
+    DECLARE_VISIT;
+};
+
 class Shl : public Arith
 {
   public:
@@ -276,6 +429,71 @@ class Xor : public Arith
     DECLARE_VISIT;
 };
 
+/// \brief Select lane \p Index of a vector value.
+///
+/// The lanes of a vector are concatenated with lane 0 in the least
+/// significant bits. The offset is derived from the width of the Slice, so it
+/// follows changes of the lane width, e.g. by the FloPoCo format.
+class Slice : public Arith
+{
+  private:
+    unsigned Index;
+    bool FP;
+
+  public:
+    Slice(const std::string &Name, unsigned BitWidth, unsigned Index, bool FP) : Arith(Name, BitWidth), Index(Index), FP(FP)
+    {
+      //pass
+    }
+    virtual const std::string getOp() override {
+      return "Slice";
+    }
+
+    inline unsigned getIndex() const {
+      return Index;
+    }
+
+    inline bool isFP() const override {
+      return FP;
+    }
+
+    DECLARE_VISIT;
+};
+
+/// \brief Build a vector value from its lanes.
+///
+/// Elements are kept in a separate list as a single value may be used for
+/// multiple lanes, e.g. when splatting a scalar.
+class Concat : public Arith
+{
+  private:
+    HWListTy Elements;
+    bool FP;
+
+  public:
+    Concat(const std::string &Name, unsigned BitWidth, unsigned Lanes, bool FP) : Arith(Name, BitWidth), FP(FP)
+    {
+      setLanes(Lanes);
+    }
+    virtual const std::string getOp() override {
+      return "Concat";
+    }
+
+    inline void addElement(base_p E) {
+      Elements.push_back(E);
+    }
+
+    inline const HWListTy &getElements() const {
+      return Elements;
+    }
+
+    inline bool isFP() const override {
+      return FP;
+    }
+
+    DECLARE_VISIT;
+};
+
 } //ns oclacc
 
 #ifdef TYPENAME
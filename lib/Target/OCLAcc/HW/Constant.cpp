@@ -1,4 +1,5 @@
 #include "Constant.h"
+#include <algorithm>
 #include <sstream>
 #include <cxxabi.h>
 
@@ -61,6 +62,15 @@ ConstVal::ConstVal(const std::string Name, Datatype T, const std::string Bits, s
   HW::Name = NewName;
 }
 
+/// \brief The name of integer constants holds their decimal value.
+llvm::APInt ConstVal::getAPInt(unsigned BitWidth) const {
+  if (Static)
+    return llvm::APInt(BitWidth, Value);
+
+  const unsigned W = std::max(BitWidth, 65u);
+  return llvm::APInt(W, getName(), 10).sextOrTrunc(BitWidth);
+}
+
 const std::string ConstVal::dump(const std::string &Indent) const {
   std::stringstream ss;
   ss << Indent << getName() << Strings_Datatype[T] << Bits;
@@ -3,6 +3,8 @@
 
 #include "HW.h"
 
+#include "llvm/ADT/APInt.h"
+
 
 namespace oclacc {
 
@@ -44,6 +46,9 @@ class ConstVal : public HW
       return Value;
     }
 
+    /// \brief Integer value with \p BitWidth bits.
+    llvm::APInt getAPInt(unsigned BitWidth) const;
+
     inline bool isStatic() {
       return Static;
     }
@@ -1,8 +1,10 @@
 #ifndef HW_H
 #define HW_H
 
+#include <algorithm>
 #include <vector>
 
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Value.h"
 
 #include "typedefs.h"
@@ -23,12 +25,41 @@ class HW : public Identifiable, public Visitable
 
   protected:
     unsigned BitWidth;
+    // Vector values are a concatenation of Lanes equally wide elements
+    unsigned Lanes = 1;
     const llvm::Value *IR;
     component_p Parent;
 
     HWListTy Ins;
     HWListTy Outs;
 
+    // Nodes in Ins and Outs, so connecting nodes does not search the lists.
+    typedef llvm::SmallPtrSet<const HW *, 4> HWSetTy;
+    HWSetTy InSet;
+    HWSetTy OutSet;
+
+    /// \brief Append \p P to the inputs even if it is already connected.
+    ///
+    /// Used by nodes with positional inputs.
+    inline void pushIn(const base_p &P) {
+      Ins.push_back(P);
+      InSet.insert(P.get());
+    }
+
+    /// \brief Replace input \p I by \p P or append it if \p I is the next
+    /// input.
+    inline void setIn(unsigned I, const base_p &P) {
+      if (I == Ins.size()) {
+        pushIn(P);
+        return;
+      }
+
+      assert(I < Ins.size() && "Invalid input");
+      InSet.erase(Ins[I].get());
+      Ins[I] = P;
+      InSet.insert(P.get());
+    }
+
   public:
     HW(const std::string &Name, unsigned BitWidth, llvm::Value *IR=nullptr) : Identifiable(Name), BitWidth(BitWidth), IR(IR) { 
     }
@@ -45,32 +76,32 @@ class HW : public Identifiable, public Visitable
       return Parent;
     }
 
-    inline virtual void addIn(base_p P) {
-      if (P)
-        if (std::find(Ins.begin(), Ins.end(), P) == Ins.end())
-          Ins.push_back(P);
+    inline virtual void addIn(const base_p &P) {
+      if (P && InSet.insert(P.get()).second)
+        Ins.push_back(P);
     }
 
-    inline virtual void addOut(base_p P) {
-      if (P)
-        if (std::find(Outs.begin(), Outs.end(), P) == Outs.end())
-          Outs.push_back(P);
+    inline virtual void addOut(const base_p &P) {
+      if (P && OutSet.insert(P.get()).second)
+        Outs.push_back(P);
     }
 
-    inline virtual void delIn(base_p P) {
-      if (P) {
-        HWListItTy I = std::find(Ins.begin(), Ins.end(), P);
-        if (I != Ins.end())
-          Ins.erase(I);
-      }
+    inline virtual void delIn(const base_p &P) {
+      if (P && InSet.erase(P.get()))
+        Ins.erase(std::find(Ins.begin(), Ins.end(), P));
     }
 
-    inline virtual void delOut(base_p P) {
-      if (P) {
-        HWListItTy I = std::find(Outs.begin(), Outs.end(), P);
-        if (I != Outs.end())
-          Outs.erase(I);
-      }
+    inline virtual void delOut(const base_p &P) {
+      if (P && OutSet.erase(P.get()))
+        Outs.erase(std::find(Outs.begin(), Outs.end(), P));
+    }
+
+    inline bool hasIn(const HW *P) const {
+      return InSet.count(P);
+    }
+
+    inline bool hasOut(const HW *P) const {
+      return OutSet.count(P);
     }
 
     virtual base_p getIn(unsigned I) const { return I < Ins.size() ? Ins[I] : NULL;  }
@@ -82,6 +113,9 @@ class HW : public Identifiable, public Visitable
     virtual unsigned getBitWidth() const { return BitWidth; }
     virtual void setBitWidth(unsigned W) { BitWidth=W; }
 
+    inline unsigned getLanes() const { return Lanes; }
+    inline void setLanes(unsigned L) { Lanes=L; }
+
     const llvm::Value * getIR() const { return IR; }
     void setIR(const llvm::Value *P) { IR=P; }
 
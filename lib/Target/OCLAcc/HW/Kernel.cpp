@@ -20,10 +20,13 @@ const llvm::Value * Component::getIR() const { return IR; }
 void Component::setIR(const llvm::Value *P) { IR=P; }
 
 // InScalars
+// Back-edge ports are not mapped, the Value's regular port remains valid.
 void Component::addInScalar(scalarport_p P) { 
   assert(P->getIR() != nullptr);
-  InScalarsMap[P->getIR()] = P; 
+  if (!P->isBackEdge())
+    InScalarsMap[P->getIR()] = P; 
   InScalars.push_back(P);
+  InScalarsSet.insert(P.get());
 }
 
 const Component::ScalarsTy &Component::getInScalars() const { 
@@ -45,8 +48,10 @@ scalarport_p Component::getInScalarForValue(const Value *V) {
 // OutScalars
 void Component::addOutScalar(scalarport_p P) { 
   assert(P->getIR() != nullptr);
-  OutScalarsMap[P->getIR()] = P;
+  if (!P->isBackEdge())
+    OutScalarsMap[P->getIR()] = P;
   OutScalars.push_back(P);
+  OutScalarsSet.insert(P.get());
 }
 
 const Component::ScalarsTy &Component::getOutScalars() const { 
@@ -145,15 +150,18 @@ void Block::dump() {
     outs() << " " << C.first->getUniqueName();
   }
   outs() << "\n";
+
+  if (isLoop())
+    outs() << "loop while: " << (LoopIfTrue ? "" : "!") << LoopCond->getUniqueName() << "\n";
   outs() << Line << "\n";
 
   outs() << "InScalars:\n";
   for (const scalarport_p HWP : getInScalars()) {
-    outs() << " "<< HWP->getUniqueName() << ": " << (HWP->isPipelined()? "pipelined" : "not pipelined") << "\n";
+    outs() << " "<< HWP->getUniqueName() << ": " << (HWP->isPipelined()? "pipelined" : "not pipelined") << (HWP->isBackEdge() ? ", back-edge" : "") << "\n";
   }
   outs() << "OutScalars:\n";
   for (const scalarport_p HWP : OutScalars) {
-    outs() << " "<< HWP->getUniqueName() << "\n";
+    outs() << " "<< HWP->getUniqueName() << (HWP->isBackEdge() ? ": back-edge" : "") << "\n";
   }
 
   outs() << "Loads:\n";
@@ -173,7 +181,7 @@ void Block::dump() {
 //
 // Block
 //
-Block::Block (const std::string &Name, bool EntryBlock) : Component(Name), EntryBlock(EntryBlock), Barrier(nullptr) { }
+Block::Block (const std::string &Name, bool EntryBlock) : Component(Name), EntryBlock(EntryBlock), Barrier(nullptr), LoopCond(nullptr), LoopIfTrue(true) { }
 
 // Use Kahn's algorithm without back edge detection but a map of deleted edges
 const HW::HWListTy Block::getOpsTopologicallySorted() const {
@@ -192,7 +200,14 @@ const HW::HWListTy Block::getOpsTopologicallySorted() const {
   S.insert(LD.begin(), LD.end()); // In[0] Index
   S.insert(ST.begin(), ST.end()); // In[0] Index, In[1] Value
 
-  std::map<base_p, std::set<base_p> > DelEdges;
+  llvm::SmallPtrSet<const HW *, 16> ISSet;
+  for (const scalarport_p &P : IS)
+    ISSet.insert(P.get());
+
+  // Inputs of each operation already in L. An operation is ready when all
+  // its inputs are, so the Ins of each operation are not searched again for
+  // each of its inputs.
+  std::map<const HW *, llvm::SmallPtrSet<const HW *, 4> > DelEdges;
 
   while (S.size()) {
     base_p F = *(S.begin());
@@ -200,22 +215,17 @@ const HW::HWListTy Block::getOpsTopologicallySorted() const {
 
     L.push_back(F);
     
-    for (base_p O : F->getOuts()) {
+    for (const base_p &O : F->getOuts()) {
       if (O->getParent().get() != this) continue;
 
-      bool hasOtherEdges = false;
-      DelEdges[O].insert(F);
-
-      HW::HWListTy Ins = O->getIns();
+      // Back-edges end in InScalars, which are already sorted.
+      if (ISSet.count(O.get())) continue;
 
-      for (base_p I : Ins) {
-        if (I != F && DelEdges[O].find(I) == DelEdges[O].end()) {
-          hasOtherEdges = true;
-          break;
-        }
-      }
+      llvm::SmallPtrSet<const HW *, 4> &Del = DelEdges[O.get()];
+      if (O->hasIn(F.get()))
+        Del.insert(F.get());
 
-      if (!hasOtherEdges) {
+      if (Del.size() == O->getIns().size()) {
         S.insert(O);
       }
     }
@@ -327,6 +337,20 @@ const StreamPort::StoreListTy Block::getStores() const {
   return L;
 }
 
+void Block::addIndependentAccesses(const StreamAccess &A, const StreamAccess &B) {
+  assert(A.getStream() == B.getStream() && "Accesses to different streams");
+
+  const UIDTy AUID = A.getUID();
+  const UIDTy BUID = B.getUID();
+  IndependentAccesses.insert(std::minmax(AUID, BUID));
+}
+
+bool Block::areIndependentAccesses(const StreamAccess &A, const StreamAccess &B) const {
+  const UIDTy AUID = A.getUID();
+  const UIDTy BUID = B.getUID();
+  return IndependentAccesses.count(std::minmax(AUID, BUID));
+}
+
 // 
 // Kernel
 //
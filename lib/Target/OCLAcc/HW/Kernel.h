@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <array>
 
+#include "llvm/ADT/SmallPtrSet.h"
+
 #include "typedefs.h"
 #include "Identifiable.h"
 #include "Visitor/Visitable.h"
@@ -35,11 +37,16 @@ class Component : public Identifiable, public Visitable {
     // IR pointer when a new one is to be inserted.
     typedef std::map<const llvm::Value *, scalarport_p> ScalarMapTy;
 
+    // Back-edge ports are not mapped, so membership is tracked separately.
+    typedef llvm::SmallPtrSet<const ScalarPort *, 8> ScalarSetTy;
+
     ScalarsTy InScalars;
     ScalarMapTy InScalarsMap;
+    ScalarSetTy InScalarsSet;
 
     ScalarsTy OutScalars;
     ScalarMapTy OutScalarsMap;
+    ScalarSetTy OutScalarsSet;
 
     typedef std::vector<const_p> ConstantsType;
     ConstantsType ConstVals;
@@ -55,11 +62,7 @@ class Component : public Identifiable, public Visitable {
     void addInScalar(scalarport_p);
 
     inline bool isInScalar(const ScalarPort &R) const {
-      ScalarsTy::const_iterator FI = std::find_if(InScalars.begin(), InScalars.end(), [&R](const scalarport_p V){
-          return (&R == V.get());
-      });
-
-      return (FI != InScalars.end());
+      return InScalarsSet.count(&R);
     }
 
     const ScalarsTy &getInScalars() const;
@@ -74,11 +77,7 @@ class Component : public Identifiable, public Visitable {
     const ScalarsTy &getOutScalars() const;
 
     inline bool isOutScalar(const ScalarPort &R) const {
-      ScalarsTy::const_iterator FI = std::find_if(OutScalars.begin(), OutScalars.end(), [&R](const scalarport_p V){
-          return (&R == V.get());
-      });
-
-      return (FI != OutScalars.end());
+      return OutScalarsSet.count(&R);
     }
 
     bool containsOutScalarForValue(const Value *V);
@@ -119,6 +118,14 @@ class Block : public Component {
     StreamPort::AccessListTy AccessList;
     barrier_p Barrier;
 
+    // Pairs of accesses to the same stream which never touch the same
+    // address, ordered by UID
+    std::set<std::pair<Identifiable::UIDTy, Identifiable::UIDTy> > IndependentAccesses;
+
+    // Blocks branching to themselves
+    base_p LoopCond;
+    bool LoopIfTrue;
+
   public:
     Block (const std::string &, bool);
 
@@ -191,6 +198,17 @@ class Block : public Component {
       AccessList.push_back(A);
     }
 
+    /// \brief Loads and stores in program order.
+    inline const StreamPort::AccessListTy &getStreamAccesses() const {
+      return AccessList;
+    }
+
+    /// \brief \p A and \p B access disjoint addresses, so their order need
+    /// not be kept.
+    void addIndependentAccesses(const StreamAccess &A, const StreamAccess &B);
+
+    bool areIndependentAccesses(const StreamAccess &A, const StreamAccess &B) const;
+
     const StreamPort::LoadListTy getLoads() const;
 
     inline bool hasLoads() const {
@@ -220,6 +238,28 @@ class Block : public Component {
     inline const barrier_p getBarrier() const {
       return Barrier;
     }
+
+    /// \brief The Block is a loop, which is executed again while \p C is \p
+    /// IfTrue.
+    ///
+    /// Loop-carried values are passed back through back-edge ScalarPorts, all
+    /// other outputs are only valid when the loop exits.
+    inline void setLoopCondition(base_p C, bool IfTrue) {
+      LoopCond = C;
+      LoopIfTrue = IfTrue;
+    }
+
+    inline const base_p getLoopCondition() const {
+      return LoopCond;
+    }
+
+    inline bool loopsIfTrue() const {
+      return LoopIfTrue;
+    }
+
+    inline bool isLoop() const {
+      return LoopCond != nullptr;
+    }
     
     virtual void dump() override;
 
@@ -16,11 +16,11 @@ ScalarPort::ScalarPort(const std::string &Name, unsigned W, const Datatype &T, b
 /// Stream Port
 ///
 StreamPort::StreamPort(const std::string &Name, unsigned W, ocl::AddressSpace AS, const Datatype &T, unsigned Length) 
-  : Port(Name, W, T), AddressSpace(AS), Length(Length) { }
+  : Port(Name, W, T), AddressSpace(AS), Length(Length), NoAlias(false) { }
 
 // No inline to break dependency between Stream and StreamAccess
 StreamAccess::StreamAccess(const std::string &Name, unsigned BitWidth, streamindex_p Index) : HW(Name, BitWidth) {
-  Ins.push_back(Index);
+  pushIn(Index);
 }
 
 streamport_p StreamAccess::getStream() const {
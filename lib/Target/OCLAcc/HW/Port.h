@@ -52,6 +52,9 @@ class Port : public HW {
 /// there is no need to propagate them between BBs.
 ///
 class ScalarPort : public Port {
+  private:
+    bool BackEdge = false;
+
   public:
     ScalarPort(const std::string &Name, unsigned W, const Datatype &T, bool Pipelined);
 
@@ -59,6 +62,16 @@ class ScalarPort : public Port {
       return true;
     }
 
+    /// \brief Back-edge ports pass loop-carried values from a loop Block to
+    /// itself for the next iteration.
+    inline void setBackEdge(bool B) {
+      BackEdge = B;
+    }
+
+    inline bool isBackEdge() const {
+      return BackEdge;
+    }
+
     DECLARE_VISIT;
 };
 
@@ -78,10 +91,23 @@ class StreamAccess : public HW {
 };
 
 class LoadAccess : public StreamAccess {
+  private:
+    bool Consecutive = false;
+
   public:
     LoadAccess(const std::string &Name, unsigned BitWidth, streamindex_p Index) : StreamAccess(Name, BitWidth, Index) {
     }
 
+    /// \brief Consecutive work-items load consecutive elements, i.e. the
+    /// index is the global id times the element size plus an offset.
+    inline void setConsecutive(bool C) {
+      Consecutive = C;
+    }
+
+    inline bool isConsecutive() const {
+      return Consecutive;
+    }
+
     inline virtual bool isLoad() const override {
       return true;
     }
@@ -96,7 +122,7 @@ class LoadAccess : public StreamAccess {
 class StoreAccess : public StreamAccess {
   public:
     StoreAccess(const std::string &Name, unsigned BitWidth, streamindex_p Index, base_p Value) : StreamAccess(Name, BitWidth, Index) {
-      Ins.push_back(Value);
+      pushIn(Value);
     }
 
     inline virtual bool isLoad() const override {
@@ -136,6 +162,9 @@ class StreamPort : public Port {
 
     unsigned Length;
 
+    /// Kernel argument declared restrict, no other stream refers to its memory
+    bool NoAlias;
+
   public:
     StreamPort(const std::string &Name, unsigned BitWidth, ocl::AddressSpace, const Datatype &T, unsigned Length = 0);
 
@@ -153,6 +182,14 @@ class StreamPort : public Port {
       return Length;
     }
 
+    inline void setNoAlias(bool N) {
+      NoAlias = N;
+    }
+
+    inline bool isNoAlias() const {
+      return NoAlias;
+    }
+
     inline const AccessListTy &getAccessList() const {
       return AccessList;
     }
@@ -234,10 +271,7 @@ class DynamicStreamIndex : public StreamIndex {
     DynamicStreamIndex& operator=(const DynamicStreamIndex&) = delete;
 
     inline void setIndex(base_p I) {
-      if (Ins.size() == 0)
-        Ins.push_back(I);
-      else
-        Ins[0] = I;
+      setIn(0, I);
     }
 
     inline base_p getIndex() const {
@@ -264,10 +298,7 @@ class StaticStreamIndex : public StreamIndex {
     StaticStreamIndex& operator=(const StaticStreamIndex&) = delete;
 
     virtual void setIndex(const_p I) {
-      if (Ins.size() == 0)
-        Ins.push_back(I);
-      else
-        Ins[0] = I;
+      setIn(0, I);
     }
 
     inline const_p getIndex() const {
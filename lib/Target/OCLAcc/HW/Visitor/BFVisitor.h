@@ -1,7 +1,7 @@
 #ifndef BFVISITOR_H
 #define BFVISITOR_H
 
-#include <list>
+#include <deque>
 
 #include "llvm/Support/Debug.h"
 
@@ -31,7 +31,7 @@ enum VISIT_CODES {
 class BFVisitor : public BaseVisitor
 {
   private:
-    std::list<base_p> ToVisit;
+    std::deque<base_p> ToVisit;
 
   protected:
     BFVisitor() {};
@@ -55,7 +55,7 @@ class BFVisitor : public BaseVisitor
     virtual int visit(FPArith &R) {
       DEBUG_CALL(R);
 
-      for (base_p P : R.getOuts()) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
       return VISIT_OK;
@@ -65,7 +65,7 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for (base_p P : R.getOuts()) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
       return VISIT_OK;
@@ -83,6 +83,10 @@ class BFVisitor : public BaseVisitor
     virtual int visit(URem &R) { return visit(static_cast<Arith &>  (R));}
     virtual int visit(SRem &R) { return visit(static_cast<Arith &>  (R));}
     virtual int visit(FRem &R) { return visit(static_cast<FPArith &>(R));}
+    virtual int visit(FPMath &R) { return visit(static_cast<FPArith &>(R));}
+    virtual int visit(FMA &R) { return visit(static_cast<FPArith &>(R));}
+    virtual int visit(FPToFixed &R) { return visit(static_cast<Arith &>(R));}
+    virtual int visit(FixedToFP &R) { return visit(static_cast<FPArith &>(R));}
 
     virtual int visit(Shl &R)  { return visit(static_cast<Arith &>  (R));}
     virtual int visit(LShr &R)   { return visit(static_cast<Arith &>  (R)); }
@@ -90,12 +94,14 @@ class BFVisitor : public BaseVisitor
     virtual int visit(And &R)   { return visit(static_cast<Arith &>  (R)); }
     virtual int visit(Or &R)  { return visit(static_cast<Arith &>  (R));}
     virtual int visit(Xor &R)   { return visit(static_cast<Arith &>  (R)); }
+    virtual int visit(Slice &R)  { return visit(static_cast<Arith &>  (R));}
+    virtual int visit(Concat &R)   { return visit(static_cast<Arith &>  (R)); }
 
     virtual int visit(Compare &R)
     {
       DEBUG_CALL(R);
 
-      for (base_p P : R.getOuts()) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
       return VISIT_OK;
@@ -108,7 +114,7 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
 
@@ -122,7 +128,7 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
 
@@ -134,7 +140,7 @@ class BFVisitor : public BaseVisitor
 
       ToVisit.push_back(R.index);
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
 
@@ -144,7 +150,7 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
 
@@ -158,7 +164,7 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
       return VISIT_OK;
@@ -171,7 +177,7 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for ( kernel_p P : R.Kernels ) {
+      for (const kernel_p &P : R.Kernels) {
         P->accept(*this);
       }
 
@@ -192,11 +198,11 @@ class BFVisitor : public BaseVisitor
     {
       DEBUG_CALL(R);
 
-      for ( const_p P : R.getConstVals()) {
+      for (const const_p &P : R.getConstVals()) {
         ToVisit.push_back(P);
       }
 
-      for ( base_p P : R.getInScalars() ) {
+      for (const base_p &P : R.getInScalars()) {
         ToVisit.push_back(P);
       }
       for ( streamport_p P : R.getInStreams() ) {
@@ -206,10 +212,10 @@ class BFVisitor : public BaseVisitor
         ToVisit.push_back(P);
       }
 
-      for ( base_p P : R.getOutScalars() ) {
+      for (const base_p &P : R.getOutScalars()) {
         ToVisit.push_back(P);
       }
-      for ( base_p P : R.getOutStreams() ) {
+      for (const base_p &P : R.getOutStreams()) {
         ToVisit.push_back(P);
       }
 
@@ -248,10 +254,10 @@ class BFVisitor : public BaseVisitor
 
       R.getStream()->accept(*this);
 
-      for (base_p P : R.getIns())
+      for (const base_p &P : R.getIns())
         ToVisit.push_back(P);
 
-      for (base_p P : R.getOuts())
+      for (const base_p &P : R.getOuts())
         ToVisit.push_back(P);
 
       return VISIT_OK;
@@ -269,7 +275,7 @@ class BFVisitor : public BaseVisitor
         ToVisit.push_back(P);
 #endif
 
-      for (base_p P : R.getOuts())
+      for (const base_p &P : R.getOuts())
         ToVisit.push_back(P);
 
       return VISIT_OK;
@@ -281,10 +287,10 @@ class BFVisitor : public BaseVisitor
 
       R.getStream()->accept(*this);
 
-      for (base_p P : R.getIns())
+      for (const base_p &P : R.getIns())
         ToVisit.push_back(P);
 
-      for (base_p P : R.getOuts())
+      for (const base_p &P : R.getOuts())
         ToVisit.push_back(P);
 
       return VISIT_OK;
@@ -313,11 +319,11 @@ class BFVisitor : public BaseVisitor
       DEBUG_CALL(R);
 
 
-      for ( base_p P : R.getIns() ) {
+      for (const base_p &P : R.getIns()) {
         ToVisit.push_back(P);
       }
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
 
@@ -332,7 +338,7 @@ class BFVisitor : public BaseVisitor
       if ( R.In )
         R.In->accept(*this);
 
-      for ( base_p P : R.getOuts() ) {
+      for (const base_p &P : R.getOuts()) {
         ToVisit.push_back(P);
       }
 
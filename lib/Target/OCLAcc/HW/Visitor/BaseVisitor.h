@@ -1,6 +1,7 @@
 #ifndef BASEVISITOR_H
 #define BASEVISITOR_H
 
+#include <algorithm>
 #include <vector>
 
 #include "llvm/Support/Debug.h"
@@ -8,7 +9,7 @@
 #define VISIT_ONCE(x) \
   do { unsigned UID=x.getUID(); \
   if ( UID >= already_visited.size() ) {                     \
-    already_visited.resize(already_visited.size() * 2, false); } \
+    already_visited.resize(std::max<size_t>(already_visited.size() * 2, UID + 1), false); } \
   if ( already_visited[UID] ) return 0;                      \
   else already_visited[UID] = true; \
   } while (0);
@@ -40,6 +41,10 @@ class FDiv;
 class URem;
 class SRem;
 class FRem;
+class FPMath;
+class FMA;
+class FPToFixed;
+class FixedToFP;
 
 class Shl;
 class LShr;
@@ -47,6 +52,8 @@ class AShr;
 class And;
 class Or;
 class Xor;
+class Slice;
+class Concat;
 
 class Compare;
 class IntCompare;
@@ -103,6 +110,10 @@ class BaseVisitor
     virtual int visit(URem & ) = 0;
     virtual int visit(SRem & ) = 0;
     virtual int visit(FRem & ) = 0;
+    virtual int visit(FPMath & ) = 0;
+    virtual int visit(FMA & ) = 0;
+    virtual int visit(FPToFixed & ) = 0;
+    virtual int visit(FixedToFP & ) = 0;
 
     virtual int visit(Shl & ) = 0;
     virtual int visit(LShr & )  = 0;
@@ -110,6 +121,8 @@ class BaseVisitor
     virtual int visit(And & )  = 0;
     virtual int visit(Or & ) = 0;
     virtual int visit(Xor & )  = 0;
+    virtual int visit(Slice & ) = 0;
+    virtual int visit(Concat & ) = 0;
 
     virtual int visit(Compare & ) = 0;
     virtual int visit(IntCompare & ) = 0;
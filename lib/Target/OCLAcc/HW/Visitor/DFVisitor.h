@@ -41,7 +41,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(FPArith &R) override {
       DEBUG_FUNC;
 
-      for (base_p p : R.getOuts()) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
       return 0;
@@ -50,7 +50,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(Arith &R) override {
       DEBUG_FUNC;
 
-      for (base_p p : R.getOuts()) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
       return 0;
@@ -69,6 +69,10 @@ class DFVisitor : public BaseVisitor
     virtual int visit(FMul &R) override { return visit(static_cast<FPArith &>(R));}
     virtual int visit(FDiv &R) override { return visit(static_cast<FPArith &>(R));}
     virtual int visit(FRem &R) override { return visit(static_cast<FPArith &>(R));}
+    virtual int visit(FPMath &R) override { return visit(static_cast<FPArith &>(R));}
+    virtual int visit(FMA &R) override { return visit(static_cast<FPArith &>(R));}
+    virtual int visit(FPToFixed &R) override { return visit(static_cast<Arith &>(R));}
+    virtual int visit(FixedToFP &R) override { return visit(static_cast<FPArith &>(R));}
 
     virtual int visit(Shl &R) override { return visit(static_cast<Arith &>(R));}
     virtual int visit(LShr &R) override { return visit(static_cast<Arith &>(R)); }
@@ -76,11 +80,13 @@ class DFVisitor : public BaseVisitor
     virtual int visit(And &R) override { return visit(static_cast<Arith &>(R)); }
     virtual int visit(Or &R) override { return visit(static_cast<Arith &>(R));}
     virtual int visit(Xor &R) override { return visit(static_cast<Arith &>(R)); }
+    virtual int visit(Slice &R) override { return visit(static_cast<Arith &>(R));}
+    virtual int visit(Concat &R) override { return visit(static_cast<Arith &>(R)); }
 
     virtual int visit(Compare &R) override {
       DEBUG_FUNC;
 
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
       return 0;
@@ -88,7 +94,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(IntCompare &R) override {
       DEBUG_FUNC;
 
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
       return 0;
@@ -96,7 +102,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(FPCompare &R) override {
       DEBUG_FUNC;
 
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
       return 0;
@@ -108,7 +114,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(Mux &R) override {
       DEBUG_FUNC;
 
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
 
@@ -121,7 +127,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(Reg &R) override {
       DEBUG_FUNC;
       
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
 
@@ -132,7 +138,7 @@ class DFVisitor : public BaseVisitor
 
       R.index->accept(*this);
 
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
 
@@ -141,7 +147,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(Fifo &R) override {
       DEBUG_FUNC;
 
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
 
@@ -154,7 +160,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(ConstVal &R) override {
       DEBUG_FUNC;
       
-      for ( base_p p : R.getOuts() ) {
+      for (const base_p &p : R.getOuts()) {
         p->accept(*this);
       }
       return 0;
@@ -166,7 +172,7 @@ class DFVisitor : public BaseVisitor
     virtual int visit(DesignUnit &R) override {
       DEBUG_FUNC;
 
-      for ( kernel_p p : R.getKernels() ) {
+      for (const kernel_p &p : R.getKernels()) {
         p->accept(*this);
       }
 
@@ -179,18 +185,18 @@ class DFVisitor : public BaseVisitor
     virtual int visit(Kernel &R) override {
       DEBUG_FUNC;
 
-      for ( block_p P : R.getBlocks()) {
+      for (const block_p &P : R.getBlocks()) {
         P->accept(*this);
       }
 
-      for ( port_p P : R.getIns() ) {
+      for (const port_p &P : R.getIns()) {
         P->accept(*this);
       }
-      for ( port_p P : R.getOuts() ) {
+      for (const port_p &P : R.getOuts()) {
         P->accept(*this);
       }
 
-      for ( const_p P : R.getConstVals()) {
+      for (const const_p &P : R.getConstVals()) {
         P->accept(*this);
       }
 
@@ -200,17 +206,17 @@ class DFVisitor : public BaseVisitor
     virtual int visit(Block &R) override {
       DEBUG_FUNC;
 
-      for ( port_p P : R.getInScalars() ) {
+      for (const port_p &P : R.getInScalars()) {
         P->accept(*this);
       }
-      for ( port_p P : R.getOutScalars() ) {
+      for (const port_p &P : R.getOutScalars()) {
         P->accept(*this);
       }
-      for ( base_p P : R.getOps() ) {
+      for (const base_p &P : R.getOps()) {
         P->accept(*this);
       }
 
-      for ( const_p P : R.getConstVals()) {
+      for (const const_p &P : R.getConstVals()) {
         P->accept(*this);
       }
 
@@ -255,7 +261,7 @@ class DFVisitor : public BaseVisitor
 
       R.getStream()->accept(*this);
 
-      for (base_p P : R.getOuts())
+      for (const base_p &P : R.getOuts())
         P->accept(*this);
 
       return 0;
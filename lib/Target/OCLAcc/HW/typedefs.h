@@ -61,6 +61,15 @@ typedef std::shared_ptr<Div> div_p;
 class Rem;
 typedef std::shared_ptr<Rem> rem_p;
 
+class FPMath;
+typedef std::shared_ptr<FPMath> fpmath_p;
+class FMA;
+typedef std::shared_ptr<FMA> fma_p;
+class FPToFixed;
+typedef std::shared_ptr<FPToFixed> fptofixed_p;
+class FixedToFP;
+typedef std::shared_ptr<FixedToFP> fixedtofp_p;
+
 class Shl;
 typedef std::shared_ptr<Shl> shl_p;
 
@@ -79,6 +88,12 @@ typedef std::shared_ptr<Or> or_p;
 class Xor;
 typedef std::shared_ptr<Xor> xor_p;
 
+class Slice;
+typedef std::shared_ptr<Slice> slice_p;
+
+class Concat;
+typedef std::shared_ptr<Concat> concat_p;
+
 class Mux;
 typedef std::shared_ptr<Mux> mux_p;
 
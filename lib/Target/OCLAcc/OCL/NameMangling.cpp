@@ -53,12 +53,12 @@ std::map<std::string, BuiltInFunctionName> Mappings = {
   DEF_BUILTIN("_Z4asinDv4_f"                  , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
   DEF_BUILTIN("_Z4asinDv8_f"                  , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
   DEF_BUILTIN("_Z4asinDv16_f"                 , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
-  DEF_BUILTIN("_Z4asind"                      , "acos"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
-  DEF_BUILTIN("_Z4asinDv2_d"                  , "acos"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
-  DEF_BUILTIN("_Z4asinDv3_d"                  , "acos"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
-  DEF_BUILTIN("_Z4asinDv4_d"                  , "acos"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
-  DEF_BUILTIN("_Z4asinDv8_d"                  , "acos"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
-  DEF_BUILTIN("_Z4asinDv16_d"                 , "acos"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4asind"                      , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4asinDv2_d"                  , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4asinDv3_d"                  , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4asinDv4_d"                  , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4asinDv8_d"                  , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4asinDv16_d"                 , "asin"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
 
   DEF_BUILTIN("_Z3cosf"                       , "cos"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
   DEF_BUILTIN("_Z3cosDv2_f"                   , "cos"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
@@ -86,6 +86,58 @@ std::map<std::string, BuiltInFunctionName> Mappings = {
   DEF_BUILTIN("_Z3sinDv8_d"                   , "sin"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
   DEF_BUILTIN("_Z3sinDv16_d"                  , "sin"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
 
+  DEF_BUILTIN("_Z4sqrtf"                      , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv2_f"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv3_f"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv4_f"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv8_f"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv16_f"                 , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtd"                      , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv2_d"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv3_d"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv4_d"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv8_d"                  , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z4sqrtDv16_d"                 , "sqrt"                    , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+
+  DEF_BUILTIN("_Z3expf"                       , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv2_f"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv3_f"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv4_f"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv8_f"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv16_f"                  , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expd"                       , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv2_d"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv3_d"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv4_d"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv8_d"                   , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3expDv16_d"                  , "exp"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+
+  DEF_BUILTIN("_Z3logf"                       , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv2_f"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv3_f"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv4_f"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv8_f"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv16_f"                  , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logd"                       , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv2_d"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv3_d"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv4_d"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv8_d"                   , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3logDv16_d"                  , "log"                     , 1, BuiltInFunctionName::FunctionCategory::FC_Math),
+
+  DEF_BUILTIN("_Z3powff"                      , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv2_fS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv3_fS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv4_fS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv8_fS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv16_fS_"                , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powdd"                      , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv2_dS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv3_dS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv4_dS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv8_dS_"                 , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+  DEF_BUILTIN("_Z3powDv16_dS_"                , "pow"                     , 2, BuiltInFunctionName::FunctionCategory::FC_Math),
+
   DEF_BUILTIN("llvm.fmuladd.f32"              , "fmuladd.f32"             , 3, BuiltInFunctionName::FunctionCategory::FC_IntrinsicMath),
   DEF_BUILTIN("llvm.fmuladd.f64"              , "fmuladd.f64"             , 3, BuiltInFunctionName::FunctionCategory::FC_IntrinsicMath)
 };
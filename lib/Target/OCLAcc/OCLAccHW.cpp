@@ -6,6 +6,9 @@
 #include "llvm/Analysis/CFGPrinter.h"
 #include "llvm/Analysis/LoopInfoImpl.h"
 #include "llvm/Analysis/Passes.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/Config/config.h"
@@ -18,6 +21,7 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/InstVisitor.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
@@ -39,12 +43,14 @@
 #include "Passes/HDLPromoteID.h"
 #include "Passes/ArgPromotionTracker.h"
 #include "Passes/BitWidthAnalysis.h"
-#include "Passes/FindAllPaths.h"
+#include "Passes/FixedPointAnalysis.h"
+#include "Passes/BlockRouting.h"
 #include "Passes/SplitBarrierBlocks.h"
 #include "Passes/HDLLoopUnroll.h"
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <cstdio>
 #include <map>
 #include <list>
@@ -99,6 +105,35 @@ static cl::opt<bool> clRelaxedMath("cl-relaxed-math", cl::init(false), cl::desc(
 
 static cl::opt<bool> CfgDot("cfg-dot", cl::desc("Write Dot CFG"), cl::init(false));
 
+static cl::opt<bool> NoMemDepAnalysis("no-mem-dep-analysis", cl::init(false), cl::desc("Keep the order of all loads and stores to the same stream instead of querying alias analysis.") );
+
+/// \brief Mantissa and exponent width of the floating point type \p T.
+static void getFPFormat(const Type *T, unsigned &M, unsigned &E) {
+  if (T->isHalfTy()) {
+    M=10;
+    E=5;
+  } else if (T->isFloatTy()) {
+    M=23;
+    E=8;
+  } else if (T->isDoubleTy()) {
+    M=52;
+    E=11;
+  } else if (T->isFP128Ty()) {
+    M=112;
+    E=15;
+  } else {
+    T->dump();
+    llvm_unreachable("Invalid FP Type");
+  }
+}
+
+/// \brief Number of vector lanes of \p T, 1 for scalars.
+static unsigned getNumLanes(const Type *T) {
+  if (const VectorType *VT = dyn_cast<VectorType>(T))
+    return VT->getNumElements();
+  return 1;
+}
+
 // The TargetMachine enqueues all Transformations from which we do not need any
 // info except from the transformed Module itself.
 INITIALIZE_PASS_BEGIN(OCLAccHW, "oclacc-hw", "Generate OCLAccHW",  false, true)
@@ -106,7 +141,10 @@ INITIALIZE_PASS_DEPENDENCY(ArgPromotionTracker);
 INITIALIZE_PASS_DEPENDENCY(OpenCLMDKernels);
 
 INITIALIZE_PASS_DEPENDENCY(BitWidthAnalysis);
-INITIALIZE_PASS_DEPENDENCY(FindAllPaths);
+INITIALIZE_PASS_DEPENDENCY(FixedPointAnalysis);
+INITIALIZE_PASS_DEPENDENCY(BlockRouting);
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis);
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution);
 INITIALIZE_PASS_END(OCLAccHW, "oclacc-hw", "Generate OCLAccHW",  false, true)
 
 char OCLAccHW::ID = 0;
@@ -139,7 +177,10 @@ void OCLAccHW::getAnalysisUsage(AnalysisUsage &AU) const {
 
   // Analysis
   AU.addRequired<BitWidthAnalysis>();
-  AU.addRequired<FindAllPaths>();
+  AU.addRequired<FixedPointAnalysis>();
+  AU.addRequired<BlockRouting>();
+  AU.addRequired<AliasAnalysis>();
+  AU.addRequired<ScalarEvolution>();
 
   // We do not change the Module any more
   AU.setPreservesAll();
@@ -207,16 +248,24 @@ bool OCLAccHW::runOnModule(Module &M) {
   CLK.getKernelFunctions(Kernels);
 
   for (Function *KF: Kernels) {
-    // We do currently not support loops.
+    // Loops remaining after unrolling must consist of a single BasicBlock,
+    // which becomes a Block feeding its loop-carried values back to itself.
+    // There is no controller routing a work-item around a loop of several
+    // Blocks, so loops with branches in their body are rejected.
     SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32 > Result;
     FindFunctionBackedges(*KF, Result);
     
-    if (!Result.empty())
-      report_fatal_error("Handle Loops.");
+    for (const std::pair<const BasicBlock*,const BasicBlock*> &BE : Result) {
+      if (BE.first != BE.second)
+        report_fatal_error("Loop " + BE.second->getName() + " in kernel " + KF->getName()
+            + " spans multiple BasicBlocks (back-edge from " + BE.first->getName() + "). "
+            "Only loops whose body is a single BasicBlock without branches are supported, "
+            "unroll the loop or remove the conditional code from its body.");
+    }
 
 
-    FindAllPaths &AP = getAnalysis<FindAllPaths>(*KF);
-    AP.dump();
+    BlockRouting &BR = getAnalysis<BlockRouting>(*KF);
+    BR.dump();
 
     // Print cfg
     if (CfgDot) {
@@ -260,9 +309,11 @@ void OCLAccHW::handleGlobalVariable(const GlobalVariable &G) {
     SequentialType *ST = dyn_cast<SequentialType>(ObjTy);
     if (!ST) break;
 
-    // ST may be a Pointer, Vector or Array
+    // ST may be a Pointer, Vector or Array. Vectors are the elements of a
+    // single wide BRAM.
     assert(!isa<PointerType>(ST) && "TODO Global Pointer Arrays");
-    assert(!isa<VectorType>(ST) && "TODO Global Vector Arrays");
+    if (isa<VectorType>(ST))
+      break;
 
     Length *= ST->getArrayNumElements();
 
@@ -278,6 +329,7 @@ void OCLAccHW::handleGlobalVariable(const GlobalVariable &G) {
   Datatype D = getDatatype(ObjTy);
 
   streamport_p S = makeHW<StreamPort>(&G, Name, ScalarBitWidth, AS, D, Length);
+  S->setLanes(getNumLanes(ObjTy));
 
   //Add the Stream to the Kernel and all BasicBlocks using it.
   std::set<const BasicBlock *> Blocks;
@@ -345,6 +397,11 @@ void OCLAccHW::handleKernel(const Function &F) {
   // Instructions.
   for (const BasicBlock &BB : F.getBasicBlockList()) {
     visit(const_cast<BasicBlock&>(BB));
+
+    // Loop-carried values are available after visiting the whole Block.
+    handleLoopPHIs(BB);
+
+    handleMemoryDependences(BB);
   }
 
   HWKernel->dump();
@@ -364,7 +421,7 @@ void OCLAccHW::handleKernel(const Function &F) {
 /// unnecessary ports.
 ///
 void OCLAccHW::visitBasicBlock(BasicBlock &BB) {
-  FindAllPaths &AP = getAnalysis<FindAllPaths>(*(BB.getParent()));
+  BlockRouting &BR = getAnalysis<BlockRouting>(*(BB.getParent()));
   ArgPromotionTracker &AT = getAnalysis<ArgPromotionTracker>();
 
   block_p HWBB = getBlock(&BB);
@@ -470,51 +527,49 @@ void OCLAccHW::visitBasicBlock(BasicBlock &BB) {
     const Type *IT = I->getType();
     const std::string Name = I->getName();
 
-    //const FindAllPaths::PathTy &Paths = AP.getPathFromTo(DefBB, &BB);
+    // If the current Instruction is a PHINode, we only have to route the
+    // value to the incoming blocks of the PHINode.
+    const BlockRouting::EdgeListTy Route = BR.getRouteForValue(DefBB, &BB, I);
 
-    // If the current Instruction is a PHINode, we only have to find all paths
-    // between the Value's definition and the incoming block of the PHINode.
-    const FindAllPaths::PathTy &Paths = AP.getPathForValue(DefBB, &BB, I);
+    if (IT->isIntegerTy() || IT->isFloatingPointTy() || IT->isVectorTy()) {
+      // The edges are ordered from the definition towards the use, so the
+      // source of each edge already has the value.
+      for (const BlockRouting::EdgeTy &E : Route) {
+        const BasicBlock *FromBB = E.first;
+        const BasicBlock *ToBB = E.second;
 
-    if (IT->isIntegerTy() || IT->isFloatingPointTy()) {
-      for (const FindAllPaths::SinglePathTy P : Paths) {
+        block_p HWFrom = getBlock(FromBB);
+        block_p HWTo = getBlock(ToBB);
 
-        for (FindAllPaths::SinglePathConstIt FromBBIt = P.begin(), ToBBIt = std::next(FromBBIt), E = P.end();
-            ToBBIt != E;
-            FromBBIt = ToBBIt, ++ToBBIt )
-        {
-          block_p HWFrom = getBlock(*FromBBIt);
-          block_p HWTo = getBlock(*ToBBIt);
-
-          scalarport_p HWOut;
-          scalarport_p HWIn;
+        scalarport_p HWOut;
+        scalarport_p HWIn;
 
-          // The Ports are created with isPipelined==true to indicate that it
-          // will be passed from BB to BB and that we have to create additional
-          // signals for synchronization.
-          //
-          if (!HWFrom->containsOutScalarForValue(I)) {
-            HWOut = makeHWBB<ScalarPort>(*FromBBIt, I, I->getName(), IT->getScalarSizeInBits(), getDatatype(IT), true);
-            HWFrom->addOutScalar(HWOut);
-            connect(HWI, HWOut);
-          } else
-            HWOut = HWFrom->getOutScalarForValue(I);
+        // The Ports are created with isPipelined==true to indicate that it
+        // will be passed from BB to BB and that we have to create additional
+        // signals for synchronization.
+        //
+        if (!HWFrom->containsOutScalarForValue(I)) {
+          base_p HWSrc = FromBB == DefBB ? HWI : HWFrom->getInScalarForValue(I);
 
-          if (!HWTo->containsInScalarForValue(I)) {
-            HWIn = makeHWBB<ScalarPort>(*ToBBIt, I, I->getName(), IT->getScalarSizeInBits(), getDatatype(IT), true);
-            HWTo->addInScalar(HWIn);
-          } else
-            HWIn = HWTo->getInScalarForValue(I);
+          HWOut = makeHWBB<ScalarPort>(FromBB, I, I->getName(), IT->getPrimitiveSizeInBits(), getDatatype(IT), true);
+          HWOut->setLanes(getNumLanes(IT));
+          HWFrom->addOutScalar(HWOut);
+          connect(HWSrc, HWOut);
+        } else
+          HWOut = HWFrom->getOutScalarForValue(I);
 
-          assert(HWOut && HWIn);
+        if (!HWTo->containsInScalarForValue(I)) {
+          HWIn = makeHWBB<ScalarPort>(ToBB, I, I->getName(), IT->getPrimitiveSizeInBits(), getDatatype(IT), true);
+          HWIn->setLanes(getNumLanes(IT));
+          HWTo->addInScalar(HWIn);
+        } else
+          HWIn = HWTo->getInScalarForValue(I);
 
-          // TODO: use BitWidthAnalysis
+        assert(HWOut && HWIn);
 
-          connect(HWOut, HWIn);
+        // TODO: use BitWidthAnalysis
 
-          // Proceed HWI to connect potential next blocks port to
-          HWI = HWIn;
-        }
+        connect(HWOut, HWIn);
       }
     }
     else if (IT->isPointerTy()) {
@@ -530,7 +585,7 @@ void OCLAccHW::visitBasicBlock(BasicBlock &BB) {
     const Type *IT = A->getType();
     const std::string Name = A->getName();
 
-    if (IT->isIntegerTy() || IT->isFloatingPointTy()) {
+    if (IT->isIntegerTy() || IT->isFloatingPointTy() || IT->isVectorTy()) {
       if (HWBB->containsInScalarForValue(A))
         continue;
 
@@ -586,10 +641,11 @@ void OCLAccHW::handleArgument(const Argument &A) {
 
   // Normal Scalars are not pipelined as they have the same value for all
   // WorkItems
-  if (AType->isIntegerTy() || AType->isFloatingPointTy()) {
+  if (AType->isIntegerTy() || AType->isFloatingPointTy() || AType->isVectorTy()) {
     // Promoted Arguments must be marked for the Kernel and all BBs
     bool isPromoted = AT.isPromotedArgument(&A);
-    scalarport_p HWS = makeHW<ScalarPort>(&A, Name, AType->getScalarSizeInBits(), getDatatype(AType), isPromoted);
+    scalarport_p HWS = makeHW<ScalarPort>(&A, Name, AType->getPrimitiveSizeInBits(), getDatatype(AType), isPromoted);
+    HWS->setLanes(getNumLanes(AType));
 
     HWKernel->addInScalar(HWS);
     ArgMap[&A] = HWS;
@@ -628,8 +684,14 @@ void OCLAccHW::handleArgument(const Argument &A) {
     const Type *ElementType   = AType->getPointerElementType();
     ocl::AddressSpace OAS = static_cast<ocl::AddressSpace>(AS);
 
+    // Vector elements are accessed as a whole
+    if (ElementType->isVectorTy())
+      Bits = ElementType->getPrimitiveSizeInBits();
+
     const Datatype D = getDatatype(ElementType);
     streamport_p S = makeHW<StreamPort>(&A, Name, Bits, OAS, D);
+    S->setLanes(getNumLanes(ElementType));
+    S->setNoAlias(A.hasNoAliasAttr());
     ArgMap[&A] = S;
     S->setParent(HWKernel);
 
@@ -641,6 +703,46 @@ void OCLAccHW::handleArgument(const Argument &A) {
 // Visit Functions
 //////////////////////////////////////////////////////////////////////////////
 
+/// \brief a * b + c may be fused if allowed by -cl-mad-enable, the options
+/// implying it or the fast-math flags of \p I.
+static bool isMadEnabled(const Instruction &I) {
+  return clMadEnable || clUnsafeMathOperations || clRelaxedMath || I.hasUnsafeAlgebra();
+}
+
+/// \brief \p V is an FMul only used by \p I.
+static bool isFusableMul(const Value *V, const BinaryOperator &I) {
+  const BinaryOperator *M = dyn_cast<BinaryOperator>(V);
+  if (!M || M->getOpcode() != Instruction::FMul)
+    return false;
+
+  return M->hasOneUse() && M->getParent() == I.getParent() && isMadEnabled(*M) && isMadEnabled(I);
+}
+
+/// \brief Operand of the FAdd or FSub \p I computed by the FMA, -1 if none.
+static int getFusedMulOperand(const BinaryOperator &I) {
+  if (I.getOpcode() != Instruction::FAdd && I.getOpcode() != Instruction::FSub)
+    return -1;
+
+  for (unsigned i = 0; i < 2; ++i)
+    if (isFusableMul(I.getOperand(i), I))
+      return i;
+
+  return -1;
+}
+
+/// \brief The FMul \p I is computed by the FMA of its user.
+static bool isFusedMul(const BinaryOperator &I) {
+  if (I.getOpcode() != Instruction::FMul || !I.hasOneUse())
+    return false;
+
+  const BinaryOperator *U = dyn_cast<BinaryOperator>(*I.user_begin());
+  if (!U)
+    return false;
+
+  int Idx = getFusedMulOperand(*U);
+  return Idx >= 0 && U->getOperand(Idx) == &I;
+}
+
 void OCLAccHW::visitBinaryOperator(BinaryOperator &I) {
   Value *IVal = &I;
   Type *IType = I.getType();
@@ -650,99 +752,253 @@ void OCLAccHW::visitBinaryOperator(BinaryOperator &I) {
 
   Function *F = I.getParent()->getParent();
 
+  if (isFixedPoint(&I)) {
+    handleFixedPoint(I);
+    return;
+  }
+
+  // Products consumed in fixed point are not fused
+  if (isFusedMul(I) && !isFixedPoint(cast<Instruction>(*I.user_begin())))
+    return;
+
+  int MulIdx = getFusedMulOperand(I);
+  if (MulIdx >= 0 && !isFixedPoint(cast<Instruction>(I.getOperand(MulIdx)))) {
+    const BinaryOperator *Mul = cast<BinaryOperator>(I.getOperand(MulIdx));
+    const bool IsSub = I.getOpcode() == Instruction::FSub;
+
+    // c - a * b negates the product, a * b - c the addend
+    handleFMA(I, Mul->getOperand(0), Mul->getOperand(1), I.getOperand(1-MulIdx), IsSub && MulIdx == 1, IsSub && MulIdx == 0);
+    return;
+  }
+
+  if (IType->isVectorTy()) {
+    handleVectorBinaryOperator(I);
+    return;
+  }
+
+  unsigned Bits = 0;
+
+  if (!IType->isFloatingPointTy()) {
+    BitWidthAnalysis &BW = getAnalysis<BitWidthAnalysis>(*F);
+    std::pair<int, Loopus::ExtKind> W = BW.getBitWidth(&I);
+    Bits = W.first;
+  }
+
+  base_p HWOp = makeBinaryOp(I, IType, IName, Bits);
+  BlockValueMap[BB][IVal] = HWOp;
+
+  for (Value *OpVal : I.operand_values() ) {
+    if (Constant *ConstValue = dyn_cast<Constant>(OpVal)) {
+      const_p HWConst = makeConstant(ConstValue, &I);
+
+      connect(HWConst,HWOp);
+    } else {
+      base_p HWOperand = getHW<HW>(I.getParent(), OpVal);
+
+      connect(HWOperand,HWOp);
+    }
+  }
+}
+
+bool OCLAccHW::isFixedPoint(const Instruction *I) {
+  const Function *F = I->getParent()->getParent();
+  return getAnalysis<FixedPointAnalysis>(const_cast<Function &>(*F)).isFixedPoint(I);
+}
+
+/// \brief Additions and subtractions are integer operations of the component
+/// width. Products have twice the width and are shifted back by the
+/// fractional bits.
+void OCLAccHW::handleFixedPoint(BinaryOperator &I) {
+  const BasicBlock *BB = I.getParent();
+  const std::string IName = I.getName();
+
+  Function *F = I.getParent()->getParent();
+  FixedPointAnalysis &FPA = getAnalysis<FixedPointAnalysis>(*F);
+  const FixedPointAnalysis::FixedFormatTy &Format = FPA.getFormat(&I);
+
+  const unsigned W = Format.Width;
+
   base_p HWOp;
 
-  if (IType->isVectorTy())
-    TODO("Implent vector types");
+  switch (I.getOpcode()) {
+    case Instruction::FAdd:
+      HWOp = makeHWOp<Add>(BB, &I, IName, W);
+      break;
+    case Instruction::FSub:
+      HWOp = makeHWOp<Sub>(BB, &I, IName, W);
+      break;
+    case Instruction::FMul:
+      HWOp = makeHWOp<Mul>(BB, &I, IName + "_prod", 2*W);
+      break;
+    default:
+      llvm_unreachable("Invalid fixed point operation");
+  }
+
+  for (const Use &U : I.operands())
+    connect(getFixedOperand(I, U.get()), HWOp);
+
+  if (I.getOpcode() == Instruction::FMul) {
+    base_p Prod = HWOp;
+    HWOp = makeHWOp<AShr>(BB, &I, IName, W);
+    connect(Prod, HWOp);
+
+    const_p Shift = HWArena.make<ConstVal>(Format.FracBits);
+    block_p HWBlock = getBlock(BB);
+    Shift->setParent(HWBlock);
+    HWBlock->addConstVal(Shift);
+    connect(Shift, HWOp);
+  }
+
+  FixedMap[&I] = HWOp;
+
+  bool UsedAsFP = false;
+  for (const User *U : I.users()) {
+    const Instruction *UI = cast<Instruction>(U);
+    if (UI->getParent() != BB || !isFixedPoint(UI))
+      UsedAsFP = true;
+  }
+
+  if (!UsedAsFP) {
+    BlockValueMap[BB][&I] = HWOp;
+    return;
+  }
+
+  unsigned M=0;
+  unsigned E=0;
+  getFPFormat(I.getType(), M, E);
+
+  fixedtofp_p HWConv = makeHWBB<FixedToFP>(BB, &I, IName + "_fp", W, Format.FracBits, M, E);
+  connect(HWOp, HWConv);
+}
+
+/// \brief Constants are scaled and rounded, other values entering the
+/// component are converted once per Block.
+base_p OCLAccHW::getFixedOperand(const BinaryOperator &I, const Value *V) {
+  const BasicBlock *BB = I.getParent();
+
+  const Function *F = BB->getParent();
+  FixedPointAnalysis &FPA = getAnalysis<FixedPointAnalysis>(const_cast<Function &>(*F));
+  const FixedPointAnalysis::FixedFormatTy &Format = FPA.getFormat(&I);
+
+  const unsigned W = Format.Width;
+
+  if (const Instruction *VI = dyn_cast<Instruction>(V)) {
+    if (VI->getParent() == BB && FPA.isFixedPoint(VI)) {
+      ValueMapIt FI = FixedMap.find(VI);
+      assert(FI != FixedMap.end() && "Fixed point operand not yet visited");
+      return FI->second;
+    }
+  }
+
+  if (const ConstantFP *C = dyn_cast<ConstantFP>(V)) {
+    APFloat FV = C->getValueAPF();
+    bool LosesInfo;
+    FV.convert(APFloat::IEEEdouble, APFloat::rmNearestTiesToEven, &LosesInfo);
+
+    const double Scaled = std::round(std::ldexp(FV.convertToDouble(), Format.FracBits));
+    const APInt Fixed = APIntOps::RoundDoubleToAPInt(Scaled, W);
+
+    const_p HWConst = HWArena.make<ConstVal>(Fixed.toString(10, true), Fixed.toString(2, false), W);
+    block_p HWBlock = getBlock(BB);
+    HWConst->setParent(HWBlock);
+    HWBlock->addConstVal(HWConst);
+
+    return HWConst;
+  }
+
+  const auto Key = std::make_tuple(BB, V, W, Format.FracBits);
+  FixedConvMapTy::iterator CI = FixedConvMap.find(Key);
+  if (CI != FixedConvMap.end())
+    return CI->second;
+
+  unsigned M=0;
+  unsigned E=0;
+  getFPFormat(V->getType(), M, E);
+
+  const std::string Name = V->getName().str() + "_fixed";
+
+  fptofixed_p HWConv = makeHWOp<FPToFixed>(BB, &I, Name, W, Format.FracBits, M, E);
+  connect(getHW<HW>(BB, V), HWConv);
+
+  FixedConvMap[Key] = HWConv;
+
+  return HWConv;
+}
+
+base_p OCLAccHW::makeBinaryOp(const BinaryOperator &I, const Type *IType, const std::string &IName, unsigned Bits) {
+  const Value *IVal = &I;
+  const BasicBlock *BB = I.getParent();
+
+  base_p HWOp;
 
   if (IType->isFloatingPointTy()) {
     unsigned E=0;
     unsigned M=0;
 
-    if (IType->isHalfTy()) {
-      M=10;
-      E=5;
-    } else if (IType->isFloatTy()) {
-      M=23;
-      E=8;
-    } else if (IType->isDoubleTy()) {
-      M=52;
-      E=11;
-    } else if (IType->isFP128Ty()) {
-      M=112;
-      E=15;
-    } else {
-      I.dump();
-      assert(0 && "Invalid FP Type");
-    }
+    getFPFormat(IType, M, E);
 
     switch (I.getOpcode()) {
       case Instruction::FAdd:
-        HWOp = makeHWBB<FAdd>(BB, IVal, IName, M, E);
+        HWOp = makeHWOp<FAdd>(BB, IVal, IName, M, E);
         break;
       case Instruction::FMul:
-        HWOp = makeHWBB<FMul>(BB, IVal,IName, M, E);
+        HWOp = makeHWOp<FMul>(BB, IVal,IName, M, E);
         break;
       case Instruction::FRem:
-        HWOp = makeHWBB<FRem>(BB, IVal,IName, M, E);
+        HWOp = makeHWOp<FRem>(BB, IVal,IName, M, E);
         break;
       case Instruction::FSub:
-        HWOp = makeHWBB<FSub>(BB, IVal,IName, M, E);
+        HWOp = makeHWOp<FSub>(BB, IVal,IName, M, E);
         break;
       case Instruction::FDiv:
-        HWOp = makeHWBB<FDiv>(BB, IVal,IName, M, E);
+        HWOp = makeHWOp<FDiv>(BB, IVal,IName, M, E);
         break;
       default:
         assert(0 && "Invalid FP Binary Op");
     }
   } else {
-
-    BitWidthAnalysis &BW = getAnalysis<BitWidthAnalysis>(*F);
-    std::pair<int, Loopus::ExtKind> W = BW.getBitWidth(&I);
-    unsigned Bits = W.first;
-
     // It depends on the Instruction if values have to be interpreted as signed or
     // unsigned.
     switch ( I.getOpcode() ) {
       case Instruction::Add:
-        HWOp = makeHWBB<Add>(BB, IVal, IName,Bits);
+        HWOp = makeHWOp<Add>(BB, IVal, IName,Bits);
         break;
       case Instruction::Sub:
-        HWOp = makeHWBB<Sub>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<Sub>(BB, IVal,IName,Bits);
         break;
       case Instruction::Mul:
-        HWOp = makeHWBB<Mul>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<Mul>(BB, IVal,IName,Bits);
         break;
       case Instruction::UDiv:
-        HWOp = makeHWBB<UDiv>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<UDiv>(BB, IVal,IName,Bits);
         break;
       case Instruction::SDiv:
-        HWOp = makeHWBB<SDiv>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<SDiv>(BB, IVal,IName,Bits);
         break;
       case Instruction::URem:
-        HWOp = makeHWBB<URem>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<URem>(BB, IVal,IName,Bits);
         break;
       case Instruction::SRem:
-        HWOp = makeHWBB<SRem>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<SRem>(BB, IVal,IName,Bits);
         break;
         //Logical
       case Instruction::Shl:
-        HWOp = makeHWBB<Shl>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<Shl>(BB, IVal,IName,Bits);
         break;
       case Instruction::LShr:
-        HWOp = makeHWBB<LShr>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<LShr>(BB, IVal,IName,Bits);
         break;
       case Instruction::AShr:
-        HWOp = makeHWBB<AShr>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<AShr>(BB, IVal,IName,Bits);
         break;
       case Instruction::And:
-        HWOp = makeHWBB<And>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<And>(BB, IVal,IName,Bits);
         break;
       case Instruction::Or:
-        HWOp = makeHWBB<Or>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<Or>(BB, IVal,IName,Bits);
         break;
       case Instruction::Xor:
-        HWOp = makeHWBB<Xor>(BB, IVal,IName,Bits);
+        HWOp = makeHWOp<Xor>(BB, IVal,IName,Bits);
         break;
 
       default:
@@ -751,17 +1007,145 @@ void OCLAccHW::visitBinaryOperator(BinaryOperator &I) {
     }
   }
 
-  for (Value *OpVal : I.operand_values() ) {
-    if (Constant *ConstValue = dyn_cast<Constant>(OpVal)) {
-      const_p HWConst = makeConstant(ConstValue, &I);
+  return HWOp;
+}
 
-      connect(HWConst,HWOp);
-    } else {
-      base_p HWOperand = getHW<HW>(I.getParent(), OpVal);
+/// \brief Vector operations are computed by a scalar operator per lane. All
+/// lanes are part of the same Block and thus share its state machine.
+void OCLAccHW::handleVectorBinaryOperator(BinaryOperator &I) {
+  VectorType *VT = cast<VectorType>(I.getType());
+  const Type *ET = VT->getElementType();
+  const std::string IName = I.getName();
 
-      connect(HWOperand,HWOp);
-    }
+  std::vector<base_p> Lanes;
+
+  for (unsigned L = 0, E = VT->getNumElements(); L < E; ++L) {
+    base_p HWOp = makeBinaryOp(I, ET, IName + "_" + std::to_string(L), ET->getPrimitiveSizeInBits());
+
+    for (Value *OpVal : I.operand_values())
+      connect(getLane(&I, OpVal, L), HWOp);
+
+    Lanes.push_back(HWOp);
+  }
+
+  BlockValueMap[I.getParent()][&I] = makeVector(&I, VT, Lanes);
+}
+
+const_p OCLAccHW::makeLaneConstant(const Constant *C, const Instruction *I) {
+  if (isa<UndefValue>(C))
+    C = Constant::getNullValue(C->getType());
+
+  const ConstantInt *IConst = dyn_cast<ConstantInt>(C);
+  if (!IConst)
+    return makeConstant(C, I);
+
+  // Lanes are not extended, so keep the full width.
+  const APInt &Int = IConst->getValue();
+
+  const_p HWConst = HWArena.make<ConstVal>(std::to_string(Int.getSExtValue()), Int.toString(2, false), Int.getBitWidth());
+
+  block_p HWBlock = getBlock(I->getParent());
+  HWConst->setParent(HWBlock);
+  HWBlock->addConstVal(HWConst);
+
+  return HWConst;
+}
+
+base_p OCLAccHW::getLane(const Instruction *I, const Value *V, unsigned Lane) {
+  const BasicBlock *BB = I->getParent();
+  const VectorType *VT = cast<VectorType>(V->getType());
+  const Type *ET = VT->getElementType();
+
+  assert(Lane < VT->getNumElements() && "Invalid lane");
+
+  if (const Constant *C = dyn_cast<Constant>(V))
+    return makeLaneConstant(C->getAggregateElement(Lane), I);
+
+  base_p HWV = getHW<HW>(BB, V);
+
+  LaneMapTy::const_iterator LI = LaneMap.find(std::make_pair(HWV.get(), Lane));
+  if (LI != LaneMap.end())
+    return LI->second;
+
+  const std::string Name = V->getName().str() + "_" + std::to_string(Lane);
+
+  slice_p HWS = makeHWOp<Slice>(BB, V, Name, ET->getPrimitiveSizeInBits(), Lane, ET->isFloatingPointTy());
+  connect(HWV, HWS);
+
+  LaneMap[std::make_pair(HWV.get(), Lane)] = HWS;
+
+  return HWS;
+}
+
+concat_p OCLAccHW::makeVector(const Instruction *I, VectorType *VT, const std::vector<base_p> &Lanes) {
+  assert(Lanes.size() == VT->getNumElements());
+
+  const std::string Name = I->hasName() ? I->getName().str() : "vector";
+
+  concat_p HWC = makeHWOp<Concat>(I->getParent(), I, Name, VT->getPrimitiveSizeInBits(), VT->getNumElements(), VT->getElementType()->isFloatingPointTy());
+
+  for (base_p L : Lanes) {
+    HWC->addElement(L);
+    connect(L, HWC);
   }
+
+  return HWC;
+}
+
+/// \brief Map the lane to the instruction. Dynamic indices would require a
+/// multiplexer and are not supported.
+void OCLAccHW::visitExtractElementInst(ExtractElementInst &I) {
+  const ConstantInt *Idx = dyn_cast<ConstantInt>(I.getIndexOperand());
+  if (!Idx)
+    report_fatal_error("Dynamic index of vector " + I.getVectorOperand()->getName() + " not supported");
+
+  base_p HWL = getLane(&I, I.getVectorOperand(), Idx->getZExtValue());
+
+  BlockValueMap[I.getParent()][&I] = HWL;
+}
+
+void OCLAccHW::visitInsertElementInst(InsertElementInst &I) {
+  const ConstantInt *Idx = dyn_cast<ConstantInt>(I.getOperand(2));
+  if (!Idx)
+    report_fatal_error("Dynamic index of vector " + I.getName() + " not supported");
+
+  VectorType *VT = I.getType();
+  const Value *Vec = I.getOperand(0);
+  const Value *Elem = I.getOperand(1);
+
+  std::vector<base_p> Lanes;
+
+  for (unsigned L = 0, E = VT->getNumElements(); L < E; ++L) {
+    if (L != Idx->getZExtValue())
+      Lanes.push_back(getLane(&I, Vec, L));
+    else if (const Constant *C = dyn_cast<Constant>(Elem))
+      Lanes.push_back(makeLaneConstant(C, &I));
+    else
+      Lanes.push_back(getHW<HW>(I.getParent(), Elem));
+  }
+
+  BlockValueMap[I.getParent()][&I] = makeVector(&I, VT, Lanes);
+}
+
+/// \brief Shuffles are pure wiring of the lanes of both operands.
+void OCLAccHW::visitShuffleVectorInst(ShuffleVectorInst &I) {
+  VectorType *VT = I.getType();
+  const unsigned Op0Lanes = cast<VectorType>(I.getOperand(0)->getType())->getNumElements();
+
+  std::vector<base_p> Lanes;
+
+  for (unsigned L = 0, E = VT->getNumElements(); L < E; ++L) {
+    const int M = I.getMaskValue(L);
+
+    if (M < 0)
+      Lanes.push_back(makeLaneConstant(UndefValue::get(VT->getElementType()), &I));
+    else if (static_cast<unsigned>(M) < Op0Lanes)
+      Lanes.push_back(getLane(&I, I.getOperand(0), M));
+    else
+      Lanes.push_back(getLane(&I, I.getOperand(1), M - Op0Lanes));
+  }
+
+  BlockValueMap[I.getParent()][&I] = makeVector(&I, VT, Lanes);
 }
 
 void OCLAccHW::visitLoadInst(LoadInst &I)
@@ -790,10 +1174,10 @@ void OCLAccHW::visitLoadInst(LoadInst &I)
     HWStream = HWStreamIndex->getStream();
   } else {
     HWStream = getHW<StreamPort>(Parent, AddrVal);
-    const_p HWIndex = std::make_shared<ConstVal>("0", "0", 1);
+    const_p HWIndex = HWArena.make<ConstVal>("0", "0", 1);
     HWParent->addConstVal(HWIndex);
 
-    HWStreamIndex = std::make_shared<StaticStreamIndex>("unnamed_idx", HWStream, HWIndex, 1);
+    HWStreamIndex = HWArena.make<StaticStreamIndex>("unnamed_idx", HWStream, HWIndex, 1);
 
     connect(HWIndex, HWStreamIndex);
 
@@ -811,7 +1195,10 @@ void OCLAccHW::visitLoadInst(LoadInst &I)
   // TODO: Maybe we should support Non-primitive types
   assert(BitWidth && "FIXME: Type not primitive");
 
+  // Vectors are loaded by a single wide access
   loadaccess_p HWLoad = makeHWBB<LoadAccess>(Parent, &I, Name, BitWidth, HWStreamIndex);
+  HWLoad->setLanes(getNumLanes(T));
+  HWLoad->setConsecutive(AddrSpace == ocl::AS_GLOBAL && isConsecutiveInWorkItems(I));
 
   connect(HWStreamIndex, HWLoad);
 
@@ -870,8 +1257,15 @@ void OCLAccHW::visitStoreInst(StoreInst &I) {
   //Get Data to store
 
   if (const Constant *ConstValue = dyn_cast<Constant>(DataVal) ) {
-    const_p HWConst = makeConstant(ConstValue, &I);
-    HWData = HWConst;
+    if (VectorType *VT = dyn_cast<VectorType>(DataVal->getType())) {
+      std::vector<base_p> Lanes;
+      for (unsigned L = 0, E = VT->getNumElements(); L < E; ++L)
+        Lanes.push_back(getLane(&I, DataVal, L));
+      HWData = makeVector(&I, VT, Lanes);
+    } else {
+      const_p HWConst = makeConstant(ConstValue, &I);
+      HWData = HWConst;
+    }
   } else {
     HWData = getHW<HW>(Parent, DataVal);
   }
@@ -895,10 +1289,10 @@ void OCLAccHW::visitStoreInst(StoreInst &I) {
     HWStream = HWStreamIndex->getStream();
   }
   else if ((HWStream = std::dynamic_pointer_cast<StreamPort>(HWOut))) {
-    const_p HWIndex = std::make_shared<ConstVal>("0", "0", 1);
+    const_p HWIndex = HWArena.make<ConstVal>("0", "0", 1);
     HWParent->addConstVal(HWIndex);
 
-    HWStreamIndex = std::make_shared<StaticStreamIndex>("unnamed_idx", HWStream, HWIndex, 1);
+    HWStreamIndex = HWArena.make<StaticStreamIndex>("unnamed_idx", HWStream, HWIndex, 1);
     connect(HWIndex, HWStreamIndex);
   }
   else {
@@ -925,6 +1319,7 @@ void OCLAccHW::visitStoreInst(StoreInst &I) {
   assert(StreamBitWidth >= BitWidth);
 
   storeaccess_p HWStore = makeHWBB<StoreAccess>(Parent, &I, Name, BitWidth, HWStreamIndex, HWData);
+  HWStore->setLanes(getNumLanes(T));
 
   connect(HWStreamIndex, HWStore);
 
@@ -985,14 +1380,14 @@ const_p OCLAccHW::makeConstant(const Constant *C, const Instruction *I) {
         {
           const std::string S = Int.toString(2, true);
           CName = std::to_string(Int.getSExtValue());
-          HWConst = std::make_shared<ConstVal>(CName, S, BitWidth);
+          HWConst = HWArena.make<ConstVal>(CName, S, BitWidth);
           break;
         }
       case Loopus::ZExt:
         {
           const std::string U = Int.toString(2, false);
           CName = std::to_string(Int.getZExtValue());
-          HWConst = std::make_shared<ConstVal>(CName, U, BitWidth);
+          HWConst = HWArena.make<ConstVal>(CName, U, BitWidth);
           break;
         }
       case Loopus::OneExt:
@@ -1000,7 +1395,7 @@ const_p OCLAccHW::makeConstant(const Constant *C, const Instruction *I) {
           TODO("makeConstant OneExt");
           const std::string S = Int.toString(2, true);
           CName = std::to_string(Int.getSExtValue());
-          HWConst = std::make_shared<ConstVal>(CName, S, BitWidth);
+          HWConst = HWArena.make<ConstVal>(CName, S, BitWidth);
           break;
         }
       default:
@@ -1011,7 +1406,7 @@ const_p OCLAccHW::makeConstant(const Constant *C, const Instruction *I) {
         {
           const std::string S = Int.toString(2, true);
           CName = std::to_string(Int.getSExtValue());
-          HWConst = std::make_shared<ConstVal>(CName, S, Int.getMinSignedBits());
+          HWConst = HWArena.make<ConstVal>(CName, S, Int.getMinSignedBits());
           break;
         }
     }
@@ -1027,7 +1422,7 @@ const_p OCLAccHW::makeConstant(const Constant *C, const Instruction *I) {
       CName = std::to_string(FV.convertToFloat());
       const std::string V = Bits.toString(2, false);
 
-      HWConst = std::make_shared<ConstVal>(CName, Half, V, Bits.getBitWidth());
+      HWConst = HWArena.make<ConstVal>(CName, Half, V, Bits.getBitWidth());
     }
     else if (CType->isFloatTy()) {
       const APInt Bits = FV.bitcastToAPInt();
@@ -1035,7 +1430,7 @@ const_p OCLAccHW::makeConstant(const Constant *C, const Instruction *I) {
       CName = std::to_string(FV.convertToFloat());
       const std::string V = Bits.toString(2, false);
 
-      HWConst = std::make_shared<ConstVal>(CName, Float, V, Bits.getBitWidth());
+      HWConst = HWArena.make<ConstVal>(CName, Float, V, Bits.getBitWidth());
 
     }
     else if (CType->isDoubleTy()) {
@@ -1044,7 +1439,7 @@ const_p OCLAccHW::makeConstant(const Constant *C, const Instruction *I) {
       CName = std::to_string(FV.convertToDouble());
       const std::string V = Bits.toString(2, false);
 
-      HWConst = std::make_shared<ConstVal>(CName, Double, V, Bits.getBitWidth());
+      HWConst = HWArena.make<ConstVal>(CName, Double, V, Bits.getBitWidth());
     } else
       assert(0 && "Unknown floating point type");
   } else
@@ -1070,12 +1465,25 @@ void OCLAccHW::visitCallInst(CallInst &I) {
   Function *F = Parent->getParent();
   kernel_p HWF = getKernel(F);
 
+  // llvm.fmuladd may always be fused, also for vectors
+  if (const IntrinsicInst *II = dyn_cast<IntrinsicInst>(&I)) {
+    if (II->getIntrinsicID() == Intrinsic::fmuladd) {
+      handleFMA(I, I.getArgOperand(0), I.getArgOperand(1), I.getArgOperand(2), false, false);
+      return;
+    }
+  }
+
   assert(ocl::NameMangling::isKnownName(CN) && "Unknown or invalid Builtin");
 
   if (ocl::NameMangling::isWorkItemFunction(CN)) {
     assert(0 && "Run pass to inline WorkItem builtins");
   }
 
+  if (ocl::NameMangling::isArithmeticFunction(CN)) {
+    handleMathFunction(I);
+    return;
+  }
+
   // If barriers are used, the attributes reqd or max workgroup size must be set
   // to avoid unnecessary hardware generation.
   if (ocl::NameMangling::isSynchronizationFunction(CN)) {
@@ -1103,15 +1511,155 @@ void OCLAccHW::visitCallInst(CallInst &I) {
       report_fatal_error("Specify '__attribute__((reqd_work_group_size(x,y,z)))' for function " + F->getName() + " when using barriers.");
     }
 
-    barrier_p HWB = std::make_shared<Barrier>(HWParent->getUniqueName()+"_barrier", FF, MS);
+    barrier_p HWB = HWArena.make<Barrier>(HWParent->getUniqueName()+"_barrier", FF, MS);
     HWParent->addBarrier(HWB);
   }
 }
 
+/// \brief Compute A * B + C by an FMA operator, vectors by one per lane.
+void OCLAccHW::handleFMA(Instruction &I, const Value *A, const Value *B, const Value *C, bool NegateAB, bool NegateC) {
+  const BasicBlock *BB = I.getParent();
+  const std::string IName = I.getName();
+
+  Type *IType = I.getType();
+  VectorType *VT = dyn_cast<VectorType>(IType);
+  const Type *ET = VT ? VT->getElementType() : IType;
+
+  unsigned M=0;
+  unsigned E=0;
+  getFPFormat(ET, M, E);
+
+  const Value *Ops[] = {A, B, C};
+
+  if (!VT) {
+    fma_p HWF = makeHWBB<FMA>(BB, &I, IName, M, E, NegateAB, NegateC);
+
+    for (const Value *V : Ops) {
+      base_p HWO;
+
+      if (const Constant *CV = dyn_cast<Constant>(V))
+        HWO = makeConstant(CV, &I);
+      else
+        HWO = getHW<HW>(BB, V);
+
+      HWF->addOperand(HWO);
+      connect(HWO, HWF);
+    }
+    return;
+  }
+
+  std::vector<base_p> Lanes;
+
+  for (unsigned L = 0, LE = VT->getNumElements(); L < LE; ++L) {
+    fma_p HWF = makeHWOp<FMA>(BB, &I, IName + "_" + std::to_string(L), M, E, NegateAB, NegateC);
+
+    for (const Value *V : Ops) {
+      base_p HWO = getLane(&I, V, L);
+      HWF->addOperand(HWO);
+      connect(HWO, HWF);
+    }
+
+    Lanes.push_back(HWF);
+  }
+
+  BlockValueMap[BB][&I] = makeVector(&I, VT, Lanes);
+}
+
+/// \brief Compute math builtins by pipelined FloPoCo function cores, vectors
+/// by a core per lane.
+void OCLAccHW::handleMathFunction(CallInst &I) {
+  const std::string CN = I.getCalledValue()->getName().str();
+  const std::string UName = ocl::NameMangling::unmangleName(CN);
+  const BasicBlock *BB = I.getParent();
+
+  FPMath::FuncTy Func;
+  if (UName == "sqrt")
+    Func = FPMath::Sqrt;
+  else if (UName == "exp")
+    Func = FPMath::Exp;
+  else if (UName == "log")
+    Func = FPMath::Log;
+  else if (UName == "pow")
+    Func = FPMath::Pow;
+  else if (UName == "sin")
+    Func = FPMath::Sin;
+  else if (UName == "cos")
+    Func = FPMath::Cos;
+  else
+    report_fatal_error("Math function " + UName + " not supported in hardware");
+
+  Type *IType = I.getType();
+  VectorType *VT = dyn_cast<VectorType>(IType);
+  const Type *ET = VT ? VT->getElementType() : IType;
+
+  unsigned M=0;
+  unsigned E=0;
+  getFPFormat(ET, M, E);
+
+  const std::string IName = I.getName();
+
+  if (!VT) {
+    fpmath_p HWM = makeHWBB<FPMath>(BB, &I, IName, Func, M, E);
+
+    for (unsigned i = 0; i < I.getNumArgOperands(); ++i) {
+      const Value *V = I.getArgOperand(i);
+
+      base_p HWO;
+      if (const Constant *C = dyn_cast<Constant>(V))
+        HWO = makeConstant(C, &I);
+      else
+        HWO = getHW<HW>(BB, V);
+
+      HWM->addOperand(HWO);
+      connect(HWO, HWM);
+    }
+    return;
+  }
+
+  std::vector<base_p> Lanes;
+
+  for (unsigned L = 0, LE = VT->getNumElements(); L < LE; ++L) {
+    fpmath_p HWM = makeHWOp<FPMath>(BB, &I, IName + "_" + std::to_string(L), Func, M, E);
+
+    for (unsigned i = 0; i < I.getNumArgOperands(); ++i) {
+      base_p HWO = getLane(&I, I.getArgOperand(i), L);
+      HWM->addOperand(HWO);
+      connect(HWO, HWM);
+    }
+
+    Lanes.push_back(HWM);
+  }
+
+  BlockValueMap[BB][&I] = makeVector(&I, VT, Lanes);
+}
+
 void OCLAccHW::visitCmpInst(CmpInst &I) {
   // We currently directly use the llvm Predicate.
   Compare::PredTy P = static_cast<Compare::PredTy>(I.getPredicate());
 
+  // Compare each lane
+  if (VectorType *VT = dyn_cast<VectorType>(I.getType())) {
+    std::vector<base_p> Lanes;
+
+    for (unsigned L = 0, E = VT->getNumElements(); L < E; ++L) {
+      const std::string Name = I.getName().str() + "_" + std::to_string(L);
+
+      cmp_p HWC;
+      if (I.isFPPredicate())
+        HWC = makeHWOp<FPCompare>(I.getParent(), &I, Name, P);
+      else
+        HWC = makeHWOp<IntCompare>(I.getParent(), &I, Name, P);
+
+      for (const Use &U : I.operands())
+        connect(getLane(&I, U.get(), L), HWC);
+
+      Lanes.push_back(HWC);
+    }
+
+    BlockValueMap[I.getParent()][&I] = makeVector(&I, VT, Lanes);
+    return;
+  }
+
   cmp_p HWC;
   if (I.isFPPredicate()) {
     HWC = makeHWBB<FPCompare>(I.getParent(), &I, I.getName() , P);
@@ -1144,6 +1692,7 @@ void OCLAccHW::visitPHINode(PHINode &I) {
   const block_p HWBB = getBlock(BB);
 
   mux_p HWM = makeHWBB<Mux>(BB, &I, I.getName(), W.first);
+  HWM->setLanes(getNumLanes(I.getType()));
 
   ODEBUG("Block " << BB->getName());
   ODEBUG("\tPHI " << I.getName());
@@ -1151,6 +1700,10 @@ void OCLAccHW::visitPHINode(PHINode &I) {
     const BasicBlock *FromBB = I.getIncomingBlock(i);
     const Value *V = I.getIncomingValue(i);
 
+    // Loop-carried values are handled by handleLoopPHIs()
+    if (FromBB == BB)
+      continue;
+
     port_p HWP = getHW<Port>(BB, V);
     block_p HWB = getBlock(FromBB);
 
@@ -1162,7 +1715,7 @@ void OCLAccHW::visitPHINode(PHINode &I) {
 
     if (!Cond && !NegCond) {
       // Unconditional branch from FromBB to BB
-      const_p HWConst = std::make_shared<ConstVal>("1", "1", 1);
+      const_p HWConst = HWArena.make<ConstVal>("1", "1", 1);
       HWBB->addConstVal(HWConst);
       HWM->addIn(HWP, HWConst);
       connect(HWConst, HWM);
@@ -1211,7 +1764,7 @@ void OCLAccHW::visitBranchInst(BranchInst &I) {
 
   if (I.isUnconditional()) {
     // No condition, so all Ports can be used when ready.
-    const_p HWConst = std::make_shared<ConstVal>("1", "1", 1);
+    const_p HWConst = HWArena.make<ConstVal>("1", "1", 1);
     HWBB->addConstVal(HWConst);
 
     BasicBlock *SuccBB = I.getSuccessor(0);
@@ -1255,12 +1808,16 @@ void OCLAccHW::visitBranchInst(BranchInst &I) {
     HWBB->addOutScalar(HWPort);
     connect(HWCond, HWPort);
   } else {
-    HWBB->getOutScalarForValue(Cond);
+    HWPort = HWBB->getOutScalarForValue(Cond);
   }
 
   // Create inputs like normal Inputs but add them as Condition to the Block if
-  // Cond is not already valid in the successor Blocks
-  if (isValueInBB(TrueBB, Cond)) {
+  // Cond is not already valid in the successor Blocks. A Block branching to
+  // itself is a loop and receives the condition through a back-edge.
+  if (TrueBB == BB) {
+    HWCondTrue = makeBackEdge(BB, Cond, HWCond);
+    HWBB->setLoopCondition(HWCond, true);
+  } else if (isValueInBB(TrueBB, Cond)) {
     HWCondTrue = getHW<ScalarPort>(TrueBB, Cond);
   } else {
     HWCondTrue = makeHWBB<ScalarPort>(TrueBB, Cond, Cond->getName(), CIT->getScalarSizeInBits(), getDatatype(CIT), true);
@@ -1268,7 +1825,10 @@ void OCLAccHW::visitBranchInst(BranchInst &I) {
     connect(HWPort, HWCondTrue);
   }
 
-  if (isValueInBB(FalseBB, Cond)) {
+  if (FalseBB == BB) {
+    HWCondFalse = makeBackEdge(BB, Cond, HWCond);
+    HWBB->setLoopCondition(HWCond, false);
+  } else if (isValueInBB(FalseBB, Cond)) {
     HWCondFalse = getHW<ScalarPort>(FalseBB, Cond);
   } else {
     HWCondFalse = makeHWBB<ScalarPort>(FalseBB, Cond, Cond->getName(), CIT->getScalarSizeInBits(), getDatatype(CIT), true);
@@ -1286,6 +1846,218 @@ void OCLAccHW::visitBranchInst(BranchInst &I) {
 
 }
 
+/// \brief Create a back-edge from \p BB to itself passing \p HWV to the next
+/// loop iteration.
+///
+/// Both ports are marked as back-edge, so they are not used for \p IR by
+/// other Blocks. Return the InScalar.
+scalarport_p OCLAccHW::makeBackEdge(const BasicBlock *BB, const Value *IR, base_p HWV) {
+  block_p HWBB = getBlock(BB);
+
+  const Type *IT = IR->getType();
+  const std::string Name = IR->getName().str() + "_next";
+
+  scalarport_p HWOut = makeHW<ScalarPort>(IR, Name, IT->getScalarSizeInBits(), getDatatype(IT), true);
+  HWOut->setBackEdge(true);
+  HWOut->setParent(HWBB);
+  HWBB->addOp(HWOut);
+  HWBB->addOutScalar(HWOut);
+
+  scalarport_p HWIn = makeHW<ScalarPort>(IR, Name, IT->getScalarSizeInBits(), getDatatype(IT), true);
+  HWIn->setBackEdge(true);
+  HWIn->setParent(HWBB);
+  HWBB->addOp(HWIn);
+  HWBB->addInScalar(HWIn);
+
+  connect(HWV, HWOut);
+  connect(HWOut, HWIn);
+
+  return HWIn;
+}
+
+/// \brief Add the loop-carried inputs of all PHINodes in \p BB.
+///
+/// The values are defined after the PHINodes, so the back-edges are created
+/// after the whole Block and its branch condition have been visited.
+void OCLAccHW::handleLoopPHIs(const BasicBlock &BB) {
+  block_p HWBB = getBlock(&BB);
+
+  for (const Instruction &I : BB.getInstList()) {
+    const PHINode *PHI = dyn_cast<PHINode>(&I);
+    if (!PHI) break;
+
+    mux_p HWM = getHW<Mux>(&BB, PHI);
+
+    for (unsigned i = 0; i < PHI->getNumIncomingValues(); ++i) {
+      if (PHI->getIncomingBlock(i) != &BB)
+        continue;
+
+      const Value *V = PHI->getIncomingValue(i);
+
+      base_p HWV;
+      if (const Constant *C = dyn_cast<Constant>(V))
+        HWV = makeConstant(C, PHI);
+      else
+        HWV = getHW<HW>(&BB, V);
+
+      scalarport_p HWP = makeBackEdge(&BB, PHI, HWV);
+
+      base_p Cond = HWBB->getCondReachedByBlock(HWBB);
+      if (!Cond)
+        Cond = HWBB->getNegCondReachedByBlock(HWBB);
+      assert(Cond && "Loop without back-edge condition");
+
+      ODEBUG("\tPHI " << PHI->getName() << " loop-carried " << V->getName());
+
+      HWM->addIn(HWP, Cond);
+      connect(HWP, HWM);
+    }
+  }
+}
+
+static AliasAnalysis::Location getAccessLocation(AliasAnalysis &AA, const Value *IR) {
+  if (const LoadInst *LI = dyn_cast<LoadInst>(IR))
+    return AA.getLocation(LI);
+
+  return AA.getLocation(cast<StoreInst>(IR));
+}
+
+/// \brief Record the pairs of accesses to the same stream in \p BB which
+/// never touch the same address.
+///
+/// The Block keeps the program order of all other pairs containing a store.
+/// Accesses to different streams are not ordered at all.
+void OCLAccHW::handleMemoryDependences(const BasicBlock &BB) {
+  if (NoMemDepAnalysis)
+    return;
+
+  block_p HWBB = getBlock(&BB);
+
+  AliasAnalysis &AA = getAnalysis<AliasAnalysis>();
+  ScalarEvolution &SE = getAnalysis<ScalarEvolution>(const_cast<Function &>(*(BB.getParent())));
+
+  const StreamPort::AccessListTy &Accesses = HWBB->getStreamAccesses();
+
+  for (StreamPort::AccessListTy::const_iterator AI = Accesses.begin(), AE = Accesses.end(); AI != AE; ++AI) {
+    for (StreamPort::AccessListTy::const_iterator BI = std::next(AI); BI != AE; ++BI) {
+      const streamaccess_p A = *AI;
+      const streamaccess_p B = *BI;
+
+      if (A->getStream() != B->getStream())
+        continue;
+
+      if (A->isLoad() && B->isLoad())
+        continue;
+
+      if (isIndependentAccess(*A, *B, AA, SE)) {
+        ODEBUG("\t" << A->getUniqueName() << " and " << B->getUniqueName() << " independent");
+        HWBB->addIndependentAccesses(*A, *B);
+      }
+    }
+  }
+}
+
+/// \brief True if \p A and \p B to the same stream never overlap.
+///
+/// Static indices are byte offsets compared directly. Otherwise the IR
+/// pointers are checked by alias analysis, which covers noalias arguments
+/// and type-based alias info, and by their distance computed by
+/// ScalarEvolution.
+bool OCLAccHW::isIndependentAccess(const StreamAccess &A, const StreamAccess &B, AliasAnalysis &AA, ScalarEvolution &SE) const {
+  staticstreamindex_p AIdx = std::dynamic_pointer_cast<StaticStreamIndex>(A.getIndex());
+  staticstreamindex_p BIdx = std::dynamic_pointer_cast<StaticStreamIndex>(B.getIndex());
+
+  if (AIdx && BIdx) {
+    const uint64_t AOff = AIdx->getIndex()->getValue();
+    const uint64_t BOff = BIdx->getIndex()->getValue();
+
+    return AOff + A.getBitWidth() / 8 <= BOff || BOff + B.getBitWidth() / 8 <= AOff;
+  }
+
+  if (!A.getIR() || !B.getIR())
+    return false;
+
+  const AliasAnalysis::Location ALoc = getAccessLocation(AA, A.getIR());
+  const AliasAnalysis::Location BLoc = getAccessLocation(AA, B.getIR());
+
+  if (AA.alias(ALoc, BLoc) == AliasAnalysis::NoAlias)
+    return true;
+
+  if (ALoc.Size == AliasAnalysis::UnknownSize || BLoc.Size == AliasAnalysis::UnknownSize)
+    return false;
+
+  const SCEV *APtr = SE.getSCEV(const_cast<Value *>(ALoc.Ptr));
+  const SCEV *BPtr = SE.getSCEV(const_cast<Value *>(BLoc.Ptr));
+
+  const SCEVConstant *Dist = dyn_cast<SCEVConstant>(SE.getMinusSCEV(BPtr, APtr));
+  if (!Dist)
+    return false;
+
+  const int64_t D = Dist->getValue()->getSExtValue();
+
+  return D >= static_cast<int64_t>(ALoc.Size) || -D >= static_cast<int64_t>(BLoc.Size);
+}
+
+/// \brief True if consecutive work-items execute \p I on consecutive
+/// elements.
+///
+/// The offset of the pointer to its base must be the promoted global id of
+/// dimension 0 times the size of the loaded type plus terms independent of
+/// the id. Work-items are dispatched in the order of this id.
+bool OCLAccHW::isConsecutiveInWorkItems(const LoadInst &I) {
+  const Function *F = I.getParent()->getParent();
+
+  ArgPromotionTracker &AT = getAnalysis<ArgPromotionTracker>();
+  const Argument *GID = AT.getPromotedArgument(F, BuiltInFunctionCall::BIF_GetGlobalID, 0L);
+  if (!GID)
+    return false;
+
+  ScalarEvolution &SE = getAnalysis<ScalarEvolution>(const_cast<Function &>(*F));
+
+  Value *Ptr = const_cast<Value *>(I.getPointerOperand());
+  Value *Base = GetUnderlyingObject(Ptr, DL);
+
+  const SCEV *Offset = SE.getMinusSCEV(SE.getSCEV(Ptr), SE.getSCEV(Base));
+  const SCEV *ID = SE.getSCEV(const_cast<Argument *>(GID));
+  const uint64_t ElementSize = DL->getTypeAllocSize(I.getType());
+
+  SmallVector<const SCEV *, 4> Terms;
+  if (const SCEVAddExpr *A = dyn_cast<SCEVAddExpr>(Offset))
+    Terms.append(A->op_begin(), A->op_end());
+  else
+    Terms.push_back(Offset);
+
+  unsigned IDTerms = 0;
+
+  for (const SCEV *T : Terms) {
+    // ElementSize * ID, the ID may be extended or truncated to the pointer
+    // width.
+    const SCEV *X = T;
+    uint64_t Scale = 1;
+
+    if (const SCEVMulExpr *M = dyn_cast<SCEVMulExpr>(T)) {
+      const SCEVConstant *C = dyn_cast<SCEVConstant>(M->getOperand(0));
+      if (M->getNumOperands() == 2 && C) {
+        Scale = C->getValue()->getZExtValue();
+        X = M->getOperand(1);
+      }
+    }
+
+    while (const SCEVCastExpr *CE = dyn_cast<SCEVCastExpr>(X))
+      X = CE->getOperand();
+
+    if (X == ID && Scale == ElementSize) {
+      IDTerms++;
+      continue;
+    }
+
+    if (T == ID || SE.hasOperand(T, ID))
+      return false;
+  }
+
+  return IDTerms == 1;
+}
+
 #ifdef TYPENAME
 #undef TYPENAME
 #endif
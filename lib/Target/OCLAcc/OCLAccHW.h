@@ -1,6 +1,7 @@
 #ifndef OCLACCHWPASS_H
 #define OCLACCHWPASS_H
 
+#include <tuple>
 #include <unordered_map>
 
 #include "llvm/IR/InstVisitor.h"
@@ -9,14 +10,17 @@
 
 #include "OCLAccTargetMachine.h"
 #include "HW/typedefs.h"
+#include "HW/Arena.h"
 #include "HW/Design.h"
 #include "HW/Kernel.h"
 #include "HW/Port.h"
 
 namespace llvm {
 
+class AliasAnalysis;
 class Argument;
 class AnalysisUsage;
+class ScalarEvolution;
 
 class OCLAccHWVisitor;
 
@@ -31,6 +35,15 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
     void handleArgument(const Argument &);
     void setAttributesFromMD(const Function &F, oclacc::kernel_p K);
 
+    // Memory dependences
+    void handleMemoryDependences(const BasicBlock &BB);
+    bool isIndependentAccess(const oclacc::StreamAccess &A, const oclacc::StreamAccess &B, AliasAnalysis &AA, ScalarEvolution &SE) const;
+    bool isConsecutiveInWorkItems(const LoadInst &I);
+
+    // Loops
+    oclacc::scalarport_p makeBackEdge(const BasicBlock *BB, const Value *IR, oclacc::base_p HWV);
+    void handleLoopPHIs(const BasicBlock &BB);
+
   public:
     OCLAccHW();
     ~OCLAccHW();
@@ -81,6 +94,10 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
 
     void visitBinaryOperator(BinaryOperator &);
 
+    void visitExtractElementInst(ExtractElementInst &);
+    void visitInsertElementInst(InsertElementInst &);
+    void visitShuffleVectorInst(ShuffleVectorInst &);
+
     void visitLoadInst(LoadInst &);
     void visitStoreInst(StoreInst &);
 
@@ -95,6 +112,9 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
     void visitBranchInst(BranchInst &);
 
   private:
+    // Storage of all HW nodes created for the Module
+    oclacc::Arena HWArena;
+
     KernelMapTy KernelMap;
     BlockMapTy BlockMap;
     
@@ -104,6 +124,17 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
     // Store Kernel Arguments. No mapping for propagated Arguments.
     ArgMapTy ArgMap;
 
+    // Lanes of vector values, see getLane()
+    typedef std::map<std::pair<const oclacc::HW *, unsigned>, oclacc::base_p> LaneMapTy;
+    LaneMapTy LaneMap;
+
+    // Fixed point values of FP instructions, see FixedPointAnalysis
+    ValueMapTy FixedMap;
+
+    // FP values converted to a fixed point format per Block
+    typedef std::map<std::tuple<const BasicBlock *, const Value *, unsigned, unsigned>, oclacc::base_p> FixedConvMapTy;
+    FixedConvMapTy FixedConvMap;
+
     // 
     StreamAccessMapTy ArgStreamReads;
     StreamAccessMapTy ArgStreamWrites;
@@ -116,6 +147,44 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
   private:
     oclacc::const_p makeConstant(const Constant *, const Instruction *);
 
+    /// \brief Create the operator of \p I for the scalar type \p T.
+    ///
+    /// Used for scalar operations and for each lane of vector operations. The
+    /// operator is not mapped to \p I.
+    oclacc::base_p makeBinaryOp(const BinaryOperator &I, const Type *T, const std::string &Name, unsigned Bits);
+
+    /// \brief Compute each lane of a vector operation by a scalar operator.
+    void handleVectorBinaryOperator(BinaryOperator &I);
+
+    /// \brief True if \p I is computed in fixed point.
+    bool isFixedPoint(const Instruction *I);
+
+    /// \brief Compute \p I in the fixed point format of its component.
+    ///
+    /// The FP result is only created if \p I is used outside of the
+    /// component.
+    void handleFixedPoint(BinaryOperator &I);
+
+    /// \brief Operand \p V of the fixed point instruction \p I in its
+    /// format.
+    oclacc::base_p getFixedOperand(const BinaryOperator &I, const Value *V);
+
+    void handleMathFunction(CallInst &I);
+    void handleFMA(Instruction &I, const Value *A, const Value *B, const Value *C, bool NegateAB, bool NegateC);
+
+    /// \brief Constant element of a vector extended to the full lane width.
+    oclacc::const_p makeLaneConstant(const Constant *C, const Instruction *I);
+
+    /// \brief Return lane \p Lane of the vector \p V used by \p I.
+    ///
+    /// Slices of a vector are created once per Block.
+    oclacc::base_p getLane(const Instruction *I, const Value *V, unsigned Lane);
+
+    /// \brief Concatenate \p Lanes to a value of type \p VT used by \p I.
+    ///
+    /// The result is not mapped to \p I.
+    oclacc::concat_p makeVector(const Instruction *I, VectorType *VT, const std::vector<oclacc::base_p> &Lanes);
+
     /// \brief Return run-time operand for struct offset.
     /// \param Parent BasicBlock pointer to add Operation to HWParent
     /// \param IndexValue Constant or Dynamic Index
@@ -143,24 +212,24 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
       // multiple instructions, leading to conflicts in the Map.
       assert(! isa<ConstantInt>(IR) && !isa<ConstantFP>(IR) && "Do not use makeHW to create constants.");
 
-      std::shared_ptr<HW> HWP = std::make_shared<HW>(args...);
+      std::shared_ptr<HW> HWP = HWArena.make<HW>(args...);
       HWP->setIR(IR);
 
       return HWP;
     }
 
-    /// \brief Create shared_ptr to HW object and add to ValueMap for \param BB
+    /// \brief Create shared_ptr to HW object and add it to the Block of \param
+    /// BB without mapping \param IR to it.
     ///
+    /// Used for parts of an instruction, e.g. the lanes of vector operations.
     /// Set Parent pointer for the created object.
     template<class T, class ...Args>
-    std::shared_ptr<T> makeHWBB(const BasicBlock *BB, const Value *IR, Args&& ...args) {
+    std::shared_ptr<T> makeHWOp(const BasicBlock *BB, const Value *IR, Args&& ...args) {
 
       std::shared_ptr<T> HWP = makeHW<T>(IR, args...);
       oclacc::block_p HWBB = getBlock(BB);
       HWP->setParent(HWBB);
 
-      BlockValueMap[BB][IR] = HWP;
-
       // Only add operations (Instructions) to Blocks.
       //if (!std::is_base_of<oclacc::Port, HW>::value) HWB->addOp(HWP);
       HWBB->addOp(HWP);
@@ -168,10 +237,23 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
       return HWP;
     }
 
+    /// \brief Create shared_ptr to HW object and add to ValueMap for \param BB
+    ///
+    /// Set Parent pointer for the created object.
+    template<class T, class ...Args>
+    std::shared_ptr<T> makeHWBB(const BasicBlock *BB, const Value *IR, Args&& ...args) {
+
+      std::shared_ptr<T> HWP = makeHWOp<T>(BB, IR, args...);
+
+      BlockValueMap[BB][IR] = HWP;
+
+      return HWP;
+    }
+
     /// \brief Make new kernel and add to KernelMap
     template<class ...Args>
     oclacc::kernel_p makeKernel(const Function *IR, Args&& ...args) {
-      oclacc::kernel_p HWP = std::make_shared<oclacc::Kernel>(args...);
+      oclacc::kernel_p HWP = HWArena.make<oclacc::Kernel>(args...);
       KernelMap[IR] = HWP;
       return HWP;
     }
@@ -179,7 +261,7 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
     /// \brief Make new Block and add to current kernel
     template<class ...Args>
     oclacc::block_p makeBlock(const BasicBlock *BB, Args&& ...args) {
-      oclacc::block_p HWB = std::make_shared<oclacc::Block>(args...);
+      oclacc::block_p HWB = HWArena.make<oclacc::Block>(args...);
       BlockMap[BB] = HWB;
 
       // add block to kernel
@@ -291,13 +373,17 @@ class OCLAccHW : public ModulePass, public InstVisitor<OCLAccHW>{
       return VI->second;
     }
 
-    void connect(oclacc::base_p HWFrom, oclacc::base_p HWTo) {
+    void connect(const oclacc::base_p &HWFrom, const oclacc::base_p &HWTo) {
       HWFrom->addOut(HWTo);
       HWTo->addIn(HWFrom);
     }
 
     oclacc::Datatype getDatatype(const Type *T) const {
       oclacc::Datatype DT=oclacc::Invalid;
+      // Vectors have the type of their lanes
+      if (const VectorType *VT = dyn_cast<VectorType>(T))
+        T = VT->getElementType();
+
       if (T->isIntegerTy()) DT=oclacc::Integer;
       else if (T->isHalfTy()) DT=oclacc::Half;
       else if (T->isFloatTy()) DT=oclacc::Float;
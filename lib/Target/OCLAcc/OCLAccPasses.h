@@ -60,6 +60,12 @@ Pass* createDelayStoresPass();
 //
 Pass* createBitWidthAnalysisPass();
 
+//===----------------------------------------------------------------------===//
+//
+// FixedPointAnalysis - Choose fixed point formats for FP instructions
+//
+Pass* createFixedPointAnalysisPass();
+
 //===----------------------------------------------------------------------===//
 //
 // ShiftRegisterDetection - Detect shift register loops
@@ -108,6 +114,12 @@ Pass* createCanonicalizePredecessorsPass();
 //
 Pass* createCFGOptimizerPass();
 
+//===----------------------------------------------------------------------===//
+//
+// BlockRouting - Route values from their definition to their uses
+//
+Pass* createBlockRoutingPass();
+
 Pass* createRenameInvalidPass();
 
 Pass *createPrintModulePass();
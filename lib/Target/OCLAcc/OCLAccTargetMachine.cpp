@@ -5,6 +5,7 @@
 #include "Backend/Verilog/VerilogTargetMachine.h"
 #include "Backend/Dot/DotTargetMachine.h"
 
+#include "llvm/Analysis/Passes.h"
 #include "llvm/PassManager.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Debug.h"
@@ -59,6 +60,10 @@ bool OCLAccTargetMachine::addPassesToEmitFile(PassManagerBase &PM,
   if (FileType != TargetMachine::CGFT_AssemblyFile)
     return true;
 
+  // Loops are supported if their body is a single BasicBlock. Rotation moves
+  // the exit test of loops like "for (...) { ... }" to the end of the body.
+  PM.add(createLoopRotatePass());
+
   /* Name Instructions to allow mapping of source to generated objects */
   PM.add(createInstructionNamerPass());
   // Rename values like 'ir.cond3' which result in problems when used in HDL
@@ -66,6 +71,11 @@ bool OCLAccTargetMachine::addPassesToEmitFile(PassManagerBase &PM,
   PM.add(createSplitBarrierBlocksPass());
   PM.add(createRenameInvalidPass());
 
+  // Alias analysis used to find independent memory accesses
+  PM.add(createTypeBasedAliasAnalysisPass());
+  PM.add(createScopedNoAliasAAPass());
+  PM.add(createBasicAliasAnalysisPass());
+
   PM.add(createPrintModulePass());
 
   return false;
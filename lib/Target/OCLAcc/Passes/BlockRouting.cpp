@@ -0,0 +1,210 @@
+//===- BlockRouting.cpp - Implementation of BlockRouting Pass -------------===//
+//===----------------------------------------------------------------------===//
+
+#include "BlockRouting.h"
+
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+#define DEBUG_TYPE "loopus-routing"
+
+using namespace llvm;
+
+unsigned BlockRouting::getIndex(const BasicBlock *BB) const {
+  DenseMap<const BasicBlock *, unsigned>::const_iterator I = Index.find(BB);
+  assert(I != Index.end() && "Block not reachable from entry");
+  return I->second;
+}
+
+bool BlockRouting::isReachable(const BasicBlock *F, const BasicBlock *T) const {
+  if (!Index.count(F) || !Index.count(T))
+    return false;
+
+  return Reach[getIndex(F)].test(getIndex(T));
+}
+
+/// \brief Add the edges (A, B) with A reachable from \p F and \p T reachable
+/// from B.
+///
+/// Only blocks between \p F and \p T in topological order may be on a path
+/// between both, so the cost is linear in the number of edges.
+void BlockRouting::addRoute(const BasicBlock *F, const BasicBlock *T, EdgeListTy &Edges) const {
+  if (!isReachable(F, T))
+    return;
+
+  const unsigned FI = getIndex(F);
+  const unsigned TI = getIndex(T);
+
+  for (unsigned i = FI; i < TI; ++i) {
+    if (!Reach[FI].test(i) || !Reach[i].test(TI))
+      continue;
+
+    const BasicBlock *A = Order[i];
+
+    for (succ_const_iterator SI = succ_begin(A), SE = succ_end(A); SI != SE; ++SI) {
+      const BasicBlock *B = *SI;
+      if (B == A)
+        continue;
+
+      const unsigned j = getIndex(B);
+      if (j > i && Reach[j].test(TI))
+        Edges.push_back(std::make_pair(A, B));
+    }
+  }
+}
+
+/// \brief Order the edges by their source, so ports are created from the
+/// definition towards the use, and remove duplicates of switches with
+/// multiple cases to the same block.
+void BlockRouting::sortRoute(EdgeListTy &Edges) const {
+  std::sort(Edges.begin(), Edges.end(), [this](const EdgeTy &L, const EdgeTy &R) {
+      return std::make_pair(getIndex(L.first), getIndex(L.second))
+        < std::make_pair(getIndex(R.first), getIndex(R.second));
+      });
+
+  Edges.erase(std::unique(Edges.begin(), Edges.end()), Edges.end());
+}
+
+const BlockRouting::EdgeListTy BlockRouting::getRouteForValue(
+    const BasicBlock *F, const BasicBlock *T, const Value *V) const {
+
+  assert(V->isUsedInBasicBlock(T));
+  assert(F != T);
+
+  // Check by which Instructions Value V is used. If it is only inside of
+  // PHINodes, we can eliminate all other edges. If a Value is used directly,
+  // i.e. outside of PHINodes, its definition dominates the use and it has to
+  // be propagated through all blocks between them.
+  bool OnlyUsedByPHI = true;
+
+  for (const User *U : V->users()) {
+    const Instruction *UI = dyn_cast<Instruction>(U);
+    if (UI && UI->getParent() == T && !isa<PHINode>(UI)) {
+      OnlyUsedByPHI = false;
+      break;
+    }
+  }
+
+  if (!OnlyUsedByPHI) {
+    assert(DT->dominates(F, T) && "Definition does not dominate use");
+    return getRouteFromTo(F, T);
+  }
+
+  DEBUG(dbgs() << "Value " << V->getName() << " in BB " << T->getName() << " is pure PHI input\n");
+
+  // Route the Value to the incoming blocks of the PHINodes using it. Values
+  // passed back by a self loop have to reach T anyway.
+  EdgeListTy Edges;
+
+  for (const Instruction &I : *T) {
+    const PHINode *PHI = dyn_cast<PHINode>(&I);
+    if (!PHI)
+      break;
+
+    for (unsigned i = 0; i < PHI->getNumIncomingValues(); ++i) {
+      if (PHI->getIncomingValue(i) != V)
+        continue;
+
+      const BasicBlock *IncBB = PHI->getIncomingBlock(i);
+
+      if (IncBB == T) {
+        addRoute(F, T, Edges);
+      } else {
+        addRoute(F, IncBB, Edges);
+        Edges.push_back(std::make_pair(IncBB, T));
+      }
+    }
+  }
+
+  // After investigating all PHINodes at the beginning of T, we must have
+  // found edges
+  assert(!Edges.empty());
+
+  sortRoute(Edges);
+
+  return Edges;
+}
+
+const BlockRouting::EdgeListTy BlockRouting::getRouteFromTo(const BasicBlock *F, const BasicBlock *T) const {
+  EdgeListTy Edges;
+
+  addRoute(F, T, Edges);
+  sortRoute(Edges);
+
+  return Edges;
+}
+
+//===- Implementation of LLVM pass ----------------------------------------===//
+INITIALIZE_PASS_BEGIN(BlockRouting, "loopus-routing", "Route values between BasicBlocks",  false, true)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_END(BlockRouting, "loopus-routing", "Route values between BasicBlocks",  false, true)
+
+char BlockRouting::ID = 0;
+
+namespace llvm {
+  Pass* createBlockRoutingPass() {
+    return new BlockRouting();
+  }
+}
+
+BlockRouting::BlockRouting() : FunctionPass(ID), DT(nullptr) {
+  initializeBlockRoutingPass(*PassRegistry::getPassRegistry());
+}
+
+void BlockRouting::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<DominatorTreeWrapperPass>();
+  AU.setPreservesAll();
+}
+
+bool BlockRouting::runOnFunction(Function &F) {
+  Order.clear();
+  Index.clear();
+  Reach.clear();
+
+  DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+
+  ReversePostOrderTraversal<const Function *> RPOT(&F);
+  for (const BasicBlock *BB : RPOT) {
+    Index[BB] = Order.size();
+    Order.push_back(BB);
+  }
+
+  const unsigned N = Order.size();
+  Reach.assign(N, BitVector(N));
+
+  // Successors come later in topological order, so they are complete when
+  // their predecessors are computed.
+  for (unsigned i = N; i-- > 0; ) {
+    const BasicBlock *BB = Order[i];
+    Reach[i].set(i);
+
+    for (succ_const_iterator SI = succ_begin(BB), SE = succ_end(BB); SI != SE; ++SI) {
+      const unsigned j = getIndex(*SI);
+      if (j > i)
+        Reach[i] |= Reach[j];
+    }
+  }
+
+  DEBUG(print(dbgs(), F.getParent()));
+
+  return false;
+}
+
+void BlockRouting::print(raw_ostream &O, const Module *M) const {
+  O << "Reachable blocks:\n";
+
+  for (unsigned i = 0, e = Order.size(); i < e; ++i) {
+    O << "  " << Order[i]->getName() << ":";
+    for (int j = Reach[i].find_first(); j >= 0; j = Reach[i].find_next(j))
+      if (static_cast<unsigned>(j) != i)
+        O << " " << Order[j]->getName();
+    O << "\n";
+  }
+}
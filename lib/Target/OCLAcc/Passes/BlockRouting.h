@@ -0,0 +1,71 @@
+//===- BlockRouting.h - Route values from their definition to their uses --===//
+//
+// Determines the CFG edges a value has to be passed along from the block
+// defining it to a block using it. The edges are those on any path between
+// both blocks, computed from the reachability of the blocks instead of
+// enumerating the paths.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef BLOCKROUTING_H
+#define BLOCKROUTING_H
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Value.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <utility>
+#include <vector>
+
+class BlockRouting : public llvm::FunctionPass {
+  public:
+    typedef std::pair<const llvm::BasicBlock *, const llvm::BasicBlock *> EdgeTy;
+    typedef std::vector<EdgeTy> EdgeListTy;
+
+  private:
+    // Blocks in topological order. Loops consist of a single block, so self
+    // loops are the only back edges and are ignored.
+    std::vector<const llvm::BasicBlock *> Order;
+    llvm::DenseMap<const llvm::BasicBlock *, unsigned> Index;
+
+    // Blocks reachable from each block, including itself
+    std::vector<llvm::BitVector> Reach;
+
+    const llvm::DominatorTree *DT;
+
+    unsigned getIndex(const llvm::BasicBlock *BB) const;
+
+    void addRoute(const llvm::BasicBlock *F, const llvm::BasicBlock *T, EdgeListTy &Edges) const;
+    void sortRoute(EdgeListTy &Edges) const;
+
+  public:
+    static char ID;
+
+    BlockRouting();
+
+    /// \brief True if \p T can be reached from \p F.
+    bool isReachable(const llvm::BasicBlock *F, const llvm::BasicBlock *T) const;
+
+    /// \brief Edges passing \p V defined in \p F to its use in \p T.
+    ///
+    /// If \p V is only used by PHINodes of \p T, only the edges towards the
+    /// incoming blocks of \p V are returned.
+    const EdgeListTy getRouteForValue(const llvm::BasicBlock *F, const llvm::BasicBlock *T, const llvm::Value *V) const;
+
+    /// \brief Edges on any path from \p F to \p T in topological order.
+    ///
+    /// The source of each edge is either \p F or the target of an edge
+    /// before it.
+    const EdgeListTy getRouteFromTo(const llvm::BasicBlock *F, const llvm::BasicBlock *T) const;
+
+    virtual void getAnalysisUsage(llvm::AnalysisUsage &) const override;
+    virtual bool runOnFunction(llvm::Function &) override;
+    virtual void print(llvm::raw_ostream &O, const llvm::Module *M) const override;
+};
+
+#endif /* BLOCKROUTING_H */
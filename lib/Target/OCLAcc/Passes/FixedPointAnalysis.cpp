@@ -0,0 +1,395 @@
+//===- FixedPointAnalysis.cpp - Implementation of FixedPointAnalysis ------===//
+//===----------------------------------------------------------------------===//
+
+#include "FixedPointAnalysis.h"
+#include "BitWidthAnalysis.h"
+
+#include "llvm/ADT/APFloat.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define DEBUG_TYPE "loopus-fixedpoint"
+
+using namespace llvm;
+
+static cl::opt<bool> FPFixedPoint("fp-fixed-point", cl::init(false), cl::desc("Compute floating point operations with a known value range in fixed point.") );
+static cl::opt<double> FPInputRange("fp-input-range", cl::init(0), cl::desc("Largest magnitude of floating point kernel arguments and loaded values, 0 if unknown.") );
+static cl::opt<double> FPAbsError("fp-abs-error", cl::init(1e-6), cl::desc("Absolute error bound of values computed in fixed point.") );
+static cl::opt<unsigned> FPFixedMinOps("fp-fixed-min-ops", cl::init(2), cl::desc("Minimum number of connected floating point operations computed in fixed point.") );
+static cl::opt<unsigned> FPFixedMaxWidth("fp-fixed-max-width", cl::init(64), cl::desc("Maximum bitwidth of fixed point values.") );
+
+// Ranges growing in every iteration belong to accumulating loops.
+static const unsigned MaxRangeIterations = 16;
+
+static const double Unknown = std::numeric_limits<double>::infinity();
+
+INITIALIZE_PASS_BEGIN(FixedPointAnalysis, "loopus-fixedpoint", "Fixed point analysis",  false, true)
+INITIALIZE_PASS_DEPENDENCY(BitWidthAnalysis)
+INITIALIZE_PASS_END(FixedPointAnalysis, "loopus-fixedpoint", "Fixed point analysis",  false, true)
+
+char FixedPointAnalysis::ID = 0;
+
+namespace llvm {
+  Pass* createFixedPointAnalysisPass() {
+    return new FixedPointAnalysis();
+  }
+}
+
+FixedPointAnalysis::FixedPointAnalysis(void)
+ : FunctionPass(ID), BWA(0) {
+  initializeFixedPointAnalysisPass(*PassRegistry::getPassRegistry());
+}
+
+/// \brief Product of two magnitudes, where zero wins over unknown.
+static double mulRange(double A, double B) {
+  if (A == 0 || B == 0)
+    return 0;
+  return A * B;
+}
+
+/// \brief Integer bits needed to represent magnitudes up to \p R.
+static unsigned getIntBits(double R) {
+  if (R < 1)
+    return 0;
+  return static_cast<unsigned>(std::floor(std::log2(R))) + 1;
+}
+
+typedef std::map<const Instruction *, const Instruction *> ParentMapTy;
+
+/// \brief Root of the Union-Find set of \p I with path compression.
+static const Instruction *findRoot(ParentMapTy &Parent, const Instruction *I) {
+  const Instruction *P = Parent[I];
+  if (P == I)
+    return I;
+
+  const Instruction *R = findRoot(Parent, P);
+  Parent[I] = R;
+  return R;
+}
+
+/// \brief Range of operand \p V of an instruction. Instructions not yet
+/// computed are the back edges of loops and start with 0.
+double FixedPointAnalysis::getRangeOf(const Value *V) const {
+  if (isa<UndefValue>(V))
+    return 0;
+
+  if (const ConstantFP *C = dyn_cast<ConstantFP>(V)) {
+    APFloat F = C->getValueAPF();
+    bool LosesInfo;
+    F.convert(APFloat::IEEEdouble, APFloat::rmNearestTiesToEven, &LosesInfo);
+    return std::fabs(F.convertToDouble());
+  }
+
+  if (const Instruction *I = dyn_cast<Instruction>(V)) {
+    RangeMapTy::const_iterator RI = Ranges.find(I);
+    if (RI == Ranges.end())
+      return 0;
+    return RI->second;
+  }
+
+  // Arguments and other constants
+  if (FPInputRange > 0)
+    return FPInputRange;
+  return Unknown;
+}
+
+double FixedPointAnalysis::computeRange(const Instruction *I) const {
+  switch (I->getOpcode()) {
+    case Instruction::FAdd:
+    case Instruction::FSub:
+      return getRangeOf(I->getOperand(0)) + getRangeOf(I->getOperand(1));
+    case Instruction::FMul:
+      return mulRange(getRangeOf(I->getOperand(0)), getRangeOf(I->getOperand(1)));
+    case Instruction::FDiv:
+      {
+        // Only constant divisors are bounded
+        const ConstantFP *C = dyn_cast<ConstantFP>(I->getOperand(1));
+        if (!C || C->isZero())
+          return Unknown;
+        return getRangeOf(I->getOperand(0)) / getRangeOf(C);
+      }
+    case Instruction::FRem:
+      return std::min(getRangeOf(I->getOperand(0)), getRangeOf(I->getOperand(1)));
+    case Instruction::FPExt:
+    case Instruction::FPTrunc:
+      return getRangeOf(I->getOperand(0));
+    case Instruction::SIToFP:
+    case Instruction::UIToFP:
+      {
+        const Value *Op = I->getOperand(0);
+        int Bits = BWA->getBitWidth(Op, I).first;
+        if (Bits <= 0)
+          Bits = Op->getType()->getScalarSizeInBits();
+        if (I->getOpcode() == Instruction::SIToFP)
+          Bits--;
+        return std::ldexp(1.0, Bits);
+      }
+    case Instruction::Select:
+      return std::max(getRangeOf(I->getOperand(1)), getRangeOf(I->getOperand(2)));
+    case Instruction::PHI:
+      {
+        double R = 0;
+        const PHINode *P = cast<PHINode>(I);
+        for (unsigned i = 0, e = P->getNumIncomingValues(); i < e; ++i)
+          R = std::max(R, getRangeOf(P->getIncomingValue(i)));
+        return R;
+      }
+    case Instruction::Load:
+      return FPInputRange > 0 ? FPInputRange : Unknown;
+    case Instruction::Call:
+      if (const IntrinsicInst *II = dyn_cast<IntrinsicInst>(I)) {
+        if (II->getIntrinsicID() == Intrinsic::fmuladd)
+          return mulRange(getRangeOf(II->getArgOperand(0)), getRangeOf(II->getArgOperand(1))) + getRangeOf(II->getArgOperand(2));
+      }
+      return Unknown;
+    default:
+      return Unknown;
+  }
+}
+
+/// \brief Propagate the ranges until they are stable. Values still growing
+/// after MaxRangeIterations are unbounded.
+void FixedPointAnalysis::computeRanges(Function &F) {
+  std::vector<const Instruction *> Changed;
+
+  for (unsigned It = 0; It < MaxRangeIterations; ++It) {
+    Changed.clear();
+
+    for (inst_iterator II = inst_begin(F), IE = inst_end(F); II != IE; ++II) {
+      const Instruction *I = &*II;
+      if (!I->getType()->isFloatingPointTy())
+        continue;
+
+      const double R = computeRange(I);
+      RangeMapTy::iterator RI = Ranges.find(I);
+      if (RI == Ranges.end() || RI->second != R) {
+        Ranges[I] = R;
+        Changed.push_back(I);
+      }
+    }
+
+    if (Changed.empty())
+      return;
+  }
+
+  for (const Instruction *I : Changed)
+    Ranges[I] = Unknown;
+
+  // Propagate the unbounded values once more
+  for (unsigned It = 0; It < MaxRangeIterations; ++It) {
+    bool Change = false;
+    for (inst_iterator II = inst_begin(F), IE = inst_end(F); II != IE; ++II) {
+      const Instruction *I = &*II;
+      if (!I->getType()->isFloatingPointTy())
+        continue;
+
+      const double R = computeRange(I);
+      if (std::isinf(R) && !std::isinf(Ranges[I])) {
+        Ranges[I] = R;
+        Change = true;
+      }
+    }
+    if (!Change)
+      return;
+  }
+}
+
+/// \brief Scalar additions, subtractions and multiplications with bounded
+/// operands and result.
+bool FixedPointAnalysis::isConvertible(const Instruction *I) const {
+  if (!I->getType()->isFloatingPointTy())
+    return false;
+
+  switch (I->getOpcode()) {
+    case Instruction::FAdd:
+    case Instruction::FSub:
+    case Instruction::FMul:
+      break;
+    default:
+      return false;
+  }
+
+  if (std::isinf(getRange(I)))
+    return false;
+
+  for (const Use &U : I->operands())
+    if (std::isinf(getRangeOf(U.get())))
+      return false;
+
+  return true;
+}
+
+/// \brief Group connected convertible instructions of each BasicBlock and
+/// choose a common format for each group.
+///
+/// Values entering a component are converted once, so the error of each
+/// instruction is tracked in units of the LSB. The LSB is chosen such that
+/// the largest error in the component stays below -fp-abs-error.
+void FixedPointAnalysis::computeComponents(Function &F) {
+  // Union-Find over the convertible instructions
+  ParentMapTy Parent;
+
+  for (inst_iterator II = inst_begin(F), IE = inst_end(F); II != IE; ++II) {
+    const Instruction *I = &*II;
+    if (!isConvertible(I))
+      continue;
+
+    Parent[I] = I;
+
+    for (const Use &U : I->operands()) {
+      const Instruction *OpI = dyn_cast<Instruction>(U.get());
+      if (!OpI || OpI->getParent() != I->getParent() || !Parent.count(OpI))
+        continue;
+
+      Parent[findRoot(Parent, OpI)] = findRoot(Parent, I);
+    }
+  }
+
+  // Members in program order, so operands precede their users
+  std::map<const Instruction *, std::vector<const Instruction *> > Groups;
+  std::vector<const Instruction *> Roots;
+
+  for (inst_iterator II = inst_begin(F), IE = inst_end(F); II != IE; ++II) {
+    const Instruction *I = &*II;
+    if (!Parent.count(I))
+      continue;
+
+    const Instruction *R = findRoot(Parent, I);
+    if (!Groups.count(R))
+      Roots.push_back(R);
+    Groups[R].push_back(I);
+  }
+
+  for (const Instruction *R : Roots) {
+    const std::vector<const Instruction *> &G = Groups[R];
+
+    if (G.size() < FPFixedMinOps)
+      continue;
+
+    double MaxError = 0;
+    double MaxRange = 0;
+
+    for (const Instruction *I : G) {
+      double E[2];
+      double Rg[2];
+
+      for (unsigned i = 0; i < 2; ++i) {
+        const Value *V = I->getOperand(i);
+        const Instruction *OpI = dyn_cast<Instruction>(V);
+
+        Rg[i] = getRangeOf(V);
+        MaxRange = std::max(MaxRange, Rg[i]);
+
+        // Values entering the component are truncated once
+        if (OpI && Errors.count(OpI) && findRoot(Parent, OpI) == R)
+          E[i] = Errors[OpI];
+        else
+          E[i] = 1;
+      }
+
+      double Err;
+      if (I->getOpcode() == Instruction::FMul)
+        // The product is truncated to the LSB again
+        Err = Rg[0] * E[1] + Rg[1] * E[0] + E[0] * E[1] + 1;
+      else
+        Err = E[0] + E[1];
+
+      Errors[I] = Err;
+      MaxError = std::max(MaxError, Err);
+      MaxRange = std::max(MaxRange, getRange(I));
+    }
+
+    FixedFormatTy Format;
+    const double Frac = std::ceil(std::log2(MaxError / FPAbsError));
+    Format.FracBits = Frac > 0 ? static_cast<unsigned>(Frac) : 0;
+    Format.Width = 1 + getIntBits(MaxRange) + Format.FracBits;
+
+    if (Format.Width > FPFixedMaxWidth) {
+      DEBUG(dbgs() << "Component of " << R->getName() << " needs " << Format.Width << " bits, kept in floating point\n");
+      continue;
+    }
+
+    const unsigned Idx = Formats.size();
+    Formats.push_back(Format);
+    Members.push_back(G);
+
+    for (const Instruction *I : G)
+      Components[I] = Idx;
+  }
+}
+
+bool FixedPointAnalysis::isFixedPoint(const Instruction *I) const {
+  return Components.count(I);
+}
+
+const FixedPointAnalysis::FixedFormatTy &FixedPointAnalysis::getFormat(const Instruction *I) const {
+  ComponentMapTy::const_iterator CI = Components.find(I);
+  assert(CI != Components.end() && "Instruction not computed in fixed point");
+
+  return Formats[CI->second];
+}
+
+double FixedPointAnalysis::getRange(const Value *V) const {
+  if (const Instruction *I = dyn_cast<Instruction>(V)) {
+    RangeMapTy::const_iterator RI = Ranges.find(I);
+    if (RI == Ranges.end())
+      return Unknown;
+    return RI->second;
+  }
+
+  return getRangeOf(V);
+}
+
+void FixedPointAnalysis::print(raw_ostream &O, const Module *M) const {
+  for (unsigned i = 0, e = Formats.size(); i < e; ++i) {
+    const FixedFormatTy &F = Formats[i];
+    O << "Component " << i << ": " << F.Width << " bits, " << F.FracBits << " fractional\n";
+
+    for (const Instruction *I : Members[i]) {
+      O << "  " << *I << " ; range " << getRange(I);
+
+      ErrorMapTy::const_iterator EI = Errors.find(I);
+      if (EI != Errors.end())
+        O << ", error " << EI->second << " LSB";
+      O << "\n";
+    }
+  }
+}
+
+void FixedPointAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<BitWidthAnalysis>();
+  AU.setPreservesAll();
+}
+
+bool FixedPointAnalysis::runOnFunction(Function &F) {
+  Ranges.clear();
+  Errors.clear();
+  Components.clear();
+  Formats.clear();
+  Members.clear();
+
+  if (!FPFixedPoint)
+    return false;
+
+  if (FPAbsError <= 0)
+    report_fatal_error("-fp-abs-error must be positive");
+
+  BWA = &getAnalysis<BitWidthAnalysis>();
+
+  computeRanges(F);
+  computeComponents(F);
+
+  DEBUG(print(dbgs(), F.getParent()));
+
+  return false;
+}
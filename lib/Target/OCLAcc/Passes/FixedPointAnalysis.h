@@ -0,0 +1,79 @@
+//===- FixedPointAnalysis.h - Fixed point formats of FP instructions ------===//
+//
+// Determines which floating point instructions may be computed in fixed point
+// arithmetic. The value ranges are propagated from the FP inputs and
+// constants, the number of fractional bits is chosen to meet the absolute
+// error bound given by -fp-abs-error.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _LOOPUS_FIXEDPOINTANALYSIS_H_INCLUDE_
+#define _LOOPUS_FIXEDPOINTANALYSIS_H_INCLUDE_
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Value.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <vector>
+
+class BitWidthAnalysis;
+
+class FixedPointAnalysis : public llvm::FunctionPass {
+  public:
+    /// \brief Signed fixed point format with Width bits, FracBits of them
+    /// fractional. All instructions of a component use the same format.
+    struct FixedFormatTy {
+      unsigned Width;
+      unsigned FracBits;
+
+      FixedFormatTy(void) : Width(0), FracBits(0) {
+      }
+    };
+
+  private:
+    BitWidthAnalysis *BWA;
+
+    /// Largest magnitude of each FP value, infinity if unknown.
+    typedef std::map<const llvm::Value *, double> RangeMapTy;
+    RangeMapTy Ranges;
+
+    /// Error of each converted instruction in units of the LSB.
+    typedef std::map<const llvm::Instruction *, double> ErrorMapTy;
+    ErrorMapTy Errors;
+
+    /// Connected converted instructions of a single BasicBlock.
+    typedef std::map<const llvm::Instruction *, unsigned> ComponentMapTy;
+    ComponentMapTy Components;
+    std::vector<FixedFormatTy> Formats;
+    std::vector<std::vector<const llvm::Instruction *> > Members;
+
+    double getRangeOf(const llvm::Value *V) const;
+    double computeRange(const llvm::Instruction *I) const;
+    bool isConvertible(const llvm::Instruction *I) const;
+
+    void computeRanges(llvm::Function &F);
+    void computeComponents(llvm::Function &F);
+
+  public:
+    static char ID;
+
+    FixedPointAnalysis(void);
+
+    /// \brief True if \p I is computed in fixed point.
+    bool isFixedPoint(const llvm::Instruction *I) const;
+
+    /// \brief Format of the component of \p I, which must be fixed point.
+    const FixedFormatTy &getFormat(const llvm::Instruction *I) const;
+
+    /// \brief Largest magnitude of \p V, infinity if unknown.
+    double getRange(const llvm::Value *V) const;
+
+    virtual void print(llvm::raw_ostream &O, const llvm::Module *M) const override;
+    virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    virtual bool runOnFunction(llvm::Function &F) override;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/UnrollLoop.h"
 
+#include <algorithm>
 #include <limits>
 
 using namespace llvm;
@@ -28,6 +29,8 @@ using namespace llvm;
 cl::opt<unsigned> MaxRolledLoopSize("maxloopsize", cl::desc("The maximum size of the NOT unrolled loop."), cl::Optional, cl::init(std::numeric_limits<unsigned>::max()));
 // The maximum size of the unrolled loop
 cl::opt<unsigned> MaxUnrolledLoopSize("maxunrollsize", cl::desc("The maximum size of the unrolled loop."), cl::Optional, cl::init(std::numeric_limits<unsigned>::max()));
+// The share of the device the unrolled function may use
+cl::opt<unsigned> UnrollAreaBudget("unroll-area-budget", cl::desc("Percentage of the device resources the function may use after unrolling, 0 disables the limit."), cl::Optional, cl::init(80));
 
 //===- Unroll functions ---------------------------------------------------===//
 unsigned HDLLoopUnroll::ggT(unsigned a, unsigned b) {
@@ -353,6 +356,30 @@ bool HDLLoopUnroll::dependsOnLoop(const SCEV *SCEVVal, const Loop *L) {
   return false;
 }
 
+/// \brief Maximum number of copies of \p L that fit into the area budget
+/// next to the rest of the function.
+unsigned HDLLoopUnroll::getAreaUnrollFactor(const Loop *L) {
+  if (UnrollAreaBudget == 0)
+    return std::numeric_limits<unsigned>::max();
+
+  const Loopus::ResourceUsage LoopRes = CRE->getResources(L);
+  const Loopus::ResourceUsage FuncRes = CRE->getResources(L->getHeader()->getParent());
+  const Loopus::ResourceUsage Budget =
+    Loopus::HardwareModel::getHardwareModel().getAreaBudget(UnrollAreaBudget);
+
+  // The loop body itself is part of the function, so only the rest of the
+  // function is fixed.
+  const Loopus::ResourceUsage Available = Budget - (FuncRes - LoopRes);
+  const unsigned Factor = Available.fits(LoopRes);
+
+  DEBUG(dbgs() << "        area: loop " << LoopRes.ALMs << " ALMs, "
+               << LoopRes.DSPs << " DSPs, " << LoopRes.M20Ks << " M20Ks; "
+               << "available " << Available.ALMs << " ALMs, "
+               << Available.DSPs << " DSPs, " << Available.M20Ks << " M20Ks\n");
+
+  return std::max(Factor, 1u);
+}
+
 int HDLLoopUnroll::computeLoopUnrollCount(const Loop *L, unsigned *LoopCnt) {
   if (L == nullptr) { return -1; }
 
@@ -819,9 +846,12 @@ int HDLLoopUnroll::computeLoopUnrollCount(const Loop *L, unsigned *LoopCnt) {
 
   // Now determine the maximum unroll count depending on the loop size and the
   // given threshold
-  const unsigned ThresholdUnrollFactor = MaxUnrolledLoopSize / LoopSize;
+  const unsigned SizeUnrollFactor = MaxUnrolledLoopSize / LoopSize;
+  const unsigned AreaUnrollFactor = getAreaUnrollFactor(L);
+  const unsigned ThresholdUnrollFactor = std::min(SizeUnrollFactor, AreaUnrollFactor);
   DEBUG(dbgs() << "        sz=" << LoopSize << "\n"
                << "        szth=" << MaxUnrolledLoopSize << "\n"
+               << "        aruf=" << AreaUnrollFactor << "\n"
                << "        thuf=" << ThresholdUnrollFactor << "\n");
 
   // There are no limiting memory accesses in the loop
@@ -999,13 +1029,15 @@ namespace llvm {
 
 HDLLoopUnroll::HDLLoopUnroll(void)
  : LoopPass(ID), AC(nullptr), APT(nullptr), DL(nullptr), LI(nullptr),
-   MDK(nullptr), RE(nullptr), SE(nullptr) {
+   MDK(nullptr), RE(nullptr), CRE(nullptr), SE(nullptr) {
   initializeHDLLoopUnrollPass(*PassRegistry::getPassRegistry());
   RE = new Loopus::SimpleRessourceEstimator();
+  CRE = new Loopus::CalibratedRessourceEstimator();
 }
 
 HDLLoopUnroll::~HDLLoopUnroll(void) {
   delete RE;
+  delete CRE;
 }
 
 void HDLLoopUnroll::getAnalysisUsage(AnalysisUsage &AU) const {
@@ -30,9 +30,11 @@ private:
   llvm::LoopInfo *LI;
   OpenCLMDKernels *MDK;
   Loopus::RessourceEstimatorBase *RE;
+  Loopus::CalibratedRessourceEstimator *CRE;
   llvm::ScalarEvolution *SE;
 
   unsigned ggT(unsigned a, unsigned b);
+  unsigned getAreaUnrollFactor(const llvm::Loop *L);
 
 protected:
   const llvm::MDNode* getLoopMetadata(const llvm::Loop *L, const std::string &MDName);
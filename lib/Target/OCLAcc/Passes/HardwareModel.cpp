@@ -1,12 +1,311 @@
 #include "HardwareModel.h"
+#include "OCL/NameMangling.h"
 
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/Constant.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Type.h"
 
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace llvm;
+
+static cl::opt<std::string> DeviceFile("device-file", cl::init(""), cl::value_desc("file"), cl::desc("Description of the target device, see Loopus::DeviceDescription"));
+
+static cl::opt<std::string> AreaCalibration("area-calibration", cl::init(""), cl::value_desc("file"), cl::desc("Resources per operator, one \"Operator BitWidth ALMs DSPs M20Ks\" per line"));
+
 Loopus::HardwareModel Loopus::HardwareModel::HWModel;
 
+unsigned Loopus::ResourceUsage::fits(const ResourceUsage &R) const {
+  unsigned N = std::numeric_limits<unsigned>::max();
+
+  if (R.ALMs) N = std::min(N, ALMs / R.ALMs);
+  if (R.DSPs) N = std::min(N, DSPs / R.DSPs);
+  if (R.M20Ks) N = std::min(N, M20Ks / R.M20Ks);
+
+  return N;
+}
+
+//===- HardwareModel ------------------------------------------------------===//
+namespace {
+
+/// \brief Fits of FloPoCo operators and inferred logic on Stratix V
+struct CalibrationEntry {
+  const char *Operator;
+  unsigned BitWidth;
+  unsigned ALMs;
+  unsigned DSPs;
+  unsigned M20Ks;
+};
+
+const CalibrationEntry DefaultCalibration[] = {
+  // Inferred logic
+  {"IntAdd",         32,   17, 0, 0},
+  {"IntAdd",         64,   33, 0, 0},
+  {"Logic",          32,   16, 0, 0},
+  {"Compare",        32,   12, 0, 0},
+  {"Mux",            32,   16, 0, 0},
+  {"Shift",          32,   48, 0, 0},
+  {"Shift",          64,  112, 0, 0},
+  {"Reg",            32,   16, 0, 0},
+  {"Conv",           32,   40, 0, 0},
+  // FloPoCo
+  {"IntMultiplier",  18,    6, 1, 0},
+  {"IntMultiplier",  27,   10, 1, 0},
+  {"IntMultiplier",  32,   45, 2, 0},
+  {"IntMultiplier",  64,  210, 8, 0},
+  {"IntConstMult",   32,   90, 0, 0},
+  {"IntConstMult",   64,  300, 0, 0},
+  {"IntDivider",     32,  620, 0, 0},
+  {"IntDivider",     64, 2300, 0, 0},
+  {"FPAdd",          32,  460, 0, 0},
+  {"FPAdd",          64, 1050, 0, 0},
+  {"FPMult",         32,  120, 1, 0},
+  {"FPMult",         64,  380, 4, 0},
+  {"FPConstMult",    32,  180, 0, 0},
+  {"FPConstMult",    64,  520, 0, 0},
+  {"FPDiv",          32, 1020, 0, 0},
+  {"FPDiv",          64, 3600, 0, 0},
+  {"FPConv",         32,  190, 0, 0},
+  {"FPConv",         64,  420, 0, 0},
+  {"IEEEFMA",        32,  540, 1, 0},
+  {"IEEEFMA",        64, 1350, 4, 0},
+  {"FPSqrt",         32,  380, 0, 0},
+  {"FPSqrt",         64, 1500, 0, 0},
+  {"FPExp",          32,  450, 2, 0},
+  {"FPExp",          64, 1400, 10, 0},
+  {"FPLog",          32,  700, 4, 2},
+  {"FPLog",          64, 2400, 14, 6},
+  {"FPPow",          32, 1600, 8, 3},
+  {"FPPow",          64, 5200, 28, 10},
+  {"FP2Fix",         32,   90, 0, 0},
+  {"FP2Fix",         64,  200, 0, 0},
+  {"FixSinCos",      32,  420, 3, 2},
+  {"FixSinCos",      64, 1600, 12, 8},
+  {"Fix2FP",         32,  110, 0, 0},
+  {"Fix2FP",         64,  240, 0, 0},
+  // FPConstMult by 1/pi, FP2Fix, FixSinCos and Fix2FP
+  {"FPSinCos",       32,  800, 3, 2},
+  {"FPSinCos",       64, 2560, 12, 8},
+  // Memory access unit
+  {"Mem",            32,  150, 0, 0},
+  {"Mem",            64,  220, 0, 0},
+};
+
+/// \brief Combinational delay of inferred logic on Stratix V
+struct DelayEntry {
+  const char *Operator;
+  unsigned BitWidth;
+  double Delay;
+};
+
+const DelayEntry DefaultDelays[] = {
+  // Carry chain
+  {"IntAdd",          8, 0.9},
+  {"IntAdd",         32, 1.5},
+  {"IntAdd",         64, 2.3},
+  // Single LUT level
+  {"Logic",        1024, 0.45},
+  // Muxes are combinational in front of chained operators
+  {"Mux",          1024, 0.7},
+};
+
+/// \brief Remove all bit widths of \p Operator from \p M.
+template<class MapTy>
+void eraseOperator(MapTy &M, const std::string &Operator) {
+  typename MapTy::iterator I = M.lower_bound(std::make_pair(Operator, 0u));
+  while (I != M.end() && I->first.first == Operator)
+    I = M.erase(I);
+}
+
+} // end anonymous namespace
+
+void Loopus::HardwareModel::loadDevice(void) const {
+  if (DeviceLoaded)
+    return;
+
+  DeviceLoaded = true;
+
+  if (DeviceFile.empty())
+    return;
+
+  ErrorOr<std::unique_ptr<MemoryBuffer> > Buffer = MemoryBuffer::getFile(DeviceFile);
+  if (std::error_code EC = Buffer.getError())
+    report_fatal_error("Failed to read " + DeviceFile + ": " + EC.message());
+
+  std::istringstream In(Buffer.get()->getBuffer().str());
+  std::string Line;
+  unsigned LineNo = 0;
+
+  while (std::getline(In, Line)) {
+    LineNo++;
+
+    std::string::size_type Comment = Line.find('#');
+    if (Comment != std::string::npos)
+      Line.erase(Comment);
+
+    std::istringstream LS(Line);
+    std::string Key;
+
+    if (!(LS >> Key))
+      continue;
+
+    bool Valid = true;
+
+    if (Key == "name") {
+      Valid = static_cast<bool>(LS >> Device.Name);
+    } else if (Key == "family") {
+      Valid = static_cast<bool>(LS >> Device.Family);
+    } else if (Key == "frequency") {
+      Valid = (LS >> Device.Frequency) && Device.Frequency != 0;
+    } else if (Key == "alms") {
+      Valid = static_cast<bool>(LS >> Device.Resources.ALMs);
+    } else if (Key == "dsps") {
+      Valid = static_cast<bool>(LS >> Device.Resources.DSPs);
+    } else if (Key == "m20ks") {
+      Valid = static_cast<bool>(LS >> Device.Resources.M20Ks);
+    } else if (Key == "bus-width") {
+      Valid = (LS >> Device.GlobalMemoryBusWidth) && Device.GlobalMemoryBusWidth % 8 == 0 && Device.GlobalMemoryBusWidth != 0;
+    } else if (Key == "mem-latency") {
+      Valid = static_cast<bool>(LS >> Device.GlobalMemoryLatency);
+    } else if (Key == "register-delay") {
+      Valid = static_cast<bool>(LS >> Device.RegisterDelay);
+    } else if (Key == "resources") {
+      std::string Operator;
+      unsigned BitWidth, ALMs, DSPs, M20Ks;
+      Valid = (LS >> Operator >> BitWidth >> ALMs >> DSPs >> M20Ks) && BitWidth != 0;
+      if (Valid)
+        Device.Calibration[std::make_pair(Operator, BitWidth)] = ResourceUsage(ALMs, DSPs, M20Ks);
+    } else if (Key == "delay") {
+      std::string Operator;
+      unsigned BitWidth;
+      double Delay;
+      Valid = (LS >> Operator >> BitWidth >> Delay) && BitWidth != 0;
+      if (Valid)
+        Device.Delays[std::make_pair(Operator, BitWidth)] = Delay;
+    } else {
+      report_fatal_error(DeviceFile + ":" + Twine(LineNo) + ": unknown key " + Key);
+    }
+
+    if (!Valid)
+      report_fatal_error(DeviceFile + ":" + Twine(LineNo) + ": invalid value for " + Key);
+  }
+}
+
+void Loopus::HardwareModel::loadDelays(void) const {
+  if (!Delays.empty())
+    return;
+
+  for (const DelayEntry &E : DefaultDelays)
+    Delays[std::make_pair(std::string(E.Operator), E.BitWidth)] = E.Delay;
+
+  const DelaysTy &DeviceDelays = getDevice().Delays;
+  for (const DelaysTy::value_type &D : DeviceDelays)
+    eraseOperator(Delays, D.first.first);
+  Delays.insert(DeviceDelays.begin(), DeviceDelays.end());
+}
+
+double Loopus::HardwareModel::getOperatorDelay(const std::string &Operator, unsigned BitWidth) const {
+  loadDelays();
+
+  DelaysTy::const_iterator I = Delays.lower_bound(std::make_pair(Operator, BitWidth));
+  if (I != Delays.end() && I->first.first == Operator)
+    return I->second;
+
+  // Wider than all entries, scale the widest one
+  if (I != Delays.begin()) {
+    --I;
+    if (I->first.first == Operator)
+      return I->second * BitWidth / I->first.second;
+  }
+
+  return std::numeric_limits<double>::infinity();
+}
+
+void Loopus::HardwareModel::loadCalibration(void) const {
+  if (!Calibration.empty())
+    return;
+
+  for (const CalibrationEntry &E : DefaultCalibration)
+    Calibration[std::make_pair(std::string(E.Operator), E.BitWidth)] = ResourceUsage(E.ALMs, E.DSPs, E.M20Ks);
+
+  const CalibrationTy &DeviceCalibration = getDevice().Calibration;
+  for (const CalibrationTy::value_type &C : DeviceCalibration)
+    eraseOperator(Calibration, C.first.first);
+  Calibration.insert(DeviceCalibration.begin(), DeviceCalibration.end());
+
+  if (AreaCalibration.empty())
+    return;
+
+  ErrorOr<std::unique_ptr<MemoryBuffer> > Buffer = MemoryBuffer::getFile(AreaCalibration);
+  if (std::error_code EC = Buffer.getError())
+    report_fatal_error("Failed to read " + AreaCalibration + ": " + EC.message());
+
+  std::istringstream In(Buffer.get()->getBuffer().str());
+  std::string Line;
+  unsigned LineNo = 0;
+
+  while (std::getline(In, Line)) {
+    LineNo++;
+
+    std::string::size_type Comment = Line.find('#');
+    if (Comment != std::string::npos)
+      Line.erase(Comment);
+
+    std::istringstream LS(Line);
+    std::string Operator;
+    unsigned BitWidth, ALMs, DSPs, M20Ks;
+
+    if (!(LS >> Operator))
+      continue;
+
+    if (!(LS >> BitWidth >> ALMs >> DSPs >> M20Ks) || BitWidth == 0)
+      report_fatal_error(AreaCalibration + ":" + Twine(LineNo) + ": expected \"Operator BitWidth ALMs DSPs M20Ks\"");
+
+    Calibration[std::make_pair(Operator, BitWidth)] = ResourceUsage(ALMs, DSPs, M20Ks);
+  }
+}
+
+Loopus::ResourceUsage Loopus::HardwareModel::getAreaBudget(unsigned Percent) const {
+  const ResourceUsage &DeviceResources = getDeviceResources();
+
+  return ResourceUsage(
+      static_cast<unsigned>(static_cast<uint64_t>(DeviceResources.ALMs) * Percent / 100),
+      static_cast<unsigned>(static_cast<uint64_t>(DeviceResources.DSPs) * Percent / 100),
+      static_cast<unsigned>(static_cast<uint64_t>(DeviceResources.M20Ks) * Percent / 100));
+}
+
+Loopus::ResourceUsage Loopus::HardwareModel::getOperatorResources(const std::string &Operator, unsigned BitWidth) const {
+  loadCalibration();
+
+  CalibrationTy::const_iterator I = Calibration.lower_bound(std::make_pair(Operator, BitWidth));
+  if (I != Calibration.end() && I->first.first == Operator)
+    return I->second;
+
+  // Wider than all entries, scale the widest one
+  if (I != Calibration.begin()) {
+    --I;
+    if (I->first.first == Operator) {
+      const unsigned Scale = (BitWidth + I->first.second - 1) / I->first.second;
+      return I->second * Scale;
+    }
+  }
+
+  // Unknown operators are estimated as registers
+  if (Operator != "Reg")
+    return getOperatorResources("Reg", BitWidth);
+
+  return ResourceUsage((BitWidth + 1) / 2, 0, 0);
+}
+
 //===- RessourceEstimators ------------------------------------------------===//
 Loopus::RessourceEstimatorBase::RessourceEstimatorBase(void) {
 }
@@ -289,3 +588,216 @@ unsigned Loopus::SimpleRessourceEstimator::getRessourceUsage(const llvm::BasicBl
   }
   return RUSum;
 }
+
+
+//===- CalibratedRessourceEstimator ---------------------------------------===//
+Loopus::CalibratedRessourceEstimator::CalibratedRessourceEstimator(void)
+ : Loopus::RessourceEstimatorBase() {
+}
+
+Loopus::CalibratedRessourceEstimator::~CalibratedRessourceEstimator(void) {
+}
+
+std::pair<std::string, unsigned> Loopus::CalibratedRessourceEstimator::getOperator(const llvm::Instruction *I) {
+  const llvm::Type *Ty = I->getType();
+  if (llvm::isa<llvm::StoreInst>(I))
+    Ty = I->getOperand(0)->getType();
+  else if (llvm::isa<llvm::CmpInst>(I))
+    Ty = I->getOperand(0)->getType();
+
+  unsigned BitWidth = Ty->isSized() ? Ty->getScalarSizeInBits() : 32;
+  if (BitWidth == 0)
+    BitWidth = 32;
+
+  std::string Op;
+
+  switch (I->getOpcode()) {
+    case llvm::Instruction::Add:
+    case llvm::Instruction::Sub:
+      Op = "IntAdd";
+      break;
+    case llvm::Instruction::Mul:
+      // Constant multipliers use no DSPs
+      if (llvm::isa<llvm::Constant>(I->getOperand(0)) || llvm::isa<llvm::Constant>(I->getOperand(1)))
+        Op = "IntConstMult";
+      else
+        Op = "IntMultiplier";
+      break;
+    case llvm::Instruction::UDiv:
+    case llvm::Instruction::SDiv:
+    case llvm::Instruction::URem:
+    case llvm::Instruction::SRem:
+      // Constant divisors are multiplied by their reciprocal, unsigned powers
+      // of 2 are wires
+      if (const llvm::ConstantInt *C = llvm::dyn_cast<llvm::ConstantInt>(I->getOperand(1))) {
+        const bool Unsigned = I->getOpcode() == llvm::Instruction::UDiv || I->getOpcode() == llvm::Instruction::URem;
+        if (Unsigned && C->getValue().isPowerOf2())
+          return std::make_pair(std::string(), 0u);
+        Op = "IntMultiplier";
+        break;
+      }
+      Op = "IntDivider";
+      break;
+    case llvm::Instruction::Shl:
+    case llvm::Instruction::LShr:
+    case llvm::Instruction::AShr:
+      // Constant shifts are wires
+      if (llvm::isa<llvm::Constant>(I->getOperand(1)))
+        return std::make_pair(std::string(), 0u);
+      Op = "Shift";
+      break;
+    case llvm::Instruction::And:
+    case llvm::Instruction::Or:
+    case llvm::Instruction::Xor:
+      Op = "Logic";
+      break;
+    case llvm::Instruction::FAdd:
+    case llvm::Instruction::FSub:
+      Op = "FPAdd";
+      break;
+    case llvm::Instruction::FMul:
+      if (llvm::isa<llvm::Constant>(I->getOperand(0)) || llvm::isa<llvm::Constant>(I->getOperand(1)))
+        Op = "FPConstMult";
+      else
+        Op = "FPMult";
+      break;
+    case llvm::Instruction::FDiv:
+    case llvm::Instruction::FRem:
+      Op = "FPDiv";
+      break;
+    case llvm::Instruction::ICmp:
+    case llvm::Instruction::FCmp:
+      Op = "Compare";
+      break;
+    case llvm::Instruction::PHI:
+    case llvm::Instruction::Select:
+      Op = "Mux";
+      break;
+    case llvm::Instruction::FPToUI:
+    case llvm::Instruction::FPToSI:
+    case llvm::Instruction::UIToFP:
+    case llvm::Instruction::SIToFP:
+    case llvm::Instruction::FPTrunc:
+    case llvm::Instruction::FPExt:
+      Op = "FPConv";
+      break;
+    case llvm::Instruction::Load:
+    case llvm::Instruction::Store:
+      Op = "Mem";
+      break;
+    case llvm::Instruction::Call: {
+      if (const llvm::IntrinsicInst *II = llvm::dyn_cast<llvm::IntrinsicInst>(I)) {
+        if (II->getIntrinsicID() == llvm::Intrinsic::fmuladd) {
+          Op = "IEEEFMA";
+          break;
+        }
+      }
+
+      const llvm::Function *F = llvm::cast<llvm::CallInst>(I)->getCalledFunction();
+      if (F == nullptr || !ocl::NameMangling::isArithmeticFunction(F->getName())) {
+        Op = "Reg";
+        break;
+      }
+
+      const std::string Name = ocl::NameMangling::unmangleName(F->getName());
+      if (Name == "sqrt") Op = "FPSqrt";
+      else if (Name == "exp") Op = "FPExp";
+      else if (Name == "log") Op = "FPLog";
+      else if (Name == "pow") Op = "FPPow";
+      else if (Name == "sin" || Name == "cos") Op = "FPSinCos";
+      else Op = "Reg";
+      break;
+    }
+    case llvm::Instruction::Trunc:
+    case llvm::Instruction::ZExt:
+    case llvm::Instruction::SExt:
+    case llvm::Instruction::BitCast:
+    case llvm::Instruction::PtrToInt:
+    case llvm::Instruction::IntToPtr:
+    case llvm::Instruction::AddrSpaceCast:
+    case llvm::Instruction::ExtractElement:
+    case llvm::Instruction::InsertElement:
+    case llvm::Instruction::ShuffleVector:
+    case llvm::Instruction::Br:
+    case llvm::Instruction::Ret:
+      // Wiring only
+      return std::make_pair(std::string(), 0u);
+    case llvm::Instruction::GetElementPtr:
+      Op = "IntAdd";
+      BitWidth = 64;
+      break;
+    default:
+      Op = "Reg";
+      break;
+  }
+
+  return std::make_pair(Op, BitWidth);
+}
+
+Loopus::ResourceUsage Loopus::CalibratedRessourceEstimator::getResources(const llvm::Value *V) {
+  if (V == nullptr) { return ResourceUsage(); }
+  if (llvm::isa<llvm::BasicBlock>(V) == true) {
+    return getResources(llvm::dyn_cast<llvm::BasicBlock>(V));
+  }
+
+  const llvm::Instruction *I = llvm::dyn_cast<llvm::Instruction>(V);
+  if (I == nullptr) { return ResourceUsage(); }
+
+  std::pair<std::string, unsigned> Op = getOperator(I);
+  if (Op.first.empty()) { return ResourceUsage(); }
+
+  const ResourceUsage R = HardwareModel::getHardwareModel().getOperatorResources(Op.first, Op.second);
+
+  // Vector operations use an operator per lane, except memory accesses.
+  if (const llvm::VectorType *VT = llvm::dyn_cast<llvm::VectorType>(I->getType()))
+    if (!llvm::isa<llvm::LoadInst>(I))
+      return R * VT->getNumElements();
+
+  return R;
+}
+
+Loopus::ResourceUsage Loopus::CalibratedRessourceEstimator::getResources(const llvm::BasicBlock *BB) {
+  ResourceUsage R;
+  if (BB == nullptr) { return R; }
+
+  for (llvm::BasicBlock::const_iterator CBBIT = BB->begin(), CBBEND = BB->end();
+      CBBIT != CBBEND; ++CBBIT) {
+    R += getResources(&*CBBIT);
+  }
+  return R;
+}
+
+Loopus::ResourceUsage Loopus::CalibratedRessourceEstimator::getResources(const llvm::Function *F) {
+  ResourceUsage R;
+  if (F == nullptr) { return R; }
+
+  for (llvm::Function::const_iterator CFIT = F->begin(), CFEND = F->end();
+      CFIT != CFEND; ++CFIT) {
+    R += getResources(&*CFIT);
+  }
+  return R;
+}
+
+Loopus::ResourceUsage Loopus::CalibratedRessourceEstimator::getResources(const llvm::Loop *L) {
+  ResourceUsage R;
+  if (L == nullptr) { return R; }
+
+  for (llvm::Loop::block_iterator LIT = L->block_begin(), LEND = L->block_end();
+      LIT != LEND; ++LIT) {
+    R += getResources(*LIT);
+  }
+  return R;
+}
+
+/// \brief Weight DSPs and M20Ks by the number of ALMs per DSP and M20K on
+/// the device.
+unsigned Loopus::CalibratedRessourceEstimator::getRessourceUsage(const llvm::Value *V) {
+  const ResourceUsage &D = HardwareModel::getHardwareModel().getDeviceResources();
+  const ResourceUsage R = getResources(V);
+
+  unsigned Usage = R.ALMs;
+  if (D.DSPs) Usage += R.DSPs * (D.ALMs / D.DSPs);
+  if (D.M20Ks) Usage += R.M20Ks * (D.ALMs / D.M20Ks);
+
+  return Usage;
+}
@@ -14,32 +14,166 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Value.h"
 
+#include <map>
+#include <string>
+#include <utility>
+
 namespace Loopus {
 
+/// \brief Device resources used by an operator or available on a device
+struct ResourceUsage {
+  unsigned ALMs;
+  unsigned DSPs;
+  unsigned M20Ks;
+
+  ResourceUsage(unsigned ALMs = 0, unsigned DSPs = 0, unsigned M20Ks = 0)
+   : ALMs(ALMs), DSPs(DSPs), M20Ks(M20Ks) {
+  }
+
+  ResourceUsage &operator+=(const ResourceUsage &R) {
+    ALMs += R.ALMs;
+    DSPs += R.DSPs;
+    M20Ks += R.M20Ks;
+    return *this;
+  }
+
+  ResourceUsage operator*(unsigned N) const {
+    return ResourceUsage(ALMs * N, DSPs * N, M20Ks * N);
+  }
+
+  /// \brief Saturating difference
+  ResourceUsage operator-(const ResourceUsage &R) const {
+    return ResourceUsage(ALMs > R.ALMs ? ALMs - R.ALMs : 0,
+        DSPs > R.DSPs ? DSPs - R.DSPs : 0,
+        M20Ks > R.M20Ks ? M20Ks - R.M20Ks : 0);
+  }
+
+  /// \brief Number of times \p R fits into this
+  unsigned fits(const ResourceUsage &R) const;
+};
+
+/// \brief Target board as described by -device-file
+///
+/// The file consists of "key value" lines, '#' starts a comment:
+///   name <board>
+///   family <FloPoCo target, e.g. Stratix5 or Virtex6>
+///   frequency <target fmax in MHz>
+///   alms|dsps|m20ks <number available>
+///   bus-width <global memory bus width in bits>
+///   mem-latency <global memory latency in cycles>
+///   register-delay <clock-to-output and setup time in ns>
+///   resources <Operator> <BitWidth> <ALMs> <DSPs> <M20Ks>
+///   delay <Operator> <BitWidth> <ns>
+/// resources and delay entries replace the defaults of the operator.
+struct DeviceDescription {
+  std::string Name;
+  std::string Family;
+  unsigned Frequency;
+  ResourceUsage Resources;
+  unsigned GlobalMemoryBusWidth;
+  unsigned GlobalMemoryLatency;
+  double RegisterDelay;
+
+  typedef std::map<std::pair<std::string, unsigned>, ResourceUsage> CalibrationTy;
+  CalibrationTy Calibration;
+
+  typedef std::map<std::pair<std::string, unsigned>, double> DelaysTy;
+  DelaysTy Delays;
+
+  /// \brief Stratix V 5SGXA7 at 200MHz
+  DeviceDescription(void)
+   : Name("default"), Family("Stratix5"), Frequency(200),
+     Resources(234720, 256, 2560), GlobalMemoryBusWidth(64),
+     GlobalMemoryLatency(100), RegisterDelay(0.6) {
+  }
+};
+
 class HardwareModel {
 private:
-  HardwareModel(void)
-   : GlobalMemoryBusWidth(64) {
+  HardwareModel(void) : DeviceLoaded(false) {
   }
   HardwareModel(const HardwareModel&) = delete;
   HardwareModel& operator=(const HardwareModel&) = delete;
 
   static HardwareModel HWModel;
 
-  // Width of the bus to the global memory in bits
-  unsigned GlobalMemoryBusWidth;
+  // Target device, loaded on first use as the options are parsed after the
+  // construction of HWModel.
+  mutable DeviceDescription Device;
+  mutable bool DeviceLoaded;
+
+  void loadDevice(void) const;
+
+  // Calibrated resources by operator and bit width, loaded on first use.
+  typedef DeviceDescription::CalibrationTy CalibrationTy;
+  mutable CalibrationTy Calibration;
+
+  void loadCalibration(void) const;
+
+  // Combinational delay of inferred logic by operator and bit width in ns
+  typedef DeviceDescription::DelaysTy DelaysTy;
+  mutable DelaysTy Delays;
+
+  void loadDelays(void) const;
 
 public:
   static const HardwareModel& getHardwareModel(void) {
     return HardwareModel::HWModel;
   }
 
+  /// \brief Target device given by -device-file, a Stratix V 5SGXA7 at
+  /// 200MHz by default.
+  const DeviceDescription &getDevice(void) const {
+    loadDevice();
+    return Device;
+  }
+
   unsigned getGMemBusWidthInBytes(void) const {
-    return (GlobalMemoryBusWidth / 8);
+    return (getDevice().GlobalMemoryBusWidth / 8);
   }
 
   unsigned getGMemBusWidthInBits(void) const {
-    return GlobalMemoryBusWidth;
+    return getDevice().GlobalMemoryBusWidth;
+  }
+
+  /// \brief Cycles until the data of a global memory load arrives.
+  unsigned getGMemLatency(void) const {
+    return getDevice().GlobalMemoryLatency;
+  }
+
+  /// \brief Resources of the target device.
+  const ResourceUsage &getDeviceResources(void) const {
+    return getDevice().Resources;
+  }
+
+  /// \brief Frequency the design is generated for in MHz.
+  unsigned getFrequency(void) const {
+    return getDevice().Frequency;
+  }
+
+  /// \brief Resources available to a design using \p Percent of the device.
+  ResourceUsage getAreaBudget(unsigned Percent) const;
+
+  /// \brief Resources of \p Operator with \p BitWidth bits.
+  ///
+  /// Operators are the FloPoCo operator classes, e.g. FPAdd or
+  /// IntMultiplier, and the inferred logic, e.g. IntAdd or Mux. The entry
+  /// with the next larger bit width is used, wider operators are scaled
+  /// linearly from the widest entry. The values are taken from
+  /// -area-calibration and the device file if given, otherwise from fits of
+  /// FloPoCo operators for Stratix V at 200MHz.
+  ResourceUsage getOperatorResources(const std::string &Operator, unsigned BitWidth) const;
+
+  /// \brief Combinational delay of \p Operator with \p BitWidth bits in ns.
+  ///
+  /// Only the inferred logic in chains of the Blocks, IntAdd, Logic and Mux,
+  /// has a delay. Bit widths are looked up like getOperatorResources(), unknown
+  /// operators have an infinite delay.
+  double getOperatorDelay(const std::string &Operator, unsigned BitWidth) const;
+
+  /// \brief Time of a clock period not available to logic between registers.
+  double getRegisterDelay(void) const {
+    return getDevice().RegisterDelay;
   }
 
 };
@@ -77,6 +211,28 @@ class SimpleRessourceEstimator : public RessourceEstimatorBase {
     virtual unsigned getRessourceUsage(const llvm::BasicBlock *BB) override;
 };
 
+/// \brief Estimate ALMs, DSPs and M20Ks of each instruction from the
+/// calibrated operator resources of the HardwareModel.
+///
+/// getRessourceUsage() returns the usage weighted by the scarcity of each
+/// resource on the device in ALMs.
+class CalibratedRessourceEstimator : public RessourceEstimatorBase {
+  public:
+    CalibratedRessourceEstimator(void);
+    virtual ~CalibratedRessourceEstimator(void);
+
+    /// \brief Operator class and bit width implementing \p I
+    static std::pair<std::string, unsigned> getOperator(const llvm::Instruction *I);
+
+    ResourceUsage getResources(const llvm::Value *V);
+    ResourceUsage getResources(const llvm::BasicBlock *BB);
+    ResourceUsage getResources(const llvm::Function *F);
+    ResourceUsage getResources(const llvm::Loop *L);
+
+    using RessourceEstimatorBase::getRessourceUsage;
+    virtual unsigned getRessourceUsage(const llvm::Value *V) override;
+};
+
 } // End of Loopus namespace
 
 #endif
@@ -23,6 +23,7 @@ void llvm::initializeLoopus(PassRegistry &Registry) {
   initializeSplitBarrierBlocksPass(Registry);
   initializeDelayStoresPass(Registry);
   initializeBitWidthAnalysisPass(Registry);
+  initializeFixedPointAnalysisPass(Registry);
   initializeShiftRegisterDetectionPass(Registry);
   initializeRewriteExprPass(Registry);
   initializeAggregateLoadsPass(Registry);
@@ -30,6 +31,7 @@ void llvm::initializeLoopus(PassRegistry &Registry) {
   initializeArgPromotionTrackerPass(Registry);
   initializeCanonicalizePredecessorsPass(Registry);
   initializeCFGOptimizerPass(Registry);
+  initializeBlockRoutingPass(Registry);
   initializeRenameInvalidPass(Registry);
 }
 
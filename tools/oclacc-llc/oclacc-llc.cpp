@@ -115,7 +115,8 @@ bool DeviceParser::parse( cl::Option &O, StringRef ArgName,
 
   if (valid) Val = oclacc::BITTWARE_S5PHQ_D5;
 
-  if (!valid)  O.error("Invalid TargetDevice: " + ArgValue);
+  // Other boards are described by -device-file
+  if (!valid)  O.error("Invalid TargetDevice: " + ArgValue + ", use -device-file for other devices");
 
   return !valid;
 }
@@ -0,0 +1,57 @@
+// Loops accepted by oclacc-llc
+//
+// Loops left after unrolling are implemented as a Block iterating on a
+// single work-item. This is only possible if the loop body is a single
+// BasicBlock: after loop rotation the exit test is at the end of the body
+// and the body contains no branches. All kernels except reject_* compile,
+// reject_* stop with "Loop ... spans multiple BasicBlocks".
+//
+//   clang -cc1 -O2 -emit-llvm -x cl loops.cl -o loops.ll
+//   oclacc-llc -march=verilog loops.ll
+
+// Runtime trip count with a loop-carried accumulator
+__kernel void accept_sum(__global const float *in, __global float *out, int n) {
+  const int gid = get_global_id(0);
+
+  float sum = 0.0f;
+  for (int i = 0; i < n; ++i)
+    sum += in[gid * n + i];
+
+  out[gid] = sum;
+}
+
+// Exit condition computed in the body
+__kernel void accept_while(__global const int *in, __global int *out) {
+  const int gid = get_global_id(0);
+
+  int x = in[gid];
+  int steps = 0;
+  while (x != 1) {
+    x = (x & 1) ? 3 * x + 1 : x >> 1;
+    steps++;
+  }
+
+  out[gid] = steps;
+}
+
+// The store under a condition needs a branch in the loop body
+__kernel void reject_cond_store(__global const int *in, __global int *out, int n) {
+  const int gid = get_global_id(0);
+
+  for (int i = 0; i < n; ++i) {
+    if (in[gid * n + i] < 0)
+      out[gid * n + i] = 0;
+  }
+}
+
+// A nested loop whose inner loop is not unrolled spans several BasicBlocks
+__kernel void reject_nested(__global const float *in, __global float *out, int n, int m) {
+  const int gid = get_global_id(0);
+
+  float sum = 0.0f;
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < m; ++j)
+      sum += in[gid + i * m + j];
+
+  out[gid] = sum;
+}
@@ -0,0 +1,121 @@
+#!/usr/bin/env python
+
+"""Compile-time benchmark for OCLAcc on kernels with many diamonds.
+
+This generates a SPIR kernel consisting of a chain of if-then-else diamonds.
+A value defined in the entry block is used after the last diamond, so it has
+to be passed through every diamond and there are 2^N paths between its
+definition and its use.
+
+Without --llc, the IR of a single kernel is printed to stdout. With --llc,
+oclacc-llc is run on kernels with an increasing number of diamonds and the
+compile time of each is reported.
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+def generate(diamonds):
+  ir = []
+  ir.append('target datalayout = "e-i64:64-v16:16-v24:32-v32:32-v48:64-'
+            'v96:128-v192:256-v256:256-v512:512-v1024:1024"')
+  ir.append('target triple = "spir64-unknown-unknown"')
+  ir.append('')
+  ir.append('define spir_kernel void @diamonds(float addrspace(1)* %in, '
+            'float addrspace(1)* %out) {')
+  ir.append('entry:')
+  ir.append('  %x = load float addrspace(1)* %in, align 4')
+  ir.append('  br label %d0')
+
+  value = '%x'
+  for i in range(diamonds):
+    ir.append('')
+    ir.append('d%d:' % i)
+    ir.append('  %%c%d = fcmp olt float %s, %d.000000e+00' % (i, value, i))
+    ir.append('  br i1 %%c%d, label %%t%d, label %%e%d' % (i, i, i))
+    ir.append('')
+    ir.append('t%d:' % i)
+    ir.append('  %%a%d = fadd float %s, 1.000000e+00' % (i, value))
+    ir.append('  br label %%j%d' % i)
+    ir.append('')
+    ir.append('e%d:' % i)
+    ir.append('  %%b%d = fmul float %s, 2.000000e+00' % (i, value))
+    ir.append('  br label %%j%d' % i)
+    ir.append('')
+    ir.append('j%d:' % i)
+    ir.append('  %%v%d = phi float [ %%a%d, %%t%d ], [ %%b%d, %%e%d ]'
+              % (i, i, i, i, i))
+    ir.append('  br label %%d%d' % (i + 1))
+    value = '%%v%d' % i
+
+  ir.append('')
+  ir.append('d%d:' % diamonds)
+  # The entry value crosses all diamonds
+  ir.append('  %%r = fadd float %s, %%x' % value)
+  ir.append('  store float %r, float addrspace(1)* %out, align 4')
+  ir.append('  ret void')
+  ir.append('}')
+  ir.append('')
+
+  kernel = ('void (float addrspace(1)*, float addrspace(1)*)* @diamonds')
+  ir.append('!opencl.kernels = !{!0}')
+  ir.append('!oclacc.workitem = !{!0}')
+  ir.append('')
+  ir.append('!0 = !{%s, !1, !2, !3, !4, !5}' % kernel)
+  ir.append('!1 = !{!"kernel_arg_addr_space", i32 1, i32 1}')
+  ir.append('!2 = !{!"kernel_arg_access_qual", !"none", !"none"}')
+  ir.append('!3 = !{!"kernel_arg_type", !"float*", !"float*"}')
+  ir.append('!4 = !{!"kernel_arg_type_qual", !"", !""}')
+  ir.append('!5 = !{!"kernel_arg_name", !"in", !"out"}')
+
+  return '\n'.join(ir) + '\n'
+
+def run(llc, march, diamonds, workdir):
+  name = 'diamonds_%d' % diamonds
+  path = os.path.join(workdir, name + '.ll')
+  with open(path, 'w') as f:
+    f.write(generate(diamonds))
+
+  with open(os.devnull, 'w') as null:
+    start = time.time()
+    ret = subprocess.call([llc, '-march=' + march, '-oclacc-dir=' + name,
+                           path], cwd=workdir, stdout=null, stderr=null)
+    return ret, time.time() - start
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('-n', '--diamonds', type=int, default=20,
+                      help='Number of diamonds of the largest kernel')
+  parser.add_argument('--step', type=int, default=4,
+                      help='Increase of diamonds between kernels')
+  parser.add_argument('--llc',
+                      help='Path to oclacc-llc, print the IR if not set')
+  parser.add_argument('--march', default='dot',
+                      help='OCLAcc backend to run')
+  parser.add_argument('--timeout', type=float, default=300,
+                      help='Stop after a kernel took longer (seconds)')
+  args = parser.parse_args()
+
+  if args.llc is None:
+    sys.stdout.write(generate(args.diamonds))
+    return
+
+  workdir = tempfile.mkdtemp(prefix='oclacc-diamonds-')
+  try:
+    print('%10s %10s %10s' % ('diamonds', 'status', 'seconds'))
+    for n in range(args.step, args.diamonds + 1, args.step):
+      ret, secs = run(args.llc, args.march, n, workdir)
+      print('%10d %10d %10.2f' % (n, ret, secs))
+      sys.stdout.flush()
+      if secs > args.timeout:
+        break
+  finally:
+    shutil.rmtree(workdir)
+
+if __name__ == '__main__':
+  main()